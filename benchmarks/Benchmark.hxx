@@ -0,0 +1,177 @@
+#ifndef GUARDBENCHMARK_H
+#define GUARDBENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Namespace of the microbenchmarks of the C++ functions in src/
+namespace benchmark {
+
+/// Keep the compiler from optimizing away the computation of a value, which
+/// is otherwise unused.
+template <typename T> inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Settings of a benchmark run, see Suite::parseOptions
+struct Options {
+    std::string filter = ".*";
+    std::string output = "";
+    std::size_t repetitions = 15;
+    double minTime = 0.02;
+};
+
+/// Result of one benchmark for one parameter. All times are given per event.
+struct Result {
+    std::string name;
+    std::size_t parameter;
+    std::size_t events;
+    double median;
+    double min;
+    double max;
+};
+
+/// Collection of benchmarks. Each benchmark is registered with a setup
+/// function, which prepares the synthetic inputs for a parameter (e.g. the
+/// number of objects per event) and returns the function to be timed. The
+/// timed function processes all prepared events once and returns the number
+/// of events. It is repeated until `minTime` has passed, and this measurement
+/// is repeated `repetitions` times. The median time per event is reported.
+/// Since the inputs are generated with fixed seeds, the results of different
+/// commits can be compared with compare.py.
+class Suite {
+  public:
+    using Kernel = std::function<std::size_t()>;
+    using Setup = std::function<Kernel(std::size_t)>;
+
+    void add(const std::string &name,
+             const std::vector<std::size_t> &parameters, Setup setup) {
+        _benchmarks.push_back({name, parameters, std::move(setup)});
+    }
+
+    /// Parse the command line options
+    ///
+    ///     --filter REGEX      only run the benchmarks matching REGEX
+    ///     --repetitions N     number of measurements per benchmark
+    ///     --min-time SECONDS  minimal duration of a measurement
+    ///     --output FILE       write the results to a JSON file
+    ///
+    /// \returns false, if the options are invalid
+    static bool parseOptions(int argc, char *argv[], Options &options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for option " << arg << std::endl;
+                return false;
+            }
+            if (arg == "--filter")
+                options.filter = argv[++i];
+            else if (arg == "--repetitions")
+                options.repetitions = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--min-time")
+                options.minTime = std::atof(argv[++i]);
+            else if (arg == "--output")
+                options.output = argv[++i];
+            else {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<Result> run(const Options &options) const {
+        const std::regex filter(options.filter);
+        std::vector<Result> results;
+        std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+                  << std::setw(12) << "median" << std::setw(12) << "min"
+                  << std::setw(12) << "max" << "  [ns/event]" << std::endl;
+        for (const auto &benchmark : _benchmarks) {
+            for (const auto parameter : benchmark.parameters) {
+                const std::string label =
+                    benchmark.name + "/" + std::to_string(parameter);
+                if (!std::regex_search(label, filter))
+                    continue;
+                results.push_back(measure(benchmark, parameter, options));
+                const auto &result = results.back();
+                std::cout << std::left << std::setw(48) << label << std::right
+                          << std::fixed << std::setprecision(1)
+                          << std::setw(12) << result.median << std::setw(12)
+                          << result.min << std::setw(12) << result.max
+                          << std::endl;
+            }
+        }
+        return results;
+    }
+
+    /// Write the results to a JSON file of the form
+    ///
+    ///     {"benchmarks": [{"name": ..., "parameter": ..., "events": ...,
+    ///         "median": ..., "min": ..., "max": ...}, ...]}
+    static bool write(const std::string &filename,
+                      const std::vector<Result> &results) {
+        std::ofstream file(filename);
+        if (!file) {
+            std::cerr << "Could not open " << filename << std::endl;
+            return false;
+        }
+        file << "{\n    \"benchmarks\": [";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto &result = results[i];
+            file << (i == 0 ? "" : ",") << "\n        {\"name\": \""
+                 << result.name << "\", \"parameter\": " << result.parameter
+                 << ", \"events\": " << result.events
+                 << ", \"median\": " << result.median
+                 << ", \"min\": " << result.min << ", \"max\": " << result.max
+                 << "}";
+        }
+        file << "\n    ]\n}\n";
+        return true;
+    }
+
+  private:
+    struct Benchmark {
+        std::string name;
+        std::vector<std::size_t> parameters;
+        Setup setup;
+    };
+
+    static Result measure(const Benchmark &benchmark, std::size_t parameter,
+                          const Options &options) {
+        using clock = std::chrono::steady_clock;
+        auto kernel = benchmark.setup(parameter);
+        // warm up the caches and the allocator
+        const std::size_t events = kernel();
+        std::vector<double> times;
+        for (std::size_t i = 0; i < options.repetitions; ++i) {
+            std::size_t processed = 0;
+            const auto start = clock::now();
+            double elapsed = 0.;
+            do {
+                processed += kernel();
+                elapsed =
+                    std::chrono::duration<double>(clock::now() - start).count();
+            } while (elapsed < options.minTime);
+            times.push_back(elapsed * 1e9 /
+                            std::max<std::size_t>(processed, 1));
+        }
+        std::sort(times.begin(), times.end());
+        return {benchmark.name, parameter, events,
+                times[times.size() / 2], times.front(), times.back()};
+    }
+
+    std::vector<Benchmark> _benchmarks;
+};
+
+} // namespace benchmark
+
+#endif /* GUARDBENCHMARK_H */
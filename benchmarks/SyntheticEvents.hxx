@@ -0,0 +1,89 @@
+#ifndef GUARDSYNTHETICEVENTS_H
+#define GUARDSYNTHETICEVENTS_H
+
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RVec.hxx"
+#include "TMath.h"
+#include "TRandom3.h"
+#include <string_view>
+#include <vector>
+
+namespace benchmark {
+
+/// number of events prepared for each benchmark
+constexpr std::size_t nEvents = 1000;
+
+/// Object collection of one synthetic event, with the columns used by the
+/// object selections. The values are drawn from rough approximations of the
+/// distributions in NanoAOD, which is sufficient to exercise all branches of
+/// the selections.
+struct Collection {
+    ROOT::RVec<float> pt;
+    ROOT::RVec<float> eta;
+    ROOT::RVec<float> phi;
+    ROOT::RVec<float> mass;
+    ROOT::RVec<float> iso;
+    ROOT::RVec<UChar_t> id;
+    ROOT::RVec<int> mask;
+};
+
+/// Generate `nEvents` collections with `nObjects` objects each. The seed
+/// fixes the inputs, so that the timings of different commits are
+/// comparable.
+inline std::vector<Collection> makeCollections(std::size_t nObjects,
+                                               unsigned int seed) {
+    TRandom3 random(seed);
+    std::vector<Collection> events(nEvents);
+    for (auto &event : events) {
+        for (std::size_t i = 0; i < nObjects; ++i) {
+            event.pt.push_back(10. + random.Exp(25.));
+            event.eta.push_back(random.Uniform(-2.5, 2.5));
+            event.phi.push_back(random.Uniform(-TMath::Pi(), TMath::Pi()));
+            event.mass.push_back(random.Uniform(0., 1.8));
+            event.iso.push_back(random.Exp(0.2));
+            event.id.push_back(static_cast<UChar_t>(random.Integer(256)));
+            event.mask.push_back(random.Rndm() < 0.7);
+        }
+    }
+    return events;
+}
+
+/// Stand-in for the dataframe, which keeps the function booked by a producer
+/// instead of adding it to a computation graph. This gives access to the
+/// lambdas defined inside of the producers, e.g.
+///
+///     KernelCapture df;
+///     auto combine =
+///         physicsobject::CombineMasks(df, "mask", "a", "b").function;
+///
+/// If a producer defines several columns, the function of the first one is
+/// kept.
+struct KernelCapture {
+    template <typename F> struct Captured {
+        template <typename G>
+        Captured Define(std::string_view, G,
+                        const ROOT::RDF::ColumnNames_t & = {}) const {
+            return *this;
+        }
+
+        F function;
+    };
+
+    template <typename F>
+    Captured<F> Define(std::string_view, F function,
+                       const ROOT::RDF::ColumnNames_t & = {}) {
+        return {std::move(function)};
+    }
+
+    template <typename F>
+    Captured<F> DefineSlot(std::string_view, F function,
+                           const ROOT::RDF::ColumnNames_t & = {}) {
+        return {std::move(function)};
+    }
+
+    unsigned int GetNSlots() const { return 1; }
+};
+
+} // namespace benchmark
+
+#endif /* GUARDSYNTHETICEVENTS_H */
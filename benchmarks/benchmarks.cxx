@@ -0,0 +1,392 @@
+// Microbenchmarks of the performance critical C++ functions in src/. All
+// inputs are synthetic and generated with fixed seeds, no input files or
+// network access are needed. See docs/sphinx_source/contrib.rst for the usage.
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RVec.hxx"
+#include "Benchmark.hxx"
+#include "RooArgSet.h"
+#include "RooWorkspace.h"
+#include "SyntheticEvents.hxx"
+#include "TF1.h"
+#include "TH1D.h"
+#include "TMemFile.h"
+#include "src/basefunctions.hxx"
+#include "src/lorentzvectors.hxx"
+#include "src/met.hxx"
+#include "src/pairselection.hxx"
+#include "src/physicsobjects.hxx"
+#include "src/triggers.hxx"
+#include "src/utility/Logger.hxx"
+#include "src/utility/ObjectMask.hxx"
+#include "src/utility/RooFunctorThreadsafe.hxx"
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+using benchmark::Collection;
+using benchmark::doNotOptimize;
+using benchmark::KernelCapture;
+using benchmark::makeCollections;
+
+// number of objects per event, the typical multiplicities are 2 to 8
+const std::vector<std::size_t> multiplicities = {2, 8, 32};
+
+// apply a function to the collection of each event
+template <typename F>
+benchmark::Suite::Kernel forEachEvent(std::vector<Collection> events,
+                                      F function) {
+    return [events = std::move(events), function]() mutable {
+        for (const auto &event : events)
+            doNotOptimize(function(event));
+        return events.size();
+    };
+}
+
+// Recoil correction payload with the structure of the files in data/recoil,
+// filled with gaussian distributions. Data and simulation differ slightly in
+// the mean and width, so that the correction is not trivial.
+std::shared_ptr<const RecoilCorrector> makeRecoilCorrector() {
+    TMemFile file("recoil.root", "RECREATE");
+    TH1D projH("projH", "", 2, 0, 2);
+    projH.GetXaxis()->SetBinLabel(1, "Paral");
+    projH.GetXaxis()->SetBinLabel(2, "Perp");
+    const std::vector<double> zptEdges = {0, 10, 20, 30, 50, 1000};
+    const std::vector<std::string> zptLabels = {"Pt0to10", "Pt10to20",
+                                                "Pt20to30", "Pt30to50",
+                                                "PtGt50"};
+    const std::vector<std::string> njetLabels = {"NJets0", "NJets1",
+                                                 "NJetsGe2"};
+    TH1D zptBins("ZPtBinsH", "", zptLabels.size(), zptEdges.data());
+    for (std::size_t i = 0; i < zptLabels.size(); ++i)
+        zptBins.GetXaxis()->SetBinLabel(i + 1, zptLabels[i].c_str());
+    TH1D njetBins("nJetBinsH", "", njetLabels.size(), 0, njetLabels.size());
+    for (std::size_t i = 0; i < njetLabels.size(); ++i)
+        njetBins.GetXaxis()->SetBinLabel(i + 1, njetLabels[i].c_str());
+    file.WriteTObject(&projH);
+    file.WriteTObject(&zptBins);
+    file.WriteTObject(&njetBins);
+    for (const auto &component : {"Paral", "Perp"}) {
+        for (const auto &njet : njetLabels) {
+            for (const auto &zpt : zptLabels) {
+                for (const auto &sample : {"data", "mc"}) {
+                    const std::string name =
+                        std::string(component) + "_" + njet + zpt + "_";
+                    const bool isData = std::string(sample) == "data";
+                    const double mean =
+                        std::string(component) == "Paral" ? -5. : 0.;
+                    const double sigma = isData ? 22. : 20.;
+                    TF1 function((name + sample).c_str(), "gaus", -150, 150);
+                    function.SetParameters(1., mean, sigma);
+                    TH1D hist((name + "hist_" + sample).c_str(), "", 300,
+                              -150, 150);
+                    for (int bin = 1; bin <= hist.GetNbinsX(); ++bin)
+                        hist.SetBinContent(
+                            bin, function.Eval(hist.GetBinCenter(bin)));
+                    file.WriteTObject(&function);
+                    file.WriteTObject(&hist);
+                }
+            }
+        }
+    }
+    return std::make_shared<const RecoilCorrector>(file);
+}
+
+// Smooth scale factor as a function of pt and eta, like the lepton
+// identification scale factors in the correction workspaces
+RooWorkspace &makeWorkspace() {
+    static RooWorkspace workspace("w");
+    if (!workspace.function("sf")) {
+        workspace.factory("expr::sf('0.95 + 0.05 * exp(-pt / 40.) * "
+                          "(1. + 0.2 * eta * eta)', pt[25, 10, 200], "
+                          "eta[0, -2.5, 2.5])");
+    }
+    return workspace;
+}
+
+void addObjectSelections(benchmark::Suite &suite) {
+    suite.add("basefunctions::FilterMin", multiplicities, [](std::size_t n) {
+        return forEachEvent(makeCollections(n, 1),
+                            [filter = basefunctions::FilterMin(25.)](
+                                const Collection &event) {
+                                return filter(event.pt);
+                            });
+    });
+    suite.add("basefunctions::FilterID", multiplicities, [](std::size_t n) {
+        return forEachEvent(
+            makeCollections(n, 2),
+            [filter = basefunctions::FilterID(4)](const Collection &event) {
+                return filter(event.id);
+            });
+    });
+    suite.add("physicsobject::CombineMasks", multiplicities, [](std::size_t n) {
+        KernelCapture df;
+        auto combine = physicsobject::CombineMasks(df, "mask", "m1", "m2", "m3",
+                                                   "m4", "m5", "m6")
+                           .function;
+        // six masks, alternating between two pass patterns
+        auto events = makeCollections(n, 3);
+        auto masks = makeCollections(n, 4);
+        return [events = std::move(events), masks = std::move(masks),
+                combine]() mutable {
+            for (std::size_t i = 0; i < events.size(); ++i) {
+                const auto &a = events[i].mask;
+                const auto &b = masks[i].mask;
+                doNotOptimize(combine(a, b, a, b, a, b));
+            }
+            return events.size();
+        };
+    });
+    suite.add("physicsobject::packed::CutMin", multiplicities,
+              [](std::size_t n) {
+                  KernelCapture df;
+                  auto cut =
+                      physicsobject::packed::CutMin(df, "pt", "mask", 25.)
+                          .function;
+                  return forEachEvent(makeCollections(n, 1),
+                                      [cut](const Collection &event) {
+                                          return cut(event.pt);
+                                      });
+              });
+    suite.add("physicsobject::packed::CombineMasks", multiplicities,
+              [](std::size_t n) {
+                  KernelCapture df;
+                  auto combine = physicsobject::packed::CombineMasks(
+                                     df, "mask", "m1", "m2", "m3", "m4", "m5",
+                                     "m6")
+                                     .function;
+                  // same inputs as for physicsobject::CombineMasks, packed
+                  // before the measurement
+                  auto events = makeCollections(n, 3);
+                  auto masks = makeCollections(n, 4);
+                  std::vector<std::array<utility::ObjectMask, 2>> packed;
+                  for (std::size_t i = 0; i < events.size(); ++i) {
+                      packed.push_back(
+                          {utility::ObjectMask::FromRVec(events[i].mask),
+                           utility::ObjectMask::FromRVec(masks[i].mask)});
+                  }
+                  return [packed = std::move(packed), combine]() {
+                      for (const auto &[a, b] : packed)
+                          doNotOptimize(combine(a, b, a, b, a, b));
+                      return packed.size();
+                  };
+              });
+    // pt, eta, ID and isolation cuts followed by the combination of the
+    // masks, once as separate cuts and once as a fused selection
+    suite.add("physicsobject::SelectObjects", multiplicities,
+              [](std::size_t n) {
+                  namespace selection = physicsobject::selection;
+                  KernelCapture df;
+                  auto select =
+                      physicsobject::SelectObjects(
+                          df, "selected", selection::Min("pt", 25.),
+                          selection::AbsMax("eta", 2.3),
+                          selection::TauID("id", 4), selection::Max("iso", 0.3))
+                          .function;
+                  return forEachEvent(makeCollections(n, 12),
+                                      [select](const Collection &event) {
+                                          return select(event.pt, event.eta,
+                                                        event.id, event.iso);
+                                      });
+              });
+    suite.add("physicsobject::CutsAndCombineMasks", multiplicities,
+              [](std::size_t n) {
+                  KernelCapture df;
+                  auto combine = physicsobject::CombineMasks(df, "mask", "m1",
+                                                             "m2", "m3", "m4")
+                                     .function;
+                  return forEachEvent(
+                      makeCollections(n, 12),
+                      [combine, pt = basefunctions::FilterMin(25.),
+                       eta = basefunctions::FilterAbsMax(2.3),
+                       id = basefunctions::FilterID(4),
+                       iso = basefunctions::FilterMax(0.3)](
+                          const Collection &event) {
+                          return ROOT::VecOps::Nonzero(
+                              combine(pt(event.pt), eta(event.eta),
+                                      id(event.id), iso(event.iso)));
+                      });
+              });
+}
+
+void addPairSelection(benchmark::Suite &suite) {
+    suite.add("pairselection::mutau::PairSelectionAlgo", multiplicities,
+              [](std::size_t n) {
+                  auto muons = makeCollections(n, 5);
+                  auto taus = makeCollections(n, 6);
+                  auto algo = pairselection::mutau::PairSelectionAlgo();
+                  return [muons = std::move(muons), taus = std::move(taus),
+                          algo]() {
+                      for (std::size_t i = 0; i < muons.size(); ++i) {
+                          doNotOptimize(algo(taus[i].pt, taus[i].iso,
+                                             muons[i].pt, muons[i].iso,
+                                             taus[i].mask, muons[i].mask));
+                      }
+                      return muons.size();
+                  };
+              });
+}
+
+void addTriggerMatching(benchmark::Suite &suite) {
+    // the parameter is the number of trigger objects, the particles are
+    // matched to objects with id 13
+    suite.add(
+        "trigger::matchParticle", {8, 32, 128}, [](std::size_t n) {
+            auto objects = makeCollections(n, 7);
+            auto particles = makeCollections(1, 8);
+            std::vector<trigger::TriggerObjectView> views;
+            std::vector<ROOT::Math::PtEtaPhiMVector> p4s;
+            const std::array<int, 4> ids = {1, 11, 13, 15};
+            for (std::size_t i = 0; i < objects.size(); ++i) {
+                const auto &event = objects[i];
+                ROOT::RVec<int> id(n);
+                ROOT::RVec<int> bits(n);
+                for (std::size_t j = 0; j < n; ++j) {
+                    id[j] = ids[event.id[j] % ids.size()];
+                    bits[j] = event.id[j];
+                }
+                views.emplace_back(id, bits, event.pt, event.eta, event.phi);
+                // place the particle close to one of the objects in most
+                // events
+                const std::size_t target = i % n;
+                const float eta = i % 4 ? event.eta[target]
+                                        : particles[i].eta[0];
+                p4s.emplace_back(particles[i].pt[0] + 20., eta,
+                                 event.phi[target], 0.105);
+            }
+            const trigger::TriggerObjectRequirement requirement(22., 2.1, 13,
+                                                                1, 0.5);
+            return [views = std::move(views), p4s = std::move(p4s),
+                    requirement]() {
+                for (std::size_t i = 0; i < views.size(); ++i) {
+                    trigger::TriggerObjectView::MatchedObjects matched;
+                    doNotOptimize(trigger::matchParticle(p4s[i], views[i],
+                                                         requirement, matched));
+                }
+                return views.size();
+            };
+        });
+}
+
+void addCorrections(benchmark::Suite &suite) {
+    suite.add("RecoilCorrector::CorrectWithHist", {1}, [](std::size_t) {
+        auto corrector = makeRecoilCorrector();
+        auto bosons = makeCollections(3, 9);
+        return [corrector, bosons = std::move(bosons)]() {
+            for (const auto &event : bosons) {
+                // gen boson, visible part of the boson and met
+                const float genPx = event.pt[0] * std::cos(event.phi[0]);
+                const float genPy = event.pt[0] * std::sin(event.phi[0]);
+                const float visPx = 0.7 * genPx;
+                const float visPy = 0.7 * genPy;
+                const float metPx = event.pt[1] * std::cos(event.phi[1]);
+                const float metPy = event.pt[1] * std::sin(event.phi[1]);
+                float corrPx = 0.;
+                float corrPy = 0.;
+                corrector->CorrectWithHist(metPx, metPy, genPx, genPy, visPx,
+                                           visPy, event.id[2] % 4, corrPx,
+                                           corrPy);
+                doNotOptimize(corrPx);
+                doNotOptimize(corrPy);
+            }
+            return bosons.size();
+        };
+    });
+    // the functors are evaluated on the pt and eta of the leading object, the
+    // per slot functor is called as in a DefineSlot with slot 0
+    suite.add("RooFunctorThreadsafe::eval", {1}, [](std::size_t) {
+        auto &workspace = makeWorkspace();
+        RooArgSet args(*workspace.var("pt"), *workspace.var("eta"));
+        auto functor = std::make_shared<RooFunctorThreadsafe>(
+            *workspace.function("sf"), args);
+        return forEachEvent(makeCollections(1, 10),
+                            [functor](const Collection &event) {
+                                const std::array<double, 2> input = {
+                                    event.pt[0], event.eta[0]};
+                                return functor->eval(input.data());
+                            });
+    });
+    suite.add("RooFunctorPerSlot::eval", {1}, [](std::size_t) {
+        auto &workspace = makeWorkspace();
+        RooArgSet args(*workspace.var("pt"), *workspace.var("eta"));
+        auto functor = std::make_shared<RooFunctorPerSlot>(
+            *workspace.function("sf"), args, 1);
+        return forEachEvent(makeCollections(1, 10),
+                            [functor](const Collection &event) {
+                                const std::array<double, 2> input = {
+                                    event.pt[0], event.eta[0]};
+                                return functor->eval(0, input);
+                            });
+    });
+}
+
+void addFourVectors(benchmark::Suite &suite) {
+    // the parameter is the number of objects per event, in one out of four
+    // events no pair is found and the default vector is built
+    suite.add("lorentzvectors::buildparticle", multiplicities,
+              [](std::size_t n) {
+                  KernelCapture df;
+                  auto build = lorentzvectors::buildparticle(
+                                   df, {"pair", "pt", "eta", "phi", "mass"},
+                                   "p4", 0)
+                                   .function;
+                  auto events = makeCollections(n, 11);
+                  std::vector<ROOT::RVec<int>> pairs;
+                  for (std::size_t i = 0; i < events.size(); ++i) {
+                      const int index = i % 4 ? int(i % n) : -1;
+                      pairs.push_back({index, index});
+                  }
+                  return [events = std::move(events), pairs = std::move(pairs),
+                          build]() {
+                      for (std::size_t i = 0; i < events.size(); ++i) {
+                          const auto &event = events[i];
+                          doNotOptimize(build(pairs[i], event.pt, event.eta,
+                                              event.phi, event.mass));
+                      }
+                      return events.size();
+                  };
+              });
+    // the cartesian components of the same particles, the component columns
+    // only copy an entry of the timed column
+    suite.add("lorentzvectors::buildCartesian", multiplicities,
+              [](std::size_t n) {
+                  KernelCapture df;
+                  auto build = lorentzvectors::buildCartesian(
+                                   df, {"pair", "pt", "eta", "phi", "mass"}, 0,
+                                   "p4", "px", "py", "pz", "e")
+                                   .function;
+                  auto events = makeCollections(n, 11);
+                  std::vector<ROOT::RVec<int>> pairs;
+                  for (std::size_t i = 0; i < events.size(); ++i) {
+                      const int index = i % 4 ? int(i % n) : -1;
+                      pairs.push_back({index, index});
+                  }
+                  return [events = std::move(events), pairs = std::move(pairs),
+                          build]() {
+                      for (std::size_t i = 0; i < events.size(); ++i) {
+                          const auto &event = events[i];
+                          doNotOptimize(build(pairs[i], event.pt, event.eta,
+                                              event.phi, event.mass));
+                      }
+                      return events.size();
+                  };
+              });
+}
+
+int main(int argc, char *argv[]) {
+    benchmark::Options options;
+    if (!benchmark::Suite::parseOptions(argc, argv, options))
+        return 1;
+    Logger::setLevel(Logger::LogLevel::WARN);
+    benchmark::Suite suite;
+    addObjectSelections(suite);
+    addPairSelection(suite);
+    addTriggerMatching(suite);
+    addCorrections(suite);
+    addFourVectors(suite);
+    const auto results = suite.run(options);
+    if (!options.output.empty() &&
+        !benchmark::Suite::write(options.output, results))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,54 @@
+import argparse
+import json
+import sys
+
+parser = argparse.ArgumentParser(
+    description="Compare two result files of the crown_benchmarks executable"
+)
+parser.add_argument("baseline", type=str, help="Results of the reference commit")
+parser.add_argument("current", type=str, help="Results of the commit to be tested")
+parser.add_argument(
+    "--threshold",
+    type=float,
+    default=0.1,
+    help="Relative slowdown of the median time, above which a benchmark fails",
+)
+args = parser.parse_args()
+
+
+def load(filename):
+    with open(filename, "r") as f:
+        results = json.load(f)["benchmarks"]
+    return {"{}/{}".format(r["name"], r["parameter"]): r for r in results}
+
+
+baseline = load(args.baseline)
+current = load(args.current)
+regressions = []
+print(
+    "{:<48} {:>12} {:>12} {:>9}".format("Benchmark", "baseline", "current", "change")
+)
+for label, result in current.items():
+    if label not in baseline:
+        print(
+            "{:<48} {:>12} {:>12.1f} {:>9}".format(
+                label, "-", result["median"], "new"
+            )
+        )
+        continue
+    reference = baseline[label]["median"]
+    change = result["median"] / reference - 1.0
+    print(
+        "{:<48} {:>12.1f} {:>12.1f} {:>+8.1f}%".format(
+            label, reference, result["median"], 100 * change
+        )
+    )
+    if change > args.threshold:
+        regressions.append(label)
+if len(regressions) > 0:
+    print(
+        "{} benchmarks are more than {:.0f}% slower than the baseline: {}".format(
+            len(regressions), 100 * args.threshold, ", ".join(regressions)
+        )
+    )
+    sys.exit(1)
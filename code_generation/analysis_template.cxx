@@ -1,3 +1,8 @@
+// compile-time log level, set by the generator depending on the --debug flag
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_{LOGLEVEL}
+// per-producer instrumentation, set by the generator depending on the
+// --instrumentation flag
+#define CROWN_INSTRUMENTATION {INSTRUMENTATION}
 #include "ROOT/RDFHelpers.hxx"
 #include "ROOT/RDataFrame.hxx"
 #include "RooTrace.h"
@@ -13,7 +18,14 @@
 #include "src/reweighting.hxx"
 #include "src/scalefactors.hxx"
 #include "src/triggers.hxx"
+#include "src/utility/CorrectionRegistry.hxx"
+#include "src/utility/FilterProfile.hxx"
+#include "src/utility/InputFiles.hxx"
+#include "src/utility/Instrumentation.hxx"
 #include "src/utility/Logger.hxx"
+#include "src/utility/RunOptions.hxx"
+#include "src/utility/ScalingBenchmark.hxx"
+#include "src/utility/Variations.hxx"
 #include <ROOT/RLogger.hxx>
 #include <TFile.h>
 #include <TTree.h>
@@ -22,22 +34,32 @@
 static std::vector<std::string> varSet = {"run", "luminosityBlock", "event"};
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        Logger::get("main")->critical(
-            "Require exactly two additional input arguments (the input and "
-            "output paths to the ROOT files) but got {}",
-            argc - 1);
+    utility::RunOptions options;
+    if (!utility::parseRunOptions(argc, argv, options)) {
         return 1;
     }
+    if (options.scaling_benchmark) {
+        return utility::runScalingBenchmark(argv[0], options);
+    }
+    // the filters are only measured, if a profile is requested
+    if (!options.filter_profile.empty()) {
+        utility::FilterProfile::enable();
+    }
 
-    const auto input_path = argv[1];
-    Logger::get("main")->info("Input file: {}", input_path);
-    const auto output_path = argv[2];
+    const auto input_paths = options.input_paths;
+    for (const auto &input_path : input_paths)
+        Logger::get("main")->info("Input file: {}", input_path);
+    const auto output_path = options.output_path;
     Logger::get("main")->info("Output directory: {}", output_path);
 
     TStopwatch timer;
     timer.Start();
-    ROOT::EnableImplicitMT(1); // for multithreading
+    // for multithreading, 0 uses all available cores
+    ROOT::EnableImplicitMT(options.threads());
+    Logger::get("main")->info("Running with {} threads",
+                              ROOT::GetThreadPoolSize());
+    utility::configureClusterPartitioning(input_paths, "Events",
+                                          ROOT::GetThreadPoolSize());
     // ROOT logging
     auto verbosity = ROOT::Experimental::RLogScopedVerbosity(
         ROOT::Detail::RDF::RDFLogChannel(),
@@ -45,11 +67,11 @@ int main(int argc, char *argv[]) {
     RooTrace::verbose(kTRUE);
 
     // file logging
-    ROOT::RDataFrame df0("Events", input_path);
+    ROOT::RDataFrame df0("Events", input_paths);
     // for testing, we limit to 1000 events only
     // 1st stage: Good object selection
     Logger::enableFileLogging("logs/main.txt");
-    Logger::setLevel(Logger::LogLevel::INFO);
+    Logger::setLevel(Logger::LogLevel::{LOGLEVEL});
     Logger::get("main")->info("Starting Setup of Dataframe");
 
     // auto df_final = df0;
@@ -60,14 +82,28 @@ int main(int argc, char *argv[]) {
     // ROOT 6.25
 
     Logger::get("main")->info("Finished Setup");
+    CorrectionRegistry::logStatistics();
+    // payloads, which are not used in the event loop (e.g. workspaces), can
+    // be freed now
+    CorrectionRegistry::releaseUnused();
     Logger::get("main")->info("Runtime for setup (real time: {}, CPU time: {})",
                               timer.RealTime(), timer.CpuTime());
     timer.Continue();
 
     Logger::get("main")->info("Starting Evaluation");
+    auto nevents = df0.Count();
+    TStopwatch looptimer;
     ROOT::RDF::RSnapshotOptions dfconfig;
     dfconfig.fLazy = true;
     // {RUN_COMMANDS}
+    looptimer.Stop();
+    Logger::get("main")->info(
+        "Processed {} events in {} s ({} events/s)", *nevents,
+        looptimer.RealTime(), *nevents / looptimer.RealTime());
+    if (!options.benchmark_report.empty()) {
+        utility::writeBenchmarkReport(options.benchmark_report, *nevents,
+                                      looptimer.RealTime());
+    }
     // Add meta-data
     const std::string outputfilename = {METADATAFILENAME};
     const std::vector<std::string> output_quanties = {OUTPUT_QUANTITIES};
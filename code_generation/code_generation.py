@@ -1,4 +1,6 @@
 import logging
+from code_generation.producer import Filter, unroll_calls
+from code_generation.quantity import NanoAODQuantity, QuantityGroup
 from git import Repo
 
 log = logging.getLogger(__name__)
@@ -9,60 +11,225 @@ class SafeDict(dict):
         return "{" + key + "}"
 
 
-def fill_template(t, config):
+def hoist_common_producers(config, scope_calls):
+    """
+    Find the producers, which are run with identical calls in several of the
+    non-global scopes and can be moved into the global scope. A producer is
+    moved, if
+
+    1. all scopes, that produce one of its outputs, use identical calls,
+    2. at least two scopes use these calls, and
+    3. all inputs are available in the global scope, i.e. they are NanoAOD
+       quantities or produced by a global or an already moved producer.
+
+    Filters are never moved, as they change the event selection of the scope.
+
+    Args:
+        config: The configuration dictionary
+        scope_calls: A dict mapping each non-global scope to a list of
+            (producer, calls) tuples in the order of the scope
+    Returns:
+        A list of (producer, calls, scopes) tuples for the moved producers, in
+        a valid ordering for the global scope
+    """
+    global_outputs = set()
+    for producer in config["producers"]["global"]:
+        global_outputs.update(producer.get_outputs("global"))
+    # the calls used for each output quantity, per scope
+    producing_calls = {}
+    for scope, producers in scope_calls.items():
+        for producer, calls in producers:
+            for quantity in producer.get_outputs(scope):
+                producing_calls.setdefault(quantity, {})[scope] = tuple(calls)
+    hoisted = []
+    hoisted_calls = set()
+    for scope, producers in scope_calls.items():
+        for producer, calls in producers:
+            calls = tuple(calls)
+            outputs = producer.get_outputs(scope)
+            if (
+                calls in hoisted_calls
+                or isinstance(producer, Filter)
+                or len(outputs) == 0
+            ):
+                continue
+            scopes = set()
+            for quantity in outputs:
+                scopes.update(producing_calls[quantity].keys())
+            if len(scopes) < 2 or any(
+                producing_calls[quantity].get(other_scope) != calls
+                for quantity in outputs
+                for other_scope in scopes
+            ):
+                continue
+            available = all(
+                isinstance(quantity, NanoAODQuantity)
+                or quantity in global_outputs
+                or quantity in outputs
+                for other_scope in scopes
+                for quantity in producer.get_inputs(other_scope)
+            )
+            if not available:
+                continue
+            hoisted.append(
+                (producer, calls, [x for x in scope_calls.keys() if x in scopes])
+            )
+            hoisted_calls.add(calls)
+            global_outputs.update(outputs)
+    return hoisted
+
+
+def shift_of_call(call, shifts):
+    """
+    Determine the shift computed by a call, from the shifted quantity names
+    used in it.
+
+    Args:
+        call: The call
+        shifts: The names of all shifts of the configuration, e.g. "__jesUp"
+    Returns:
+        The names of the shifts found in the call, separated by "+",
+        "variations" if the call computes all variations at once, or
+        "nominal" if the call does not use a shifted quantity
+    """
+    if call.startswith("utility::vary("):
+        return "variations"
+    found = sorted(shift[2:] for shift in shifts if shift + '"' in call)
+    return "+".join(found) if len(found) > 0 else "nominal"
+
+
+def write_calls(calls, df_name, first_df, instrumentation=None):
+    """
+    Write the C++ code for a list of calls, each call is assigned to a new
+    dataframe, starting with the index after first_df.
+
+    Args:
+        calls: The list of calls
+        df_name: A function returning the name of the dataframe with the given index
+        first_df: The index of the dataframe, the first call is applied to
+        instrumentation: If given, a tuple of the producer name and the shifts
+            of the configuration. Each call is then applied to an
+            instrumented dataframe, which counts the calls, time and
+            allocations of the producer and shift.
+    Returns:
+        The C++ code and the index of the last dataframe
+    """
+    code = ""
+    df_count = first_df
+    for call in calls:
+        output_df = df_name(df_count + 1)
+        input_df = df_name(df_count)
+        if instrumentation is not None:
+            producer_name, shifts = instrumentation
+            code += (
+                '    auto %s_input = utility::instrument(%s, "%s", "%s");\n'
+                % (output_df, input_df, producer_name, shift_of_call(call, shifts))
+            )
+            input_df = output_df + "_input"
+        formatted_call = call.format_map(
+            SafeDict({"df": input_df, "vec_open": "{", "vec_close": "}"})
+        )
+        if instrumentation is not None:
+            formatted_call = "utility::unwrap(%s)" % formatted_call
+        code += "    auto %s = %s;\n" % (output_df, formatted_call)
+        df_count += 1
+        log.debug("|---> {}".format(code.split("\n")[-2]))
+    return code, df_count
+
+
+def fill_template(t, config, instrumentation=False):
     # generate list of commands
     commandlist = ""  # string to be placed into code template
-    df_count = 0  # enumerate dataframes
-    df_scope_count = 0  # enumerate dataframes in certain scopes
     # get commands of producers and append to the command list
     log.info("Generating commands ...")
+    global_calls = []
     for producer in config["producers"]["global"]:
         producer.reserve_output("global")
-        commandlist += "\n    //" + producer.name + "\n"
-        for call in producer.writecalls(config, "global"):
-            commandlist += (
-                "    auto df%i = " % (df_count + 1)
-                + call.format_map(
-                    SafeDict(
-                        {"df": "df%i" % df_count, "vec_open": "{", "vec_close": "}"}
-                    )
-                )
-                + ";\n"
-            )
-            df_count += 1
-            log.debug("Adding call for {}".format(producer.name))
-            log.debug("|---> {}".format(commandlist.split("\n")[-2]))
-    commandlist += "    auto global_df_final = df%i;\n" % df_count
+        global_calls.append((producer, producer.writecalls(config, "global")))
+    scope_calls = {}
     for scope in config["producers"]:
         if scope == "global":
             continue
-        df_scope_count = 0
+        scope_calls[scope] = []
         for producer in config["producers"][scope]:
             producer.reserve_output(scope)
+            scope_calls[scope].append((producer, producer.writecalls(config, scope)))
+    # producers with identical calls in several scopes are run only once, in
+    # the global scope
+    hoisted = hoist_common_producers(config, scope_calls)
+    hoisted_calls = set(calls for _, calls, _ in hoisted)
+    if len(hoisted) > 0:
+        log.info(
+            "Moved {} producers common to several scopes into the global scope, saving {} calls:".format(
+                len(hoisted),
+                sum(len(calls) * (len(scopes) - 1) for _, calls, scopes in hoisted),
+            )
+        )
+        for producer, calls, scopes in hoisted:
+            log.info("  {} ({})".format(producer.name, ", ".join(scopes)))
+    shifts = [key for key in config if key.startswith("__")]
+    # in the instrumentation mode, each call is passed an instrumented
+    # dataframe labelled with the producer and shift
+    instrument = lambda producer: (producer.name, shifts) if instrumentation else None
+    global_df = lambda i: "df%i" % i
+    df_count = 0  # enumerate dataframes
+    for producer, calls in global_calls:
+        log.debug("Adding calls for {}".format(producer.name))
+        commandlist += "\n    //" + producer.name + "\n"
+        code, df_count = write_calls(
+            calls, global_df, df_count, instrument(producer)
+        )
+        commandlist += code
+    for producer, calls, scopes in hoisted:
+        log.debug("Adding calls for {}".format(producer.name))
+        commandlist += "\n    //%s (common to %s)\n" % (
+            producer.name,
+            ", ".join(scopes),
+        )
+        code, df_count = write_calls(
+            calls, global_df, df_count, instrument(producer)
+        )
+        commandlist += code
+    commandlist += "    auto global_df_final = df%i;\n" % df_count
+    for scope in scope_calls:
+        # enumerate dataframes in the scope, the first one is the final global
+        # dataframe
+        scope_df = (
+            lambda i, scope=scope: "global_df_final"
+            if i == 0
+            else "%s_df%i" % (scope, i)
+        )
+        df_scope_count = 0
+        for producer, calls in scope_calls[scope]:
+            if tuple(calls) in hoisted_calls:
+                continue
+            log.debug("Adding calls for {}".format(producer.name))
             commandlist += "\n    //" + producer.name + "\n"
-            for call in producer.writecalls(config, scope):
-                commandlist += (
-                    "    auto %s_df%i = " % (scope, df_scope_count + 1)
-                    + call.format_map(
-                        SafeDict(
-                            {"df": "global_df_final", "vec_open": "{", "vec_close": "}"}
-                            if df_scope_count == 0
-                            else {
-                                "df": "%s_df%i" % (scope, df_scope_count),
-                                "vec_open": "{",
-                                "vec_close": "}",
-                            }
-                        )
-                    )
-                    + ";\n"
-                )
-                log.debug("Adding call for {}".format(producer.name))
-                log.debug("|---> {}".format(commandlist.split("\n")[-2]))
-                df_scope_count += 1
-        commandlist += "    auto %s_df_final = %s_df%i;\n" % (
-            scope,
+            code, df_scope_count = write_calls(
+                calls, scope_df, df_scope_count, instrument(producer)
+            )
+            commandlist += code
+        # the output quantities stored in variation columns are unrolled into
+        # their leaves
+        outputs = []
+        shifts_of_scope = [""]
+        for quantity in config["output"].get(scope, []):
+            quantities = (
+                quantity.quantities
+                if isinstance(quantity, QuantityGroup)
+                else [quantity]
+            )
+            for x in quantities:
+                outputs.append(x)
+                shifts_of_scope.extend(x.get_shifts(scope))
+        calls = unroll_calls(outputs, scope, shifts_of_scope)
+        if len(calls) > 0:
+            commandlist += "\n    //Unroll variations\n"
+            code, df_scope_count = write_calls(calls, scope_df, df_scope_count)
+            commandlist += code
+        commandlist += "    auto %s_df_final = %s;\n" % (
             scope,
-            df_scope_count,
+            scope_df(df_scope_count),
         )
     commandlist += "\n"
     for scope in config["output"]:
@@ -89,6 +256,15 @@ def fill_template(t, config):
         runcommands += "    %s_result.GetValue();\n" % scope
         runcommands += '    Logger::get("main")->info("%s:");\n' % scope
         runcommands += "    %s_cutReport->Print();\n" % scope
+    runcommands += "    if (!options.filter_profile.empty()) {\n"
+    runcommands += "        utility::FilterProfile::write(options.filter_profile, {%s});\n" % (
+        ", ".join(
+            '{"%s", *%s_cutReport}' % (scope, scope) for scope in config["output"]
+        )
+    )
+    runcommands += "    }\n"
+    if instrumentation:
+        runcommands += '    utility::Instrumentation::report(std::string(output_path) + "instrumentation.json");\n'
     nruns = (
         "("
         + "+".join(["%s_df_final.GetNRuns()" % scope for scope in config["producers"]])
@@ -1,5 +1,6 @@
 from code_generation.quantity import NanoAODQuantity
-from code_generation.producer import Filter
+from code_generation.producer import Filter, VectorProducer
+import json
 import logging
 
 log = logging.getLogger(__name__)
@@ -22,15 +23,17 @@ class ProducerOrdering:
     Args:
         config: The configuration dictionary
         scope: The scope of the producer ordering
+        filter_profile: An optional FilterProfile, used to order the filters
     """
 
-    def __init__(self, config, scope):
+    def __init__(self, config, scope, filter_profile=None):
         self.global_producers = config["producers"]["global"]
         self.ordering = config["producers"][scope]
         self.size = len(self.ordering)
         self.config = config
         self.scope = scope
         self.optimized = False
+        self.filter_profile = filter_profile
         self.global_outputs = self.get_global_outputs()
 
     """
@@ -82,7 +85,10 @@ class ProducerOrdering:
         return outputs
 
     """
-    Function used to relocate all filters to the top of the ordering
+    Function used to relocate all filters to the top of the ordering.
+    If a filter profile is given, the filters are sorted by their
+    rejection per unit cost, keeping the current order of filters,
+    which are not part of the profile.
 
     Args:
         None
@@ -92,11 +98,25 @@ class ProducerOrdering:
 
     def MoveFiltersUp(self):
         new_ordering = []
-        for producer in self.ordering:
-            if isinstance(producer, Filter):
-                new_ordering.insert(0, producer)
-            else:
-                new_ordering.append(producer)
+        if self.filter_profile is not None:
+            filters = [x for x in self.ordering if isinstance(x, Filter)]
+            new_ordering = self.filter_profile.sort(
+                filters, self.scope, self.filter_profile.filter_names
+            )
+            new_ordering.extend(x for x in self.ordering if x not in filters)
+            if len(filters) > 0:
+                log.info(
+                    "Order of the filters in scope {}: {}".format(
+                        self.scope,
+                        ", ".join(x.name for x in new_ordering[: len(filters)]),
+                    )
+                )
+        else:
+            for producer in self.ordering:
+                if isinstance(producer, Filter):
+                    new_ordering.insert(0, producer)
+                else:
+                    new_ordering.append(producer)
         for i, prod in enumerate(self.ordering):
             log.debug(" --> {}. : {}".format(i, prod))
         for i, prod in enumerate(new_ordering):
@@ -286,3 +306,331 @@ class ProducerOrdering:
         for i, prod in enumerate(new_ordering):
             log.debug(" --> {}. : {}".format(i, prod))
         self.ordering = new_ordering
+
+
+"""
+Class used to read a filter profile, which is written by an executable run with
+the --filter-profile option. For each scope, the profile contains the cut flow
+of the named filters and the time spent for their evaluation. The filters are
+scored by the fraction of rejected events per second of evaluation time, so the
+cheapest filters rejecting the most events are applied first. The rejection is
+measured for the events reaching the filter, so it depends on the order of the
+profiled run.
+"""
+
+
+class FilterProfile:
+
+    """
+    Init function
+
+    Args:
+        filename: The path to the JSON file containing the profile
+    """
+
+    def __init__(self, filename):
+        log.info("Reading filter profile {}".format(filename))
+        with open(filename, "r") as profile_file:
+            self.profile = json.load(profile_file)["filters"]
+        # the global filters are part of the cut flow of every scope
+        self.global_profile = {}
+        for entries in self.profile.values():
+            for entry in entries:
+                self.global_profile.setdefault(entry["name"], entry)
+
+    """
+    Function to get the score of a filter, the rejected fraction of events
+    divided by the mean evaluation time.
+
+    Args:
+        name: The name of the filter, as used in the cut flow report
+        scope: The scope of the filter
+    Returns:
+        The score of the filter or None, if the filter is not in the profile
+    """
+
+    def score(self, name, scope):
+        if scope == "global":
+            entry = self.global_profile.get(name)
+        else:
+            entry = next(
+                (x for x in self.profile.get(scope, []) if x["name"] == name), None
+            )
+        if entry is None or entry["all"] == 0:
+            return None
+        rejection = 1.0 - float(entry["pass"]) / entry["all"]
+        # filters, which were not measured, are assumed to be cheap
+        cost = 1e-9
+        if entry["evaluations"] > 0:
+            cost = max(cost, entry["seconds"] / entry["evaluations"])
+        return rejection / cost
+
+    """
+    Helper function to get the names of the filters applied by a filter producer.
+    The names are found in the call of the producer.
+
+    Args:
+        producer: The Filter producer
+    Returns:
+        A function returning True, if a given name belongs to the producer
+    """
+
+    def filter_names(self, producer):
+        return lambda name: '"{}"'.format(name) in producer.call
+
+    """
+    Function used to sort a list of filters by their score, the filter with the
+    highest score comes first. Filters without a score are kept at the
+    beginning in their current order.
+
+    Args:
+        filters: The list of filters to sort
+        scope: The scope of the filters
+        names: A function returning for a filter a function to match the names of
+            the cut flow report, or None if the filters are the names themselves
+    Returns:
+        The sorted list of filters
+    """
+
+    def sort(self, filters, scope, names=None):
+        if scope == "global":
+            candidates = list(self.global_profile.keys())
+        else:
+            candidates = [x["name"] for x in self.profile.get(scope, [])]
+        scores = []
+        for item in filters:
+            matching = (
+                [item] if names is None else [x for x in candidates if names(item)(x)]
+            )
+            item_scores = [
+                score
+                for score in (self.score(name, scope) for name in matching)
+                if score is not None
+            ]
+            scores.append(max(item_scores) if len(item_scores) > 0 else None)
+        unprofiled = [x for x, score in zip(filters, scores) if score is None]
+        profiled = [
+            (x, score) for x, score in zip(filters, scores) if score is not None
+        ]
+        profiled.sort(key=lambda x: -x[1])
+        for item, score in profiled:
+            log.debug("Filter {} ({}): score {:.3g}".format(item, scope, score))
+        return unprofiled + [x for x, _ in profiled]
+
+    """
+    Function used to sort the filters applied by vector producers, e.g. the MET
+    filters. This is done for vector producers without outputs and with a single
+    configuration list, whose entries are used as the filter names. The list is
+    sorted in the nominal configuration and all shifts.
+
+    Args:
+        config: The configuration dictionary
+    Returns:
+        None
+    """
+
+    def sort_vector_filters(self, config):
+        for scope in config["producers"]:
+            for producer in config["producers"][scope]:
+                if (
+                    not isinstance(producer, VectorProducer)
+                    or producer.output is not None
+                    or len(producer.vec_configs) != 1
+                    or '"{%s}"' % producer.vec_configs[0] not in producer.call
+                ):
+                    continue
+                key = producer.vec_configs[0]
+                for shift in config:
+                    if shift == "" or shift.startswith("__"):
+                        config[shift][scope][key] = self.sort(
+                            config[shift][scope][key], scope
+                        )
+                log.info(
+                    "Order of the filters of {}: {}".format(
+                        producer.name, ", ".join(config[""][scope][key])
+                    )
+                )
+
+
+"""
+Class used to remove producers and shifts, which do not contribute to the output.
+
+Starting from the output quantities of each scope, the producers are traversed
+in reverse order. A producer is kept, if one of its outputs is needed by the output
+or by another producer that is kept. Filters and producers without outputs are
+always kept, since they change the selected events. The inputs of the producers in the other scopes are also
+considered for the global scope.
+
+Afterwards, a shift is removed from all quantities of a scope, if none of the output
+quantities of that scope carries the shift. Shifts that do not reach any output
+are removed from the configuration completely.
+"""
+
+
+class ProducerPruning:
+
+    """
+    Init function
+
+    Args:
+        config: The configuration dictionary
+    """
+
+    def __init__(self, config):
+        self.config = config
+        self.removed_producers = {}
+        self.removed_shifts = {}
+        self.nanoaod_quantities = set()
+
+    """
+    Function used to collect all quantities, which are handled by a producer,
+    including the quantities of all subproducers.
+
+    Args:
+        producer: The producer to collect the quantities from
+        scope: The scope of the producer
+    Returns:
+        A list of all input and output quantities of the producer
+    """
+
+    def collect_quantities(self, producer, scope):
+        quantities = list(producer.get_inputs(scope))
+        quantities.extend(producer.get_outputs(scope))
+        if hasattr(producer, "producers"):
+            for subproducer in producer.producers:
+                quantities.extend(self.collect_quantities(subproducer, scope))
+        return quantities
+
+    """
+    Function used to remove all producers of a scope, whose outputs are not needed.
+
+    Args:
+        scope: The scope to prune
+        needed: A set of the needed quantities, the inputs of the
+            remaining producers are added to this set
+    Returns:
+        None
+    """
+
+    def prune_producers(self, scope, needed):
+        kept = []
+        for producer in reversed(self.config["producers"][scope]):
+            outputs = producer.get_outputs(scope)
+            if (
+                isinstance(producer, Filter)
+                or len(outputs) == 0
+                or any(quantity in needed for quantity in outputs)
+            ):
+                kept.insert(0, producer)
+                needed.update(producer.get_inputs(scope))
+            else:
+                log.debug("Removing unused producer {} ({})".format(producer, scope))
+                self.removed_producers.setdefault(scope, []).append(producer.name)
+        self.config["producers"][scope] = kept
+
+    """
+    Function used to remove the shifts of a scope, that do not reach the output.
+    Shifts of NanoAOD quantities are not bound to a scope, they are only
+    collected here and removed at the end.
+
+    Args:
+        scope: The scope to prune
+        output_shifts: A set of the shifts of the output quantities of the scope
+    Returns:
+        None
+    """
+
+    def prune_shifts(self, scope, output_shifts):
+        for producer in self.config["producers"][scope]:
+            for quantity in self.collect_quantities(producer, scope):
+                if isinstance(quantity, NanoAODQuantity):
+                    self.nanoaod_quantities.add(quantity)
+                    continue
+                shifts = quantity.shifts.get(scope, set())
+                for shift in [x for x in shifts if x not in output_shifts]:
+                    log.debug("Removing shift {} from {}".format(shift, quantity))
+                    shifts.discard(shift)
+                    self.removed_shifts.setdefault(shift, set()).add(scope)
+
+    """
+    Function used to collect the shifts of all quantities of a scope, which is
+    not written to the output. These shifts are kept.
+
+    Args:
+        scope: The scope without output
+    Returns:
+        A set of all shifts of the scope
+    """
+
+    def get_shifts(self, scope):
+        shifts = set()
+        for producer in self.config["producers"][scope]:
+            for quantity in self.collect_quantities(producer, scope):
+                shifts.update(quantity.get_shifts(scope))
+        return shifts
+
+    """
+    The main function of this class. First, the unused producers are removed
+    from all scopes, starting with the scopes that are written to the output and
+    ending with the global scope. Afterwards, the unused shifts are removed
+    and a summary of the removed producers and shifts is logged.
+
+    Args:
+        None
+    Returns:
+        None
+    """
+
+    def Prune(self):
+        outputs = self.config["output"]
+        needed_global = set(outputs.get("global", []))
+        all_shifts = set()
+        for scope in self.config["producers"]:
+            if scope == "global":
+                continue
+            if scope not in outputs:
+                log.warning(
+                    "Scope {} has no output, keeping all producers and shifts".format(
+                        scope
+                    )
+                )
+                for producer in self.config["producers"][scope]:
+                    needed_global.update(producer.get_inputs(scope))
+                all_shifts.update(self.get_shifts(scope))
+                continue
+            needed = set(outputs[scope])
+            self.prune_producers(scope, needed)
+            needed_global.update(needed)
+            output_shifts = set()
+            for quantity in outputs[scope]:
+                output_shifts.update(quantity.get_shifts(scope))
+            all_shifts.update(output_shifts)
+            self.prune_shifts(scope, output_shifts)
+        if "global" in self.config["producers"]:
+            self.prune_producers("global", needed_global)
+            for quantity in outputs.get("global", []):
+                all_shifts.update(quantity.get_shifts("global"))
+            self.prune_shifts("global", all_shifts)
+        for quantity in self.nanoaod_quantities:
+            for shift in [x for x in quantity.shifted_naming if x not in all_shifts]:
+                log.debug("Removing shift {} from {}".format(shift, quantity))
+                del quantity.shifted_naming[shift]
+                self.removed_shifts.setdefault(shift, set()).add("global")
+        for scope, producers in self.removed_producers.items():
+            log.info(
+                "Removed {} unused producers from scope {}: {}".format(
+                    len(producers), scope, ", ".join(reversed(producers))
+                )
+            )
+        # shifts are stored in the configuration with a leading "__"
+        for shift in sorted(self.config.keys()):
+            if shift.startswith("__") and shift not in all_shifts:
+                log.info("Removed unused shift {}".format(shift))
+                del self.config[shift]
+        for shift in sorted(self.removed_shifts):
+            if shift in all_shifts:
+                log.info(
+                    "Removed shift {} from unused quantities in scopes {}".format(
+                        shift, ", ".join(sorted(self.removed_shifts[shift]))
+                    )
+                )
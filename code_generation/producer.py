@@ -1,5 +1,7 @@
 import code_generation.quantity as q
 import logging
+import re
+import string
 
 log = logging.getLogger(__name__)
 
@@ -9,7 +11,53 @@ class SafeDict(dict):
         return "{" + key + "}"
 
 
+def unroll_calls(quantities, scope, shifts):
+    """
+    Calls defining the leaves of the given shifts of the quantities, which are
+    stored with all their variations in a single column, see
+    utility::VariationNode. Quantities without a variation column and leaves,
+    which are already defined, are skipped.
+    """
+    calls = []
+    for quantity in quantities:
+        if quantity.get_variations(scope) is None:
+            continue
+        leaves = quantity.unroll(shifts, scope)
+        if len(leaves) == 0:
+            continue
+        calls.append(
+            'utility::unroll({{df}}, "{}", {{vec_open}}{}{{vec_close}}, {{vec_open}}{}{{vec_close}})'.format(
+                quantity.name,
+                ", ".join('"{}"'.format(leaf) for leaf, _ in leaves),
+                ", ".join(str(index) for _, index in leaves),
+            )
+        )
+    return calls
+
+
+def format_fields(text):
+    """
+    Names of the fields used in a format string, e.g. of a call.
+    """
+    return set(
+        re.split(r"[.\[]", field)[0]
+        for _, field, _, _ in string.Formatter().parse(text)
+        if field
+    )
+
+
 class Producer:
+    # configuration keys set by writecall
+    generated_keys = {
+        "df",
+        "input",
+        "input_vec",
+        "output",
+        "output_vec",
+        "vec_open",
+        "vec_close",
+    }
+
     def __init__(self, name, call, input, output, scopes):
         log.debug("Setting up a new producer {}".format(name))
 
@@ -158,6 +206,76 @@ class Producer:
             log.error("Call: {}".format(self.call))
             raise Exception
 
+    def parameters(self):
+        """
+        Return the configuration keys read by the call of the producer.
+        """
+        return format_fields(self.call) - set(self.generated_keys)
+
+    def variation_shifts(self, config, scope):
+        """
+        Return the shifts of the outputs, if the producer can compute them in
+        a single call from the variation columns of its inputs, else None.
+        This is possible, if all outputs are shifted only by inputs with a
+        variation column and the configuration parameters of the producer are
+        the same in all shifts.
+        """
+        if self.output is None or len(self.output) == 0:
+            return None
+        if any(isinstance(x, q.QuantityGroup) for x in self.output):
+            return None
+        shifts = set()
+        for quantity in self.output:
+            shifts.update(quantity.get_shifts(scope))
+        carried = set()
+        for quantity in self.input[scope]:
+            input_shifts = shifts.intersection(quantity.get_shifts(scope))
+            if len(input_shifts) > 0 and quantity.get_variations(scope) is None:
+                return None
+            carried.update(input_shifts)
+        if len(shifts) == 0 or carried != shifts:
+            return None
+
+        def cpp_value(value):
+            if isinstance(value, bool):
+                return "true" if value else "false"
+            return value
+
+        for shift in shifts:
+            for para in self.parameters():
+                if cpp_value(config[shift][scope].get(para)) != cpp_value(
+                    config[""][scope].get(para)
+                ):
+                    return None
+        return sorted(shifts)
+
+    def writevariationcall(self, config, scope, shifts):
+        """
+        Write a single call computing the outputs for the nominal configuration
+        and the given shifts, see utility::vary. The nominal call is run on a
+        utility::VariationNode, which defines the variation columns of the
+        outputs.
+        """
+        variations = [""] + shifts
+        inputs = []
+        for quantity in self.input[scope]:
+            if quantity.get_variations(scope) is None:
+                continue
+            entry = '{{vec_open}}"{}", {{vec_open}}{}{{vec_close}}{{vec_close}}'.format(
+                quantity.name,
+                ", ".join(
+                    str(quantity.variation_index(shift, scope)) for shift in variations
+                ),
+            )
+            if entry not in inputs:
+                inputs.append(entry)
+        call = self.writecall(config, scope).replace("{df}", "node")
+        for quantity in self.output:
+            quantity.set_variations(shifts, scope)
+        return "utility::vary({{df}}, {}, {{vec_open}}{}{{vec_close}}, [](auto &node) {{vec_open}} return {}; {{vec_close}})".format(
+            len(variations), ", ".join(inputs), call
+        )
+
     def writecalls(self, config, scope):
         if scope not in self.scopes:
             log.error(
@@ -166,13 +284,18 @@ class Producer:
                 )
             )
             raise Exception
-        calls = [self.writecall(config, scope)]
+        shifts = self.variation_shifts(config, scope)
+        if shifts is not None:
+            return [self.writevariationcall(config, scope, shifts)]
+        list_of_shifts = []
         if self.output != None:
             list_of_shifts = self.output[0].get_shifts(
                 scope
             )  # all entries must have same shifts
-            for shift in list_of_shifts:
-                calls.append(self.writecall(config, scope, shift))
+        calls = unroll_calls(self.input[scope], scope, [""] + list_of_shifts)
+        calls.append(self.writecall(config, scope))
+        for shift in list_of_shifts:
+            calls.append(self.writecall(config, scope, shift))
         return calls
 
     def get_inputs(self, scope):
@@ -213,10 +336,10 @@ class VectorProducer(Producer):
 
     def writecalls(self, config, scope):
         basecall = self.call
-        calls = []
         shifts = [""]
         if self.output != None:
             shifts.extend(self.output[0].get_shifts(scope))
+        calls = unroll_calls(self.input[scope], scope, shifts)
         for shift in shifts:
             # check that all config lists (and output if applicable) have same length
             n_versions = len(config[shift][scope][self.vec_configs[0]])
@@ -276,9 +399,9 @@ class TriggerVectorProducer(Producer):
         for i in range(n_versions):
             self.output[0].add(config[""][scope][self.vec_config][i][self.outputname])
         basecall = self.call
-        calls = []
         shifts = [""]
         shifts.extend(self.output[0].get_shifts(scope))
+        calls = unroll_calls(self.input[scope], scope, shifts)
         for shift in shifts:
             for i in range(n_versions):
                 # the information for the producer is directly read from the configuration
@@ -295,6 +418,534 @@ class TriggerVectorProducer(Producer):
         return calls
 
 
+class PackedTriggerProducer(Producer):
+    """
+    Producer evaluating a list of trigger paths in a single step. The paths are
+    read from the given configuration lists, using the same entries as for the
+    TriggerVectorProducer. Paths with a single object use the keys ptcut,
+    etacut, trigger_particle_id and filterbit, paths with two objects use the
+    keys with the prefixes p1_ and p2_. The results are packed into one output
+    quantity, where bit i belongs to the i-th path of the concatenated lists.
+    The flags of the individual paths are available as the quantities in
+    output_group, named by the flagname of the path. A packed flag depends on
+    all of its inputs, so paths with one and with two objects should be packed
+    by separate producers. Otherwise, the flags of the single object paths
+    would also be shifted by the shifts of the second object. Paths with two
+    objects can only be used, if the call passes the p2_ requirements.
+    """
+
+    max_paths = 64
+
+    def __init__(self, name, call, unpack_call, input, output, scope, vec_configs):
+        self.unpack_call = unpack_call
+        self.vec_configs = vec_configs
+        if len(scope) != 1:
+            log.error("PackedTriggerProducer can only use one scope per instance !")
+            raise Exception
+        if not isinstance(output, list) or len(output) != 1:
+            log.error(
+                "PackedTriggerProducer {} requires exactly one output quantity !".format(
+                    name
+                )
+            )
+            raise Exception
+        super().__init__(name, call, input, output + [q.QuantityGroup(name)], scope)
+
+    def __str__(self) -> str:
+        return "PackedTriggerProducer: {}".format(self.name)
+
+    def __repr__(self) -> str:
+        return "PackedTriggerProducer: {}".format(self.name)
+
+    @property
+    def output_group(self):
+        return self.output[1]
+
+    def get_paths(self, config, shift, scope):
+        paths = []
+        for vec_config in self.vec_configs:
+            paths.extend(config[shift][scope][vec_config])
+        return paths
+
+    def path_requirements(self, paths):
+        # the requirements are written as C++ vectors, using the vec_open and
+        # vec_close placeholders for the braces
+        def vector(values):
+            return "{vec_open}" + ", ".join(str(x) for x in values) + "{vec_close}"
+
+        requirements = {"n_paths": len(paths)}
+        keys = {
+            "ptcuts": "ptcut",
+            "etacuts": "etacut",
+            "trigger_particle_ids": "trigger_particle_id",
+            "filterbits": "filterbit",
+        }
+        for name, key in keys.items():
+            p1_values = []
+            p2_values = []
+            for path in paths:
+                if key in path:
+                    p1_values.append(path[key])
+                    # a negative id disables the matching of the second object
+                    p2_values.append(-1 if key == "trigger_particle_id" else 0)
+                else:
+                    p1_values.append(path["p1_" + key])
+                    p2_values.append(path["p2_" + key])
+            requirements["p1_" + name] = vector(p1_values)
+            requirements["p2_" + name] = vector(p2_values)
+        requirements["hlt_paths"] = vector(
+            '"{}"'.format(path["hlt_path"]) for path in paths
+        )
+        requirements["max_deltaR_triggermatch"] = vector(
+            path["max_deltaR_triggermatch"] for path in paths
+        )
+        return requirements
+
+    def writecalls(self, config, scope):
+        paths = self.get_paths(config, "", scope)
+        if len(paths) > self.max_paths:
+            log.error(
+                "PackedTriggerProducer {} can hold at most {} paths, but {} are configured !".format(
+                    self.name, self.max_paths, len(paths)
+                )
+            )
+            raise Exception
+        if "{p2_" not in self.call:
+            for path in paths:
+                if path.get("p2_trigger_particle_id", -1) >= 0:
+                    log.error(
+                        "PackedTriggerProducer {} only matches a single object, but path {} requires two !".format(
+                            self.name, path["hlt_path"]
+                        )
+                    )
+                    raise Exception
+        if len(self.output_group.quantities) == 0:
+            for path in paths:
+                self.output_group.add(path["flagname"])
+        basecall = self.call
+        shifts = [""]
+        shifts.extend(self.output[0].get_shifts(scope))
+        calls = unroll_calls(self.input[scope], scope, shifts)
+        for shift in shifts:
+            packed = self.output[0].get_leaf(shift, scope)
+            helper_dict = self.path_requirements(self.get_paths(config, shift, scope))
+            helper_dict["output"] = '"' + packed + '"'
+            self.call = basecall.format_map(SafeDict(helper_dict))
+            calls.append(self.writecall(config, scope, shift))
+            for i, quantity in enumerate(self.output_group.quantities):
+                calls.append(
+                    self.unpack_call.format(
+                        df="{df}",
+                        output='"' + quantity.get_leaf(shift, scope) + '"',
+                        input='"' + packed + '"',
+                        index=i,
+                    )
+                )
+        self.call = basecall
+        return calls
+
+
+class FusedProducer(Producer):
+    """
+    Producer computing the nominal value and all systematic shifts of its
+    output in a single call, instead of one call per shift. The configuration
+    parameters listed in variation_parameters are passed to the call as
+    vectors, holding the value of the nominal configuration followed by the
+    values of the shifts in alphabetical order. The call has to define the
+    variation column of the output, see utility::DefineVariations, which is
+    read by the following producers. The inputs of a FusedProducer must not be
+    shifted. Fusing is opt-in, a configuration uses a FusedProducer in place of
+    the producer run once per shift. The following producers are then lifted
+    to the variation columns, see Producer.variation_shifts, so their calls
+    must not filter the dataframe or define columns from expressions.
+    """
+
+    def __init__(self, name, call, input, output, scopes, variation_parameters):
+        self.variation_parameters = variation_parameters
+        if not isinstance(output, list) or len(output) != 1:
+            log.error(
+                "FusedProducer {} requires exactly one output quantity !".format(name)
+            )
+            raise Exception
+        super().__init__(name, call, input, output, scopes)
+
+    def __str__(self) -> str:
+        return "FusedProducer: {}".format(self.name)
+
+    def __repr__(self) -> str:
+        return "FusedProducer: {}".format(self.name)
+
+    def variation_vector(self, values):
+        # the values are written as a C++ vector, the braces of the vector and
+        # of values like '{""}' are replaced by the vec_open and vec_close
+        # placeholders
+        def protect(value):
+            if isinstance(value, bool):
+                value = "true" if value else "false"
+            return "".join(
+                "{vec_open}" if c == "{" else "{vec_close}" if c == "}" else c
+                for c in str(value)
+            )
+
+        return "{vec_open}" + ", ".join(protect(x) for x in values) + "{vec_close}"
+
+    def writecalls(self, config, scope):
+        if scope not in self.scopes:
+            log.error(
+                "Exception ({}): Tried to use producer in scope {}, which the producer is not forseen for!".format(
+                    self.name, scope
+                )
+            )
+            raise Exception
+        for input_quantity in self.input[scope]:
+            if len(input_quantity.get_shifts(scope)) > 0:
+                log.error(
+                    "FusedProducer {} can not be used with the shifted input {} !".format(
+                        self.name, input_quantity.name
+                    )
+                )
+                raise Exception
+        shifts = [""]
+        shifts.extend(sorted(self.output[0].get_shifts(scope)))
+        calls = unroll_calls(self.input[scope], scope, [""])
+        format_dict = dict(config[""][scope])
+        for para in format_dict:
+            if isinstance(format_dict[para], bool):
+                format_dict[para] = "true" if format_dict[para] else "false"
+        format_dict["df"] = "{df}"
+        format_dict["vec_open"] = "{vec_open}"
+        format_dict["vec_close"] = "{vec_close}"
+        format_dict["input"] = (
+            '"' + '", "'.join([x.get_leaf("", scope) for x in self.input[scope]]) + '"'
+        )
+        format_dict["output"] = '"{}"'.format(self.output[0].name)
+        for para in self.variation_parameters:
+            try:
+                format_dict[para] = self.variation_vector(
+                    config[shift][scope][para] for shift in shifts
+                )
+            except KeyError as e:
+                log.error(
+                    "Error in {} Producer, key {} is not found in configuration".format(
+                        self.name, e
+                    )
+                )
+                raise Exception
+        self.output[0].set_variations(shifts[1:], scope)
+        try:
+            return calls + [self.call.format(**format_dict)]
+        except KeyError as e:
+            log.error(
+                "Error in {} Producer, key {} is not found in configuration".format(
+                    self.name, e
+                )
+            )
+            log.error("Call: {}".format(self.call))
+            raise Exception
+
+
+class CutProducer(Producer):
+    """
+    Producer of the mask of the objects passing a single cut. In addition to
+    the call, the cut is declared by cut, the name of a cut of the namespace
+    physicsobject::selection, and by cut_arguments, the arguments of the cut.
+    The arguments are formatted like the call, {input} is the column of the
+    input of the producer. With this declaration, an ObjectSelector can
+    evaluate the cut together with the other cuts of a selection.
+    """
+
+    def __init__(self, name, call, input, output, scopes, cut, cut_arguments):
+        super().__init__(name, call, input, output, scopes)
+        self.cut = cut
+        self.cut_arguments = cut_arguments
+
+    def __str__(self) -> str:
+        return "CutProducer: {}".format(self.name)
+
+    def __repr__(self) -> str:
+        return "CutProducer: {}".format(self.name)
+
+
+class VectorCutProducer(VectorProducer):
+    """
+    VectorProducer applying one cut per entry of the config lists vec_configs,
+    e.g. one cut per tau ID. The cut is declared like for a CutProducer, the
+    config lists can be used in the cut_arguments.
+    """
+
+    def __init__(
+        self, name, call, input, output, scopes, vec_configs, cut, cut_arguments
+    ):
+        super().__init__(name, call, input, output, scopes, vec_configs)
+        self.cut = cut
+        self.cut_arguments = cut_arguments
+
+    def __str__(self) -> str:
+        return "VectorCutProducer: {}".format(self.name)
+
+    def __repr__(self) -> str:
+        return "VectorCutProducer: {}".format(self.name)
+
+
+class QuantityProducer(Producer):
+    """
+    Producer writing out a single quantity of one particle of the pair. In
+    addition to the call, the quantity is declared by quantity, the name of a
+    quantity of the namespace quantities::particle, and by quantity_arguments,
+    the arguments of the quantity. The arguments are formatted like the call,
+    {input} are the columns of the inputs of the producer except for the pair.
+    With this declaration, an UnpackProducer can gather the quantity together
+    with the other quantities of the particle.
+    """
+
+    def __init__(self, name, call, input, output, scopes, quantity, quantity_arguments):
+        super().__init__(name, call, input, output, scopes)
+        self.quantity = quantity
+        self.quantity_arguments = quantity_arguments
+
+    def __str__(self) -> str:
+        return "QuantityProducer: {}".format(self.name)
+
+    def __repr__(self) -> str:
+        return "QuantityProducer: {}".format(self.name)
+
+
+class ObjectSelector(Producer):
+    """
+    Producer evaluating all cuts of an object selection in a single step, see
+    physicsobject::SelectObjects. It is set up like a ProducerGroup combining
+    the masks of its subproducers, but instead of one mask per subproducer,
+    the cuts declared by the subproducers are passed to the call as {cuts},
+    after the inputs of the selector, which are used as additional masks. All
+    subproducers have to be a CutProducer or a VectorCutProducer.
+    """
+
+    def __init__(self, name, call, input, output, scopes, subproducers):
+        self.subproducers = subproducers
+        # an empty output is assigned by a surrounding ProducerGroup
+        if not isinstance(output, list) or len(output) > 1:
+            log.error(
+                "ObjectSelector {} requires a single output quantity !".format(name)
+            )
+            raise Exception
+        for subproducer in self.subproducers:
+            if not isinstance(subproducer, (CutProducer, VectorCutProducer)):
+                log.error(
+                    "ObjectSelector {}: subproducer {} does not declare a cut !".format(
+                        name, subproducer.name
+                    )
+                )
+                raise Exception
+        if not isinstance(input, dict):
+            input = {scope: list(input) for scope in scopes}
+        self.masks = input
+        # the selector reads the inputs of all subproducers
+        inputs = {}
+        for scope in scopes:
+            inputs[scope] = list(self.masks[scope])
+            for subproducer in self.subproducers:
+                for quantity in subproducer.get_inputs(scope):
+                    if quantity not in inputs[scope]:
+                        inputs[scope].append(quantity)
+        super().__init__(name, call, inputs, output, scopes)
+
+    def __str__(self) -> str:
+        return "ObjectSelector: {}".format(self.name)
+
+    def __repr__(self) -> str:
+        return "ObjectSelector: {}".format(self.name)
+
+    def parameters(self):
+        result = super().parameters() - {"cuts"}
+        for subproducer in self.subproducers:
+            result.update(subproducer.parameters())
+            for argument in subproducer.cut_arguments:
+                result.update(format_fields(argument))
+        return result - {"input", "vec_open", "vec_close"}
+
+    def writecuts(self, subproducer, config, scope, shift):
+        format_dict = {}
+        for para, value in config[shift][scope].items():
+            if isinstance(value, bool):
+                value = "true" if value else "false"
+            format_dict[para] = value
+        format_dict["vec_open"] = "{vec_open}"
+        format_dict["vec_close"] = "{vec_close}"
+        format_dict["input"] = ", ".join(
+            '"{}"'.format(x.get_leaf(shift, scope))
+            for x in subproducer.get_inputs(scope)
+        )
+        versions = [{}]
+        if isinstance(subproducer, VectorCutProducer):
+            n_versions = len(config[shift][scope][subproducer.vec_configs[0]])
+            versions = [
+                {key: config[shift][scope][key][i] for key in subproducer.vec_configs}
+                for i in range(n_versions)
+            ]
+        cuts = []
+        for version in versions:
+            try:
+                arguments = [
+                    argument.format(**dict(format_dict, **version))
+                    for argument in subproducer.cut_arguments
+                ]
+            except KeyError as e:
+                log.error(
+                    "Error in {} Producer, key {} is not found in configuration".format(
+                        subproducer.name, e
+                    )
+                )
+                raise Exception
+            cuts.append(
+                "physicsobject::selection::{}({})".format(
+                    subproducer.cut, ", ".join(arguments)
+                )
+            )
+        return cuts
+
+    def writecall(self, config, scope, shift=""):
+        cuts = [
+            'physicsobject::selection::Mask("{}")'.format(x.get_leaf(shift, scope))
+            for x in self.masks[scope]
+        ]
+        for subproducer in self.subproducers:
+            cuts.extend(self.writecuts(subproducer, config, scope, shift))
+        config[shift][scope]["cuts"] = ", ".join(cuts)
+        return super().writecall(config, scope, shift)
+
+
+class UnpackProducer(Producer):
+    """
+    Producer writing out several quantities of the same particle in a single
+    step, see quantities::Unpack. It is set up like a ProducerGroup of the
+    producers of the single quantities, e.g. quantities::pt or
+    quantities::dxy, but instead of one call per quantity, the quantities are
+    gathered into one tuple column and are then unpacked into their output
+    columns. The input is the pair vector, the output the tuple column and
+    position the position of the particle in the pair vector. The quantities
+    declared by the subproducers are passed to the call as {quantities},
+    together with {tuple}, {outputs}, {position} and {pair}. All subproducers
+    have to be a QuantityProducer.
+    """
+
+    def __init__(self, name, call, input, output, scopes, position, subproducers):
+        self.subproducers = subproducers
+        self.position = position
+        if not isinstance(output, list) or len(output) != 1:
+            log.error(
+                "UnpackProducer {} requires a single output quantity !".format(name)
+            )
+            raise Exception
+        if not isinstance(input, dict):
+            input = {scope: list(input) for scope in scopes}
+        for scope in scopes:
+            if len(input[scope]) != 1:
+                log.error(
+                    "UnpackProducer {} requires the pair as single input !".format(name)
+                )
+                raise Exception
+        for subproducer in self.subproducers:
+            if not isinstance(subproducer, QuantityProducer):
+                log.error(
+                    "UnpackProducer {}: subproducer {} does not declare a quantity !".format(
+                        name, subproducer.name
+                    )
+                )
+                raise Exception
+            if subproducer.output is None or len(subproducer.output) != 1:
+                log.error(
+                    "UnpackProducer {}: subproducer {} must have one output !".format(
+                        name, subproducer.name
+                    )
+                )
+                raise Exception
+        self.pair = {scope: input[scope][0] for scope in scopes}
+        # the tuple depends on the inputs of all subproducers, the unpacked
+        # quantities keep the dependencies of their subproducers, so that they
+        # are only shifted, if the quantity of the subproducer is shifted
+        inputs = {}
+        for scope in scopes:
+            inputs[scope] = list(input[scope])
+            for subproducer in self.subproducers:
+                for quantity in subproducer.get_inputs(scope):
+                    if quantity not in inputs[scope]:
+                        inputs[scope].append(quantity)
+        super().__init__(name, call, inputs, output, scopes)
+        self.output = self.output + [x.output[0] for x in self.subproducers]
+
+    def __str__(self) -> str:
+        return "UnpackProducer: {}".format(self.name)
+
+    def __repr__(self) -> str:
+        return "UnpackProducer: {}".format(self.name)
+
+    def parameters(self):
+        result = super().parameters() - {
+            "tuple",
+            "outputs",
+            "position",
+            "pair",
+            "quantities",
+        }
+        for subproducer in self.subproducers:
+            result.update(subproducer.parameters())
+            for argument in subproducer.quantity_arguments:
+                result.update(format_fields(argument))
+        return result - {"input"}
+
+    def writequantity(self, subproducer, config, scope, shift):
+        format_dict = {}
+        for para, value in config[shift][scope].items():
+            if isinstance(value, bool):
+                value = "true" if value else "false"
+            format_dict[para] = value
+        format_dict["input"] = ", ".join(
+            '"{}"'.format(x.get_leaf(shift, scope))
+            for x in subproducer.get_inputs(scope)
+            if x != self.pair[scope]
+        )
+        try:
+            arguments = [
+                argument.format(**format_dict)
+                for argument in subproducer.quantity_arguments
+            ]
+        except KeyError as e:
+            log.error(
+                "Error in {} Producer, key {} is not found in configuration".format(
+                    subproducer.name, e
+                )
+            )
+            raise Exception
+        return "quantities::particle::{}({})".format(
+            subproducer.quantity, ", ".join(arguments)
+        )
+
+    def writecall(self, config, scope, shift=""):
+        # in a shifted call, only the shifted quantities are unpacked, the
+        # others are taken from the nominal call
+        subproducers = [
+            x
+            for x in self.subproducers
+            if shift == "" or shift in x.output[0].get_shifts(scope)
+        ]
+        config[shift][scope]["tuple"] = '"{}"'.format(
+            self.output[0].get_leaf(shift, scope)
+        )
+        config[shift][scope]["outputs"] = (
+            '{"'
+            + '","'.join([x.output[0].get_leaf(shift, scope) for x in subproducers])
+            + '"}'
+        )
+        config[shift][scope]["position"] = self.position
+        config[shift][scope]["pair"] = '"{}"'.format(
+            self.pair[scope].get_leaf(shift, scope)
+        )
+        config[shift][scope]["quantities"] = ", ".join(
+            self.writequantity(x, config, scope, shift) for x in subproducers
+        )
+        return super().writecall(config, scope, shift)
+
+
 class BaseFilter(Producer):
     def __init__(self, name, call, input, scopes):
         super().__init__(name, call, input, None, scopes)
@@ -311,13 +962,15 @@ class BaseFilter(Producer):
 
     def writecalls(self, config, scope):
         inputs = []
+        shifts = [""]
         for quantity in self.input[scope]:
             inputs.extend(quantity.get_leaves_of_scope(scope))
+            shifts.extend(quantity.get_shifts(scope))
         formatdict = {}
         formatdict["input"] = '"' + '", "'.join(inputs) + '"'
         formatdict["input_vec"] = '{"' + '","'.join(inputs) + '"}'
         formatdict["df"] = "{df}"
-        return [
+        return unroll_calls(self.input[scope], scope, shifts) + [
             self.call.format(**formatdict)
         ]  # use format (not format_map here) such that missing config entries cause an error
 
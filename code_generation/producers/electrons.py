@@ -1,56 +1,73 @@
 import code_generation.quantities.output as q
 import code_generation.quantities.nanoAOD as nanoAOD
-from code_generation.producer import Producer, ProducerGroup
+from code_generation.producer import (
+    CutProducer,
+    ObjectSelector,
+    Producer,
+    ProducerGroup,
+)
 
 ####################
 # Set of producers used for loosest selection of electrons
 ####################
 
-ElectronPtCut = Producer(
+ElectronPtCut = CutProducer(
     name="ElectronPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_ele_pt})",
     input=[nanoAOD.Electron_pt],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_ele_pt}"],
 )
-ElectronEtaCut = Producer(
+ElectronEtaCut = CutProducer(
     name="ElectronEtaCut",
     call="physicsobject::CutEta({df}, {input}, {output}, {max_ele_eta})",
     input=[nanoAOD.Electron_eta],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_ele_eta}"],
 )
-ElectronDxyCut = Producer(
+ElectronDxyCut = CutProducer(
     name="ElectronDzCut",
     call="physicsobject::CutDz({df}, {input}, {output}, {max_ele_dxy})",
     input=[nanoAOD.Electron_dxy],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_ele_dxy}"],
 )
-ElectronDzCut = Producer(
+ElectronDzCut = CutProducer(
     name="ElectronDzCut",
     call="physicsobject::CutDz({df}, {input}, {output}, {max_ele_dz})",
     input=[nanoAOD.Electron_dz],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_ele_dz}"],
 )
-ElectronIDCut = Producer(
+ElectronIDCut = CutProducer(
     name="ElectronIDCut",
     call='physicsobject::electron::CutID({df}, {output}, "{ele_id}")',
     input=[],
     output=[],
     scopes=["global"],
+    cut="Flag",
+    cut_arguments=['"{ele_id}"'],
 )
-ElectronIsoCut = Producer(
+ElectronIsoCut = CutProducer(
     name="ElectronIsoCut",
     call="physicsobject::electron::CutIsolation({df}, {output}, {input}, {max_ele_iso})",
     input=[nanoAOD.Electron_iso],
     output=[],
     scopes=["global"],
+    cut="Max",
+    cut_arguments=["{input}", "{max_ele_iso}"],
 )
-BaseElectrons = ProducerGroup(
+BaseElectrons = ObjectSelector(
     name="BaseElectrons",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
+    call="physicsobject::SelectObjectMask({df}, {output}, {cuts})",
     input=[],
     output=[q.base_electrons_mask],
     scopes=["global"],
@@ -92,37 +109,42 @@ ExtraElectronsVeto = Producer(
 # Set of producers used for di-electron veto
 ####################
 
-DiElectronVetoPtCut = Producer(
+DiElectronVetoPtCut = CutProducer(
     name="DiElectronVetoPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_dielectronveto_pt})",
     input=[nanoAOD.Electron_pt],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_dielectronveto_pt}"],
 )
-DiElectronVetoIDCut = Producer(
+DiElectronVetoIDCut = CutProducer(
     name="DiElectronVetoIDCut",
     call='physicsobject::electron::CutCBID({df}, {output}, "{dielectronveto_id}", {dielectronveto_id_wp})',
     input=[],
     output=[],
     scopes=["global"],
+    cut="MinInt",
+    cut_arguments=['"{dielectronveto_id}"', "{dielectronveto_id_wp}"],
 )
-DiElectronVetoElectrons = ProducerGroup(
+DiElectronVetoElectrons = ObjectSelector(
     name="DiElectronVetoElectrons",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
-    input=ElectronEtaCut.output
-    + ElectronDxyCut.output
-    + ElectronDzCut.output
-    + ElectronIsoCut.output,
+    call="physicsobject::packed::SelectObjectMask({df}, {output}, {cuts})",
+    input=[],
     output=[],
     scopes=["global"],
     subproducers=[
         DiElectronVetoPtCut,
         DiElectronVetoIDCut,
+        ElectronEtaCut,
+        ElectronDxyCut,
+        ElectronDzCut,
+        ElectronIsoCut,
     ],
 )
 DiElectronVeto = ProducerGroup(
     name="DiElectronVeto",
-    call="physicsobject::CheckForDiLeptonPairs({df}, {output}, {input}, {dileptonveto_dR})",
+    call="physicsobject::packed::CheckForDiLeptonPairs({df}, {output}, {input}, {dileptonveto_dR})",
     input=[
         nanoAOD.Electron_pt,
         nanoAOD.Electron_eta,
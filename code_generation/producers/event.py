@@ -47,7 +47,7 @@ PUweights = Producer(
 
 ZPtMassReweighting = Producer(
     name="ZPtMassReweighting",
-    call='reweighting::zPtMassReweighting({df}, {output}, {input}, "{zptmass_file}", "{zptmass_functor}", "{zptmass_arguments}")',
+    call='reweighting::zPtMassReweighting({df}, {output}, {input}, "{zptmass_file}", "{zptmass_functor}", "{zptmass_arguments}", {zptmass_tabulation_tolerance})',
     input=[
         q.recoil_genboson_p4,
     ],
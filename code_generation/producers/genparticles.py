@@ -1,6 +1,11 @@
 import code_generation.quantities.output as q
 import code_generation.quantities.nanoAOD as nanoAOD
-from code_generation.producer import Producer, ProducerGroup
+from code_generation.producer import (
+    Producer,
+    ProducerGroup,
+    QuantityProducer,
+    UnpackProducer,
+)
 
 
 ####################
@@ -43,75 +48,95 @@ LVGenParticle2 = Producer(
     output=[q.gen_p4_2],
     scopes=["mt", "et", "tt", "em"],
 )
-gen_pt_1 = Producer(
+gen_pt_1 = QuantityProducer(
     name="gen_pt_1",
     call="quantities::pt({df}, {output}, {input})",
     input=[q.gen_p4_1],
     output=[q.gen_pt_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Pt",
+    quantity_arguments=["{input}"],
 )
-gen_pt_2 = Producer(
+gen_pt_2 = QuantityProducer(
     name="gen_pt_2",
     call="quantities::pt({df}, {output}, {input})",
     input=[q.gen_p4_2],
     output=[q.gen_pt_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Pt",
+    quantity_arguments=["{input}"],
 )
-gen_eta_1 = Producer(
+gen_eta_1 = QuantityProducer(
     name="gen_eta_1",
     call="quantities::eta({df}, {output}, {input})",
     input=[q.gen_p4_1],
     output=[q.gen_eta_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Eta",
+    quantity_arguments=["{input}"],
 )
-gen_eta_2 = Producer(
+gen_eta_2 = QuantityProducer(
     name="gen_eta_2",
     call="quantities::eta({df}, {output}, {input})",
     input=[q.gen_p4_2],
     output=[q.gen_eta_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Eta",
+    quantity_arguments=["{input}"],
 )
-gen_phi_1 = Producer(
+gen_phi_1 = QuantityProducer(
     name="gen_phi_1",
     call="quantities::phi({df}, {output}, {input})",
     input=[q.gen_p4_1],
     output=[q.gen_phi_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Phi",
+    quantity_arguments=["{input}"],
 )
-gen_phi_2 = Producer(
+gen_phi_2 = QuantityProducer(
     name="gen_phi_2",
     call="quantities::phi({df}, {output}, {input})",
     input=[q.gen_p4_2],
     output=[q.gen_phi_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Phi",
+    quantity_arguments=["{input}"],
 )
-gen_mass_1 = Producer(
+gen_mass_1 = QuantityProducer(
     name="gen_mass_1",
     call="quantities::mass({df}, {output}, {input})",
     input=[q.gen_p4_1],
     output=[q.gen_mass_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Mass",
+    quantity_arguments=["{input}"],
 )
-gen_mass_2 = Producer(
+gen_mass_2 = QuantityProducer(
     name="gen_mass_2",
     call="quantities::mass({df}, {output}, {input})",
     input=[q.gen_p4_2],
     output=[q.gen_mass_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Mass",
+    quantity_arguments=["{input}"],
 )
-gen_pdgid_1 = Producer(
+gen_pdgid_1 = QuantityProducer(
     name="gen_pdgid_1",
     call="quantities::pdgid({df}, {output}, 0, {input})",
     input=[q.gen_ditaupair, nanoAOD.GenParticle_pdgId],
     output=[q.gen_pdgid_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Element<int>",
+    quantity_arguments=["{input}", "default_pdgid"],
 )
-gen_pdgid_2 = Producer(
+gen_pdgid_2 = QuantityProducer(
     name="gen_pdgid_2",
     call="quantities::pdgid({df}, {output}, 1, {input})",
     input=[q.gen_ditaupair, nanoAOD.GenParticle_pdgId],
     output=[q.gen_pdgid_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Element<int>",
+    quantity_arguments=["{input}", "default_pdgid"],
 )
 gen_m_vis = Producer(
     name="gen_m_vis",
@@ -121,20 +146,22 @@ gen_m_vis = Producer(
     scopes=["mt", "et", "tt", "em"],
 )
 
-UnrollGenLV1 = ProducerGroup(
+UnrollGenLV1 = UnpackProducer(
     name="UnrollGenLV1",
-    call=None,
-    input=None,
-    output=None,
+    call="quantities::Unpack({df}, {tuple}, {outputs}, {position}, {pair}, {quantities})",
+    input=[q.gen_ditaupair],
+    output=[q.gen_quantities_1],
     scopes=["mt", "et", "tt", "em"],
+    position=0,
     subproducers=[gen_pt_1, gen_eta_1, gen_phi_1, gen_mass_1, gen_pdgid_1],
 )
-UnrollGenLV2 = ProducerGroup(
+UnrollGenLV2 = UnpackProducer(
     name="UnrollGenLV2",
-    call=None,
-    input=None,
-    output=None,
+    call="quantities::Unpack({df}, {tuple}, {outputs}, {position}, {pair}, {quantities})",
+    input=[q.gen_ditaupair],
+    output=[q.gen_quantities_2],
     scopes=["mt", "et", "tt", "em"],
+    position=1,
     subproducers=[gen_pt_2, gen_eta_2, gen_phi_2, gen_mass_2, gen_pdgid_2],
 )
 
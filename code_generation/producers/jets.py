@@ -1,13 +1,19 @@
 import code_generation.quantities.output as q
 import code_generation.quantities.nanoAOD as nanoAOD
-from code_generation.producer import Producer, ProducerGroup
+from code_generation.producer import (
+    CutProducer,
+    FusedProducer,
+    ObjectSelector,
+    Producer,
+    ProducerGroup,
+)
 
 ####################
 # Set of producers used for selection possible good jets
 ####################
 JetPtCorrection = Producer(
     name="JetPtCorrection",
-    call="physicsobject::jet::JetPtCorrection({df}, {output}, {input}, {JEC_shift_sources}, {JE_scale_shift}, {JE_reso_shift})",
+    call='physicsobject::jet::JetPtCorrection({df}, {output}, {input}, "{JEC_uncertainty_file}", {JEC_shift_sources}, {JE_scale_shift}, "{JER_resolution_file}", "{JER_scalefactor_file}", {JE_reso_shift})',
     input=[
         nanoAOD.Jet_pt,
         nanoAOD.Jet_eta,
@@ -39,63 +45,102 @@ JetEnergyCorrection = ProducerGroup(
     scopes=["global"],
     subproducers=[JetPtCorrection, JetMassCorrection],
 )
-JetPtCut = Producer(
+# computes the corrected jet pts of the nominal configuration and of all jet
+# energy shifts in a single step, use JetEnergyCorrectionFused instead of
+# JetEnergyCorrection in the configuration to enable it
+JetPtCorrectionFused = FusedProducer(
+    name="JetPtCorrectionFused",
+    call='physicsobject::jet::JetPtCorrectionVariations({df}, {output}, {input}, "{JEC_uncertainty_file}", {JEC_shift_sources}, {JE_scale_shift}, "{JER_resolution_file}", "{JER_scalefactor_file}", {JE_reso_shift})',
+    input=[
+        nanoAOD.Jet_pt,
+        nanoAOD.Jet_eta,
+        nanoAOD.Jet_phi,
+        nanoAOD.GenJet_pt,
+        nanoAOD.GenJet_eta,
+        nanoAOD.GenJet_phi,
+        nanoAOD.rho,
+    ],
+    output=[q.Jet_pt_corrected],
+    scopes=["global"],
+    variation_parameters=["JEC_shift_sources", "JE_scale_shift", "JE_reso_shift"],
+)
+JetEnergyCorrectionFused = ProducerGroup(
+    name="JetEnergyCorrectionFused",
+    call=None,
+    input=None,
+    output=None,
+    scopes=["global"],
+    subproducers=[JetPtCorrectionFused, JetMassCorrection],
+)
+JetPtCut = CutProducer(
     name="JetPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_jet_pt})",
     input=[q.Jet_pt_corrected],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_jet_pt}"],
 )
-BJetPtCut = Producer(
+BJetPtCut = CutProducer(
     name="BJetPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_bjet_pt})",
     input=[q.Jet_pt_corrected],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_bjet_pt}"],
 )
-JetEtaCut = Producer(
+JetEtaCut = CutProducer(
     name="JetEtaCut",
     call="physicsobject::CutEta({df}, {input}, {output}, {max_jet_eta})",
     input=[nanoAOD.Jet_eta],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_jet_eta}"],
 )
-BJetEtaCut = Producer(
+BJetEtaCut = CutProducer(
     name="BJetEtaCut",
     call="physicsobject::CutEta({df}, {input}, {output}, {max_bjet_eta})",
     input=[nanoAOD.Jet_eta],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_bjet_eta}"],
 )
-JetIDCut = Producer(
+JetIDCut = CutProducer(
     name="JetIDCut",
     call="physicsobject::jet::CutID({df}, {output}, {input}, {jet_id})",
     input=[nanoAOD.Jet_ID],
-    output=[q.jet_id_mask],
+    output=[],
     scopes=["global"],
+    cut="JetID",
+    cut_arguments=["{input}", "{jet_id}"],
 )
-BTagCut = Producer(
+BTagCut = CutProducer(
     name="BTagCut",
     call="physicsobject::jet::CutRawID({df}, {input}, {output}, {btag_cut})",
     input=[nanoAOD.BJet_discriminator],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{btag_cut}"],
 )
-GoodJets = ProducerGroup(
+GoodJets = ObjectSelector(
     name="GoodJets",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
+    call="physicsobject::SelectObjectMask({df}, {output}, {cuts})",
     input=[],
     output=[q.good_jets_mask],
     scopes=["global"],
     subproducers=[JetPtCut, JetEtaCut, JetIDCut],
 )
-GoodBJets = ProducerGroup(
+GoodBJets = ObjectSelector(
     name="GoodBJets",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
-    input=[q.jet_id_mask],
+    call="physicsobject::SelectObjectMask({df}, {output}, {cuts})",
+    input=[],
     output=[q.good_bjets_mask],
     scopes=["global"],
-    subproducers=[BJetPtCut, BJetEtaCut, BTagCut],
+    subproducers=[BJetPtCut, BJetEtaCut, BTagCut, JetIDCut],
 )
 
 ####################
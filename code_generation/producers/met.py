@@ -125,6 +125,13 @@ MetPhi = Producer(
     output=[q.metphi],
     scopes=["et", "mt", "tt", "em"],
 )
+MetCartesian = Producer(
+    name="MetCartesian",
+    call="lorentzvectors::buildMetCartesian({df}, {input}, {output_vec})",
+    input=[q.met_p4_recoilcorrected],
+    output=[q.met_px_recoilcorrected, q.met_py_recoilcorrected],
+    scopes=["et", "mt", "tt", "em"],
+)
 MetCorrections = ProducerGroup(
     name="MetCorrections",
     call=None,
@@ -1,56 +1,73 @@
 import code_generation.quantities.output as q
 import code_generation.quantities.nanoAOD as nanoAOD
-from code_generation.producer import Producer, ProducerGroup
+from code_generation.producer import (
+    CutProducer,
+    ObjectSelector,
+    Producer,
+    ProducerGroup,
+)
 
 ####################
 # Set of producers used for loosest selection of muons
 ####################
 
-MuonPtCut = Producer(
+MuonPtCut = CutProducer(
     name="MuonPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_muon_pt})",
     input=[nanoAOD.Muon_pt],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_muon_pt}"],
 )
-MuonEtaCut = Producer(
+MuonEtaCut = CutProducer(
     name="MuonEtaCut",
     call="physicsobject::CutEta({df}, {input}, {output}, {max_muon_eta})",
     input=[nanoAOD.Muon_eta],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_muon_eta}"],
 )
-MuonDxyCut = Producer(
+MuonDxyCut = CutProducer(
     name="MuonDzCut",
     call="physicsobject::CutDz({df}, {input}, {output}, {max_muon_dxy})",
     input=[nanoAOD.Muon_dxy],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_muon_dxy}"],
 )
-MuonDzCut = Producer(
+MuonDzCut = CutProducer(
     name="MuonDzCut",
     call="physicsobject::CutDz({df}, {input}, {output}, {max_muon_dz})",
     input=[nanoAOD.Muon_dz],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_muon_dz}"],
 )
-MuonIDCut = Producer(
+MuonIDCut = CutProducer(
     name="MuonIDCut",
     call='physicsobject::muon::CutID({df}, {output}, "{muon_id}")',
     input=[],
     output=[],
     scopes=["global"],
+    cut="Flag",
+    cut_arguments=['"{muon_id}"'],
 )
-MuonIsoCut = Producer(
+MuonIsoCut = CutProducer(
     name="MuonIsoCut",
     call="physicsobject::muon::CutIsolation({df}, {output}, {input}, {muon_iso_cut})",
     input=[nanoAOD.Muon_iso],
     output=[],
     scopes=["global"],
+    cut="Max",
+    cut_arguments=["{input}", "{muon_iso_cut}"],
 )
-BaseMuons = ProducerGroup(
+BaseMuons = ObjectSelector(
     name="BaseMuons",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
+    call="physicsobject::SelectObjectMask({df}, {output}, {cuts})",
     input=[],
     output=[q.base_muons_mask],
     scopes=["global"],
@@ -68,30 +85,36 @@ BaseMuons = ProducerGroup(
 # Set of producers used for more specific selection of muons in channels
 ####################
 
-GoodMuonPtCut = Producer(
+GoodMuonPtCut = CutProducer(
     name="GoodMuonPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_muon_pt})",
     input=[nanoAOD.Muon_pt],
     output=[],
     scopes=["em", "mt"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_muon_pt}"],
 )
-GoodMuonEtaCut = Producer(
+GoodMuonEtaCut = CutProducer(
     name="GoodMuonEtaCut",
     call="physicsobject::CutEta({df}, {input}, {output}, {max_muon_eta})",
     input=[nanoAOD.Muon_eta],
     output=[],
     scopes=["em", "mt"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_muon_eta}"],
 )
-GoodMuonIsoCut = Producer(
+GoodMuonIsoCut = CutProducer(
     name="GoodMuonIsoCut",
     call="physicsobject::electron::CutIsolation({df}, {output}, {input}, {muon_iso_cut})",
     input=[nanoAOD.Muon_iso],
     output=[],
     scopes=["em", "mt"],
+    cut="Max",
+    cut_arguments=["{input}", "{muon_iso_cut}"],
 )
-GoodMuons = ProducerGroup(
+GoodMuons = ObjectSelector(
     name="GoodMuons",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
+    call="physicsobject::SelectObjectMask({df}, {output}, {cuts})",
     input=[q.base_muons_mask],
     output=[q.good_muons_mask],
     scopes=["em", "mt"],
@@ -125,34 +148,42 @@ ExtraMuonsVeto = Producer(
 # Set of producers used for di-muon veto
 ####################
 
-DiMuonVetoPtCut = Producer(
+DiMuonVetoPtCut = CutProducer(
     name="DiMuonVetoPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_dimuonveto_pt})",
     input=[nanoAOD.Muon_pt],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_dimuonveto_pt}"],
 )
-DiMuonVetoIDCut = Producer(
+DiMuonVetoIDCut = CutProducer(
     name="DiMuonVetoIDCut",
     call='physicsobject::muon::CutID({df}, {output}, "{dimuonveto_id}")',
     input=[],
     output=[],
     scopes=["global"],
+    cut="Flag",
+    cut_arguments=['"{dimuonveto_id}"'],
 )
-DiMuonVetoMuons = ProducerGroup(
+DiMuonVetoMuons = ObjectSelector(
     name="DiMuonVetoMuons",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
-    input=MuonEtaCut.output + MuonDxyCut.output + MuonDzCut.output + MuonIsoCut.output,
+    call="physicsobject::packed::SelectObjectMask({df}, {output}, {cuts})",
+    input=[],
     output=[],
     scopes=["global"],
     subproducers=[
         DiMuonVetoPtCut,
         DiMuonVetoIDCut,
+        MuonEtaCut,
+        MuonDxyCut,
+        MuonDzCut,
+        MuonIsoCut,
     ],
 )
 DiMuonVeto = ProducerGroup(
     name="DiMuonVeto",
-    call="physicsobject::CheckForDiLeptonPairs({df}, {output}, {input}, {dileptonveto_dR})",
+    call="physicsobject::packed::CheckForDiLeptonPairs({df}, {output}, {input}, {dileptonveto_dR})",
     input=[
         nanoAOD.Muon_pt,
         nanoAOD.Muon_eta,
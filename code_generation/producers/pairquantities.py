@@ -1,66 +1,87 @@
 import code_generation.quantities.output as q
 import code_generation.quantities.nanoAOD as nanoAOD
-from code_generation.producer import Producer, ProducerGroup
+from code_generation.producer import (
+    Producer,
+    ProducerGroup,
+    QuantityProducer,
+    UnpackProducer,
+)
 
 ####################
 # Set of general producers for DiTauPair Quantities
 ####################
 
-pt_1 = Producer(
+pt_1 = QuantityProducer(
     name="pt_1",
     call="quantities::pt({df}, {output}, {input})",
     input=[q.p4_1],
     output=[q.pt_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Pt",
+    quantity_arguments=["{input}"],
 )
-pt_2 = Producer(
+pt_2 = QuantityProducer(
     name="pt_2",
     call="quantities::pt({df}, {output}, {input})",
     input=[q.p4_2],
     output=[q.pt_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Pt",
+    quantity_arguments=["{input}"],
 )
-eta_1 = Producer(
+eta_1 = QuantityProducer(
     name="eta_1",
     call="quantities::eta({df}, {output}, {input})",
     input=[q.p4_1],
     output=[q.eta_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Eta",
+    quantity_arguments=["{input}"],
 )
-eta_2 = Producer(
+eta_2 = QuantityProducer(
     name="eta_2",
     call="quantities::eta({df}, {output}, {input})",
     input=[q.p4_2],
     output=[q.eta_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Eta",
+    quantity_arguments=["{input}"],
 )
-phi_1 = Producer(
+phi_1 = QuantityProducer(
     name="phi_1",
     call="quantities::phi({df}, {output}, {input})",
     input=[q.p4_1],
     output=[q.phi_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Phi",
+    quantity_arguments=["{input}"],
 )
-phi_2 = Producer(
+phi_2 = QuantityProducer(
     name="phi_2",
     call="quantities::phi({df}, {output}, {input})",
     input=[q.p4_2],
     output=[q.phi_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Phi",
+    quantity_arguments=["{input}"],
 )
-mass_1 = Producer(
+mass_1 = QuantityProducer(
     name="mass_1",
     call="quantities::mass({df}, {output}, {input})",
     input=[q.p4_1],
     output=[q.mass_1],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Mass",
+    quantity_arguments=["{input}"],
 )
-mass_2 = Producer(
+mass_2 = QuantityProducer(
     name="mass_2",
     call="quantities::mass({df}, {output}, {input})",
     input=[q.p4_2],
     output=[q.mass_2],
     scopes=["mt", "et", "tt", "em"],
+    quantity="Mass",
+    quantity_arguments=["{input}"],
 )
 m_vis = Producer(
     name="m_vis",
@@ -79,75 +100,95 @@ pt_vis = Producer(
 ####################
 # Set of channel specific producers
 ####################
-dxy_1 = Producer(
+dxy_1 = QuantityProducer(
     name="dxy_1",
     call="quantities::dxy({df}, {output}, 0, {input})",
     input=[q.ditaupair, nanoAOD.Muon_dxy],
     output=[q.dxy_1],
     scopes=["mt"],
+    quantity="Element<float>",
+    quantity_arguments=["{input}", "default_float"],
 )
-dxy_2 = Producer(
+dxy_2 = QuantityProducer(
     name="dxy_2",
     call="quantities::dxy({df}, {output}, 1, {input})",
     input=[q.ditaupair, nanoAOD.Tau_dxy],
     output=[q.dxy_2],
     scopes=["mt", "et", "tt"],
+    quantity="Element<float>",
+    quantity_arguments=["{input}", "default_float"],
 )
-dz_1 = Producer(
+dz_1 = QuantityProducer(
     name="dz_1",
     call="quantities::dz({df}, {output}, 0, {input})",
     input=[q.ditaupair, nanoAOD.Muon_dz],
     output=[q.dz_1],
     scopes=["mt"],
+    quantity="Element<float>",
+    quantity_arguments=["{input}", "default_float"],
 )
-dz_2 = Producer(
+dz_2 = QuantityProducer(
     name="dz_2",
     call="quantities::dz({df}, {output}, 1, {input})",
     input=[q.ditaupair, nanoAOD.Tau_dz],
     output=[q.dz_2],
     scopes=["mt", "et", "tt"],
+    quantity="Element<float>",
+    quantity_arguments=["{input}", "default_float"],
 )
-q_1 = Producer(
+q_1 = QuantityProducer(
     name="q_1",
     call="quantities::charge({df}, {output}, 0, {input})",
     input=[q.ditaupair, nanoAOD.Muon_charge],
     output=[q.q_1],
     scopes=["mt"],
+    quantity="Element<int>",
+    quantity_arguments=["{input}", "default_int"],
 )
-q_2 = Producer(
+q_2 = QuantityProducer(
     name="q_2",
     call="quantities::charge({df}, {output}, 1, {input})",
     input=[q.ditaupair, nanoAOD.Tau_charge],
     output=[q.q_2],
     scopes=["mt", "et", "tt"],
+    quantity="Element<int>",
+    quantity_arguments=["{input}", "default_int"],
 )
-iso_1 = Producer(
+iso_1 = QuantityProducer(
     name="iso_1",
     call="quantities::isolation({df}, {output}, 0, {input})",
     input=[q.ditaupair, nanoAOD.Muon_iso],
     output=[q.iso_1],
     scopes=["mt"],
+    quantity="Element<float>",
+    quantity_arguments=["{input}", "default_float"],
 )
-iso_2 = Producer(
+iso_2 = QuantityProducer(
     name="iso_2",
     call="quantities::isolation({df}, {output}, 1, {input})",
     input=[q.ditaupair, nanoAOD.Tau_IDraw],
     output=[q.iso_2],
     scopes=["mt", "et", "tt"],
+    quantity="Element<float>",
+    quantity_arguments=["{input}", "default_float"],
 )
-decaymode_2 = Producer(
+decaymode_2 = QuantityProducer(
     name="decaymode_2",
     call="quantities::tau::decaymode({df}, {output}, 1, {input})",
     input=[q.ditaupair, nanoAOD.Tau_decayMode],
     output=[q.decaymode_2],
     scopes=["mt", "et", "tt"],
+    quantity="Element<int>",
+    quantity_arguments=["{input}", "default_int"],
 )
-gen_match_2 = Producer(
+gen_match_2 = QuantityProducer(
     name="gen_match_2",
     call="quantities::tau::genmatch({df}, {output}, 1, {input})",
     input=[q.ditaupair, nanoAOD.Tau_genMatch],
     output=[q.gen_match_2],
     scopes=["mt", "et", "tt"],
+    quantity="Element<UChar_t>",
+    quantity_arguments=["{input}", "default_uchar"],
 )
 taujet_pt_2 = Producer(
     name="taujet_pt_2",
@@ -168,20 +209,22 @@ gen_taujet_pt_2 = Producer(
     output=[q.gen_taujet_pt_2],
     scopes=["mt", "et", "tt"],
 )
-UnrollLV1 = ProducerGroup(
+UnrollLV1 = UnpackProducer(
     name="UnrollLV1",
-    call=None,
-    input=None,
-    output=None,
+    call="quantities::Unpack({df}, {tuple}, {outputs}, {position}, {pair}, {quantities})",
+    input=[q.ditaupair],
+    output=[q.quantities_1],
     scopes=["mt"],
+    position=0,
     subproducers=[pt_1, eta_1, phi_1, mass_1, dxy_1, dz_1, q_1, iso_1],
 )
-UnrollLV2 = ProducerGroup(
-    name="UnrollLV2",
-    call=None,
-    input=None,
-    output=None,
+UnpackLV2 = UnpackProducer(
+    name="UnpackLV2",
+    call="quantities::Unpack({df}, {tuple}, {outputs}, {position}, {pair}, {quantities})",
+    input=[q.ditaupair],
+    output=[q.quantities_2],
     scopes=["mt"],
+    position=1,
     subproducers=[
         pt_2,
         eta_2,
@@ -193,10 +236,16 @@ UnrollLV2 = ProducerGroup(
         iso_2,
         decaymode_2,
         gen_match_2,
-        taujet_pt_2,
-        gen_taujet_pt_2,
     ],
 )
+UnrollLV2 = ProducerGroup(
+    name="UnrollLV2",
+    call=None,
+    input=None,
+    output=None,
+    scopes=["mt"],
+    subproducers=[UnpackLV2, taujet_pt_2, gen_taujet_pt_2],
+)
 DiTauPairQuantities = ProducerGroup(
     name="DiTauPairQuantities",
     call=None,
@@ -269,3 +318,76 @@ DiTauPairMETQuantities = ProducerGroup(
     scopes=["mt", "et", "tt", "em"],
     subproducers=[Pzetamissvis, mTdileptonMET, mt_1, mt_2, pt_tt, pt_ttjj, mt_tot],
 )
+
+## cartesian versions of the combined quantities, which require the producers
+## LVMu1Cartesian, LVTau2Cartesian and MetCartesian instead of the lorentz
+## vector objects
+p1_cartesian = [q.p4_1_px, q.p4_1_py, q.p4_1_pz, q.p4_1_e]
+p2_cartesian = [q.p4_2_px, q.p4_2_py, q.p4_2_pz, q.p4_2_e]
+met_cartesian = [q.met_px_recoilcorrected, q.met_py_recoilcorrected]
+m_vis_cartesian = Producer(
+    name="m_vis_cartesian",
+    call="quantities::cartesian::m_vis({df}, {output}, {input_vec})",
+    input=p1_cartesian + p2_cartesian,
+    output=[q.m_vis],
+    scopes=["mt", "et", "tt", "em"],
+)
+pt_vis_cartesian = Producer(
+    name="pt_vis_cartesian",
+    call="quantities::cartesian::pt_vis({df}, {output}, {input_vec})",
+    input=p1_cartesian + p2_cartesian,
+    output=[q.pt_vis],
+    scopes=["mt", "et", "tt", "em"],
+)
+DiTauPairQuantitiesCartesian = ProducerGroup(
+    name="DiTauPairQuantitiesCartesian",
+    call=None,
+    input=None,
+    output=None,
+    scopes=["mt", "et", "tt", "em"],
+    subproducers=[UnrollLV1, UnrollLV2, m_vis_cartesian, pt_vis_cartesian],
+)
+Pzetamissvis_cartesian = Producer(
+    name="Pzetamissvis_cartesian",
+    call="quantities::cartesian::pzetamissvis({df}, {output}, {input_vec})",
+    input=p1_cartesian + p2_cartesian + met_cartesian,
+    output=[q.pzetamissvis],
+    scopes=["mt", "et", "tt", "em"],
+)
+mt_1_cartesian = Producer(
+    name="mt_1_cartesian",
+    call="quantities::cartesian::mT({df}, {output}, {input_vec})",
+    input=p1_cartesian + met_cartesian,
+    output=[q.mt_1],
+    scopes=["mt", "et", "tt", "em"],
+)
+mt_2_cartesian = Producer(
+    name="mt_2_cartesian",
+    call="quantities::cartesian::mT({df}, {output}, {input_vec})",
+    input=p2_cartesian + met_cartesian,
+    output=[q.mt_2],
+    scopes=["mt", "et", "tt", "em"],
+)
+pt_tt_cartesian = Producer(
+    name="pt_tt_cartesian",
+    call="quantities::cartesian::pt_tt({df}, {output}, {input_vec})",
+    input=p1_cartesian + p2_cartesian + met_cartesian,
+    output=[q.pt_tt],
+    scopes=["mt", "et", "tt", "em"],
+)
+DiTauPairMETQuantitiesCartesian = ProducerGroup(
+    name="DiTauPairMETQuantitiesCartesian",
+    call=None,
+    input=None,
+    output=None,
+    scopes=["mt", "et", "tt", "em"],
+    subproducers=[
+        Pzetamissvis_cartesian,
+        mTdileptonMET,
+        mt_1_cartesian,
+        mt_2_cartesian,
+        pt_tt_cartesian,
+        pt_ttjj,
+        mt_tot,
+    ],
+)
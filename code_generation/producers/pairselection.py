@@ -90,6 +90,34 @@ LVTau2 = Producer(
     output=[q.p4_2],
     scopes=["mt"],
 )
+## cartesian components of the particles, used for the quantities in
+## quantities::cartesian
+LVMu1Cartesian = Producer(
+    name="LVMu1Cartesian",
+    call="lorentzvectors::buildCartesian({df}, {input_vec}, 0, {output})",
+    input=[
+        q.ditaupair,
+        nanoAOD.Muon_pt,
+        nanoAOD.Muon_eta,
+        nanoAOD.Muon_phi,
+        nanoAOD.Muon_mass,
+    ],
+    output=[q.p4_1_cartesian, q.p4_1_px, q.p4_1_py, q.p4_1_pz, q.p4_1_e],
+    scopes=["mt"],
+)
+LVTau2Cartesian = Producer(
+    name="LVTau2Cartesian",
+    call="lorentzvectors::buildCartesian({df}, {input_vec}, 1, {output})",
+    input=[
+        q.ditaupair,
+        q.Tau_pt_corrected,
+        nanoAOD.Tau_eta,
+        nanoAOD.Tau_phi,
+        q.Tau_mass_corrected,
+    ],
+    output=[q.p4_2_cartesian, q.p4_2_px, q.p4_2_py, q.p4_2_pz, q.p4_2_e],
+    scopes=["mt"],
+)
 ## uncorrected versions of all particles, used for MET propagation
 LVMu1Uncorrected = Producer(
     name="LVMu1Uncorrected",
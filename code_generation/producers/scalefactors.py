@@ -8,14 +8,14 @@ from code_generation.producer import Producer, ProducerGroup
 
 MuonID_SF = Producer(
     name="MuonID_SF",
-    call='scalefactor::muon::id({df}, {input}, {output}, "{muon_sf_workspace}", "{muon_sf_id_name}", "{muon_sf_id_args}")',
+    call='scalefactor::muon::id({df}, {input}, {output}, "{muon_sf_workspace}", "{muon_sf_id_name}", "{muon_sf_id_args}", {muon_sf_tabulation_tolerance})',
     input=[q.pt_1, q.eta_1],
     output=[q.idWeight_1],
     scopes=["mt"],
 )
 MuonIso_SF = Producer(
     name="MuonIso_SF",
-    call='scalefactor::muon::iso({df}, {input}, {output}, "{muon_sf_workspace}", "{muon_sf_iso_name}", "{muon_sf_iso_args}")',
+    call='scalefactor::muon::iso({df}, {input}, {output}, "{muon_sf_workspace}", "{muon_sf_iso_name}", "{muon_sf_iso_args}", {muon_sf_tabulation_tolerance})',
     input=[q.pt_1, q.eta_1, q.iso_1],
     output=[q.isoWeight_1],
     scopes=["mt"],
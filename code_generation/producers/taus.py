@@ -1,6 +1,13 @@
 import code_generation.quantities.output as q
 import code_generation.quantities.nanoAOD as nanoAOD
-from code_generation.producer import Producer, ProducerGroup, VectorProducer
+from code_generation.producer import (
+    CutProducer,
+    FusedProducer,
+    ObjectSelector,
+    Producer,
+    ProducerGroup,
+    VectorCutProducer,
+)
 
 ####################
 # Set of producers used for selection of good taus
@@ -35,45 +42,82 @@ TauEnergyCorrection = ProducerGroup(
     scopes=["global"],
     subproducers=[TauPtCorrection, TauMassCorrection],
 )
-TauPtCut = Producer(
+# computes the corrected tau pts of the nominal configuration and of all tau
+# energy scale shifts in a single step, use TauEnergyCorrectionFused instead
+# of TauEnergyCorrection in the configuration to enable it
+TauPtCorrectionFused = FusedProducer(
+    name="TauPtCorrectionFused",
+    call="physicsobject::tau::PtCorrectionVariations({df}, {output}, {input}, {tau_ES_shift_DM0}, {tau_ES_shift_DM1}, {tau_ES_shift_DM10}, {tau_ES_shift_DM11})",
+    input=[
+        nanoAOD.Tau_pt,
+        nanoAOD.Tau_decayMode,
+    ],
+    output=[q.Tau_pt_corrected],
+    scopes=["global"],
+    variation_parameters=[
+        "tau_ES_shift_DM0",
+        "tau_ES_shift_DM1",
+        "tau_ES_shift_DM10",
+        "tau_ES_shift_DM11",
+    ],
+)
+TauEnergyCorrectionFused = ProducerGroup(
+    name="TauEnergyCorrectionFused",
+    call=None,
+    input=None,
+    output=None,
+    scopes=["global"],
+    subproducers=[TauPtCorrectionFused, TauMassCorrection],
+)
+TauPtCut = CutProducer(
     name="TauPtCut",
     call="physicsobject::CutPt({df}, {input}, {output}, {min_tau_pt})",
     input=[q.Tau_pt_corrected],
     output=[],
     scopes=["global"],
+    cut="Min",
+    cut_arguments=["{input}", "{min_tau_pt}"],
 )
-TauEtaCut = Producer(
+TauEtaCut = CutProducer(
     name="TauEtaCut",
     call="physicsobject::CutEta({df}, {input}, {output}, {max_tau_eta})",
     input=[nanoAOD.Tau_eta],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_tau_eta}"],
 )
-TauDzCut = Producer(
+TauDzCut = CutProducer(
     name="TauDzCut",
     call="physicsobject::CutDz({df}, {input}, {output}, {max_tau_dz})",
     input=[nanoAOD.Tau_dz],
     output=[],
     scopes=["global"],
+    cut="AbsMax",
+    cut_arguments=["{input}", "{max_tau_dz}"],
 )
-TauDMCut = Producer(
+TauDMCut = CutProducer(
     name="TauDMCut",
     call="physicsobject::tau::CutDecayModes({df}, {output}, {input}, {vec_open}{tau_dms}{vec_close})",
     input=[nanoAOD.Tau_decayMode],
     output=[],
     scopes=["global"],
+    cut="Values",
+    cut_arguments=["{input}", "{vec_open}{tau_dms}{vec_close}"],
 )
-TauIDCuts = VectorProducer(
+TauIDCuts = VectorCutProducer(
     name="TauIDCuts",
     call='physicsobject::tau::CutTauID({df}, {output}, "{tau_id}", {tau_id_idx})',
     input=[],
     output=[],
     scopes=["global"],
     vec_configs=["tau_id", "tau_id_idx"],
+    cut="TauID",
+    cut_arguments=['"{tau_id}"', "{tau_id_idx}"],
 )
-GoodTaus = ProducerGroup(
+GoodTaus = ObjectSelector(
     name="GoodTaus",
-    call="physicsobject::CombineMasks({df}, {output}, {input})",
+    call="physicsobject::SelectObjectMask({df}, {output}, {cuts})",
     input=[],
     output=[q.good_taus_mask],
     scopes=["global"],
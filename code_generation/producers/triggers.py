@@ -1,22 +1,36 @@
 import code_generation.quantities.output as q
 import code_generation.quantities.nanoAOD as nanoAOD
-from code_generation.producer import TriggerVectorProducer
+from code_generation.producer import (
+    PackedTriggerProducer,
+    Producer,
+    ProducerGroup,
+    TriggerVectorProducer,
+)
 
 ####################
 # Set of producers used for trigger flags
 ####################
 
-GenerateSingleMuonTriggerFlags = TriggerVectorProducer(
-    name="GenerateSingleMuonTriggerFlags",
-    call='trigger::GenerateSingleTriggerFlag({df}, {output}, {input}, "{hlt_path}", {ptcut}, {etacut}, {trigger_particle_id}, {filterbit}, {max_deltaR_triggermatch} )',
+TriggerObjectView = Producer(
+    name="TriggerObjectView",
+    call="trigger::TriggerObjects({df}, {output}, {input})",
     input=[
-        q.p4_1,
         nanoAOD.TriggerObject_bit,
         nanoAOD.TriggerObject_id,
         nanoAOD.TriggerObject_pt,
         nanoAOD.TriggerObject_eta,
         nanoAOD.TriggerObject_phi,
     ],
+    output=[q.triggerobject_view],
+    scopes=["global"],
+)
+GenerateSingleMuonTriggerFlags = TriggerVectorProducer(
+    name="GenerateSingleMuonTriggerFlags",
+    call='trigger::GenerateSingleTriggerFlag({df}, {output}, {input}, "{hlt_path}", {ptcut}, {etacut}, {trigger_particle_id}, {filterbit}, {max_deltaR_triggermatch} )',
+    input=[
+        q.p4_1,
+        q.triggerobject_view,
+    ],
     output="flagname",
     scope=["mt"],
     vec_config="singlemoun_trigger",
@@ -27,13 +41,44 @@ GenerateCrossTriggerFlags = TriggerVectorProducer(
     input=[
         q.p4_1,
         q.p4_2,
-        nanoAOD.TriggerObject_bit,
-        nanoAOD.TriggerObject_id,
-        nanoAOD.TriggerObject_pt,
-        nanoAOD.TriggerObject_eta,
-        nanoAOD.TriggerObject_phi,
+        q.triggerobject_view,
     ],
     output="flagname",
     scope=["mt"],
     vec_config="cross_trigger",
 )
+MTSingleTriggerFlags = PackedTriggerProducer(
+    name="MTSingleTriggerFlags",
+    call="trigger::GeneratePackedSingleTriggerFlags<{n_paths}>({df}, {output}, {input}, {hlt_paths}, {p1_ptcuts}, {p1_etacuts}, {p1_trigger_particle_ids}, {p1_filterbits}, {max_deltaR_triggermatch})",
+    unpack_call="trigger::UnpackTriggerFlag({df}, {output}, {input}, {index})",
+    input=[
+        q.p4_1,
+        q.triggerobject_view,
+    ],
+    output=[q.single_trigger_flags],
+    scope=["mt"],
+    vec_configs=["singlemoun_trigger"],
+)
+MTCrossTriggerFlags = PackedTriggerProducer(
+    name="MTCrossTriggerFlags",
+    call="trigger::GeneratePackedTriggerFlags<{n_paths}>({df}, {output}, {input}, {hlt_paths}, {p1_ptcuts}, {p2_ptcuts}, {p1_etacuts}, {p2_etacuts}, {p1_trigger_particle_ids}, {p2_trigger_particle_ids}, {p1_filterbits}, {p2_filterbits}, {max_deltaR_triggermatch})",
+    unpack_call="trigger::UnpackTriggerFlag({df}, {output}, {input}, {index})",
+    input=[
+        q.p4_1,
+        q.p4_2,
+        q.triggerobject_view,
+    ],
+    output=[q.cross_trigger_flags],
+    scope=["mt"],
+    vec_configs=["cross_trigger"],
+)
+# the single muon paths are packed separately, so that their flags do not
+# depend on the tau and are not recomputed for the tau energy scale shifts
+MTTriggerFlags = ProducerGroup(
+    name="MTTriggerFlags",
+    call=None,
+    input=None,
+    output=None,
+    scopes=["mt"],
+    subproducers=[MTSingleTriggerFlags, MTCrossTriggerFlags],
+)
@@ -12,7 +12,6 @@ base_electrons_mask = Quantity("base_electrons_mask")
 good_electrons_mask = Quantity("good_electrons_mask")
 veto_electrons_mask = Quantity("veto_electrons_mask")
 electron_veto_flag = Quantity("extraelec_veto")
-jet_id_mask = Quantity("jet_id_mask")
 jet_overlap_veto_mask = Quantity("jet_overlap_veto_mask")
 good_jets_mask = Quantity("good_jets_mask")
 good_bjets_mask = Quantity("good_bjets_mask")
@@ -32,6 +31,20 @@ eta_1 = Quantity("eta_1")
 phi_1 = Quantity("phi_1")
 p4_2 = Quantity("p4_2")
 p4_2_uncorrected = Quantity("p4_2_uncorrected")
+# cartesian components of the lorentz vectors
+p4_1_cartesian = Quantity("p4_1_cartesian")
+p4_1_px = Quantity("p4_1_px")
+p4_1_py = Quantity("p4_1_py")
+p4_1_pz = Quantity("p4_1_pz")
+p4_1_e = Quantity("p4_1_e")
+p4_2_cartesian = Quantity("p4_2_cartesian")
+p4_2_px = Quantity("p4_2_px")
+p4_2_py = Quantity("p4_2_py")
+p4_2_pz = Quantity("p4_2_pz")
+p4_2_e = Quantity("p4_2_e")
+# tuples of the unpacked quantities of the particles, see quantities::Unpack
+quantities_1 = Quantity("quantities_1")
+quantities_2 = Quantity("quantities_2")
 pt_2 = Quantity("pt_2")
 eta_2 = Quantity("eta_2")
 phi_2 = Quantity("phi_2")
@@ -102,6 +115,7 @@ gen_eta_1 = Quantity("gen_eta_1")
 gen_phi_1 = Quantity("gen_phi_1")
 gen_mass_1 = Quantity("gen_mass_1")
 gen_pdgid_1 = Quantity("gen_pdgid_1")
+gen_quantities_1 = Quantity("gen_quantities_1")
 
 gen_p4_2 = Quantity("gen_p4_2")
 gen_pt_2 = Quantity("gen_pt_2")
@@ -109,6 +123,7 @@ gen_eta_2 = Quantity("gen_eta_2")
 gen_phi_2 = Quantity("gen_phi_2")
 gen_mass_2 = Quantity("gen_mass_2")
 gen_pdgid_2 = Quantity("gen_pdgid_2")
+gen_quantities_2 = Quantity("gen_quantities_2")
 
 gen_m_vis = Quantity("gen_m_vis")
 isoWeight_1 = Quantity("isoWeight_1")
@@ -147,6 +162,8 @@ recoil_genboson_p4 = Quantity("recoil_genboson_p4")
 met_p4_leptoncorrected = Quantity("met_p4_leptoncorrected")
 met_p4_jetcorrected = Quantity("met_p4_jetcorrected")
 met_p4_recoilcorrected = Quantity("met_p4_recoilcorrected")
+met_px_recoilcorrected = Quantity("met_px_recoilcorrected")
+met_py_recoilcorrected = Quantity("met_py_recoilcorrected")
 met = Quantity("met")
 metphi = Quantity("metphi")
 metSumEt = Quantity("metSumEt")
@@ -154,3 +171,8 @@ metcov00 = Quantity("metcov00")
 metcov01 = Quantity("metcov01")
 metcov10 = Quantity("metcov10")
 metcov11 = Quantity("metcov11")
+
+## trigger quantities
+triggerobject_view = Quantity("triggerobject_view")
+single_trigger_flags = Quantity("single_trigger_flags")
+cross_trigger_flags = Quantity("cross_trigger_flags")
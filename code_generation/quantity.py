@@ -10,6 +10,8 @@ class Quantity:
         self.ignored_shifts = {}
         self.children = {}
         self.defined_for_scopes = []
+        self.variations = {}
+        self.unrolled = {}
         log.debug("Setting up new Quantity {}".format(self.name))
 
     def __str__(self) -> str:
@@ -66,6 +68,72 @@ class Quantity:
         ]
         return result
 
+    def set_variations(self, shifts, scope):
+        """
+        Function to mark, that the quantity is stored with all its variations in a single
+        column, see utility::Variations. The first variation is the nominal one, followed by
+        the given shifts. The leaves of the shifts are only defined, if they are unrolled.
+
+        Args:
+            shifts (list): Names of the shifts stored after the nominal variation
+            scope (str): Scope for which the variations are stored
+        Returns:
+            None
+        """
+        self.variations[scope] = [""] + list(shifts)
+
+    def get_variations(self, scope):
+        """
+        Function returns the shifts stored in the variation column of the quantity,
+        starting with the nominal one, or None if the quantity has no variation column.
+
+        Args:
+            scope (str): Scope for which the variations should be returned
+        Returns:
+            list: List of the stored shifts or None
+        """
+        if "global" in self.variations.keys():
+            return self.variations["global"]
+        return self.variations.get(scope)
+
+    def variation_index(self, shift, scope):
+        """
+        Function returns the index of the variation used for the given shift. If the
+        quantity is not shifted, the nominal variation is used.
+
+        Args:
+            shift (str): Name of the shift
+            scope (str): Scope for which the index should be returned
+        Returns:
+            int. Index of the variation
+        """
+        if shift in self.get_shifts(scope):
+            return self.get_variations(scope).index(shift)
+        return 0
+
+    def unroll(self, shifts, scope):
+        """
+        Function to request the leaves of the given shifts of a quantity with a variation
+        column. Each leaf is only returned once per scope, a leaf unrolled in the global
+        scope is available in all scopes.
+
+        Args:
+            shifts (list): Names of the shifts, the leaves of which are needed
+            scope (str): Scope in which the leaves are needed
+        Returns:
+            list. List of (leaf, index of the variation) tuples of the leaves, which
+            still have to be defined
+        """
+        result = []
+        unrolled = self.unrolled.setdefault(scope, set())
+        for shift in shifts:
+            leaf = self.get_leaf(shift, scope)
+            if leaf in unrolled or leaf in self.unrolled.get("global", set()):
+                continue
+            unrolled.add(leaf)
+            result.append((leaf, self.variation_index(shift, scope)))
+        return result
+
     def shift(self, name, scope):
         """
         Function to define a shift for a given scope. If the shift is marked as ignored, nothing will be added.
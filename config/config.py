@@ -12,7 +12,9 @@ from code_generation.producers.met import *
 import code_generation.quantities.output as q
 from config.utility import (
     AddSystematicShift,
+    RequirePayloads,
     OptimizeProducerOrdering,
+    PruneProducers,
     SystematicShiftByInputQuantity,
     ResolveSampleDependencies,
     ResolveEraDependencies,
@@ -63,8 +65,14 @@ def build_config(era, sample):
             "muon_id": "Muon_mediumId",
             # "muon_iso": "Muon_pfRelIso04_all",
             "muon_iso_cut": 0.3,
+            # JetMET text payloads, jets are not corrected if the files are
+            # not set. The resolution payloads are placeholders, see
+            # data/jet_corrections
+            "JEC_uncertainty_file": "",
             "JEC_shift_sources": '{""}',
             "JE_scale_shift": 0,
+            "JER_resolution_file": "data/jet_corrections/Placeholder_PtResolution_AK4PFchs.txt",
+            "JER_scalefactor_file": "data/jet_corrections/Placeholder_SF_AK4PFchs.txt",
             "JE_reso_shift": 0,
             "tau_ES_shift_DM0": 1.0,
             "tau_ES_shift_DM1": 1.0,
@@ -129,6 +137,9 @@ def build_config(era, sample):
             "muon_sf_id_args": "m_pt,m_eta",
             "muon_sf_iso_name": "m_iso_binned_kit_ratio",
             "muon_sf_iso_args": "m_pt,m_eta,m_iso",
+            # maximal deviation of the scale factor lookup tables from the
+            # workspace functions, -1 evaluates the workspace functions directly
+            "muon_sf_tabulation_tolerance": -1,
             "propagateLeptons": True,
             "propagateJets": True,
             "recoil_corrections_file": {
@@ -163,6 +174,8 @@ def build_config(era, sample):
         },
         "zptmass_functor": "zptmass_weight_nom",
         "zptmass_arguments": "z_gen_mass,z_gen_pt",
+        # see muon_sf_tabulation_tolerance
+        "zptmass_tabulation_tolerance": -1,
     }
     for channel in ["mt"]:  # add em et tt here as soon as they appear in config
         base_config[channel].update(all_channels)
@@ -183,6 +196,7 @@ def build_config(era, sample):
             JetEnergyCorrection,
             GoodJets,
             GoodBJets,
+            TriggerObjectView,
         ],
         "mt": [
             GoodMuons,
@@ -200,8 +214,7 @@ def build_config(era, sample):
             BasicBJetQuantities,
             GenDiTauPairQuantities,
             MuonIDIso_SF,
-            GenerateSingleMuonTriggerFlags,
-            GenerateCrossTriggerFlags,
+            MTTriggerFlags,
             LVMu1Uncorrected,
             LVTau2Uncorrected,
             MetCorrections,
@@ -293,8 +306,10 @@ def build_config(era, sample):
             q.metcov01,
             q.metcov10,
             q.metcov11,
-            GenerateSingleMuonTriggerFlags.output_group,
-            GenerateCrossTriggerFlags.output_group,
+            # the flags of the individual paths, write q.single_trigger_flags
+            # and q.cross_trigger_flags instead to store the packed flags
+            MTSingleTriggerFlags.output_group,
+            MTCrossTriggerFlags.output_group,
             nanoAOD.HTXS_Higgs_pt,
             nanoAOD.HTXS_njets30,
             nanoAOD.HTXS_stage_0,
@@ -399,7 +414,8 @@ def build_config(era, sample):
         },
         [[ApplyRecoilCorrections, "mt"]],
     )
-    # Jet energy resolution
+    # Jet energy resolution, the shifts require the JetMET payloads
+    RequirePayloads(config, "global", ["JER_resolution_file", "JER_scalefactor_file"])
     shift_dict = {"JE_reso_shift": 1}
     AddSystematicShift(
         config, "jerUncUp", {"global": shift_dict}, [[JetEnergyCorrection, "global"]]
@@ -487,4 +503,6 @@ def build_config(era, sample):
     #     config, "jecUncRelativeSampleYearDown", {"global": shift_dict}, [[JetEnergyCorrection, "global"]]
     # )
 
+    PruneProducers(config)
+
     return config
@@ -14,7 +14,9 @@ from code_generation.producers.met import *
 import code_generation.quantities.output as q
 from config.utility import (
     AddSystematicShift,
+    RequirePayloads,
     OptimizeProducerOrdering,
+    PruneProducers,
     ResolveSampleDependencies,
     ResolveEraDependencies,
     RemoveProducer,
@@ -64,8 +66,14 @@ def build_config(era, sample):
             "muon_id": "Muon_mediumId",
             # "muon_iso": "Muon_pfRelIso04_all",
             "muon_iso_cut": 0.3,
+            # JetMET text payloads, jets are not corrected if the files are
+            # not set. The resolution payloads are placeholders, see
+            # data/jet_corrections
+            "JEC_uncertainty_file": "",
             "JEC_shift_sources": '{""}',
             "JE_scale_shift": 0,
+            "JER_resolution_file": "data/jet_corrections/Placeholder_PtResolution_AK4PFchs.txt",
+            "JER_scalefactor_file": "data/jet_corrections/Placeholder_SF_AK4PFchs.txt",
             "JE_reso_shift": 0,
             "tau_ES_shift_DM0": 1.0,
             "tau_ES_shift_DM1": 1.0,
@@ -91,6 +99,9 @@ def build_config(era, sample):
             "muon_sf_id_args": "m_pt,m_eta",
             "muon_sf_iso_name": "m_iso_binned_kit_ratio",
             "muon_sf_iso_args": "m_pt,m_eta,m_iso",
+            # maximal deviation of the scale factor lookup tables from the
+            # workspace functions, -1 evaluates the workspace functions directly
+            "muon_sf_tabulation_tolerance": -1,
             "propagateLeptons": True,
             "propagateJets": True,
             "recoil_corrections_file": {
@@ -150,6 +161,10 @@ def build_config(era, sample):
             LVMu1,
             LVTau2,
             DiTauPairQuantities,
+            # the cartesian components are written out as well, so that they
+            # are covered by the tests
+            LVMu1Cartesian,
+            LVTau2Cartesian,
             JetCollection,
             BasicJetQuantities,
             BJetCollection,
@@ -187,6 +202,14 @@ def build_config(era, sample):
             q.jphi_2,
             q.mjj,
             q.m_vis,
+            q.p4_1_px,
+            q.p4_1_py,
+            q.p4_1_pz,
+            q.p4_1_e,
+            q.p4_2_px,
+            q.p4_2_py,
+            q.p4_2_pz,
+            q.p4_2_e,
             q.electron_veto_flag,
             q.muon_veto_flag,
             q.dimuon_veto,
@@ -245,19 +268,33 @@ def build_config(era, sample):
         "tauES_1prong0pizeroUp",
         {"global": {"tau_ES_shift_DM0": 1.002}},
         [[TauPtCorrection, "global"]],
-        sanetize_producers=[[LVMu1, "mt"], [VetoMuons, "mt"]],
+        sanetize_producers=[
+            [LVMu1, "mt"],
+            [LVMu1Cartesian, "mt"],
+            [VetoMuons, "mt"],
+        ],
     )
     AddSystematicShift(
         config,
         "tauES_1prong0pizeroDown",
         {"global": {"tau_ES_shift_DM0": 0.998}},
         [[TauPtCorrection, "global"]],
-        sanetize_producers=[[LVMu1, "mt"], [VetoMuons, "mt"]],
+        sanetize_producers=[
+            [LVMu1, "mt"],
+            [LVMu1Cartesian, "mt"],
+            [VetoMuons, "mt"],
+        ],
     )
-    # # Jet energy resolution
+    # Jet energy resolution, the shift requires the JetMET payloads
+    RequirePayloads(config, "global", ["JER_resolution_file", "JER_scalefactor_file"])
     shift_dict = {"JE_reso_shift": 1}
     AddSystematicShift(
-        config, "jerUncUp", {"global": shift_dict}, [[JetEnergyCorrection, "global"]]
+        config,
+        "jerUncUp",
+        {"global": shift_dict},
+        [[JetEnergyCorrection, "global"]],
     )
 
+    PruneProducers(config)
+
     return config
@@ -1,9 +1,33 @@
-from code_generation.optimizer import ProducerOrdering
+from code_generation.optimizer import FilterProfile, ProducerOrdering, ProducerPruning
 import copy
 import logging
+import os
 
 log = logging.getLogger(__name__)
 
+# Function to check, that the payload files given by the config parameters
+# exist, e.g. before systematic shifts depending on them are added. Relative
+# paths are resolved with respect to the main directory of the repository.
+def RequirePayloads(config, scope, parameters):
+    main_directory = os.path.join(os.path.dirname(__file__), "..")
+    for parameter in parameters:
+        path = config[""][scope][parameter]
+        if not path:
+            log.error(
+                "Payload {} required, but not set in the config!".format(parameter)
+            )
+            raise Exception
+        if not os.path.isabs(path):
+            path = os.path.join(main_directory, path)
+        if not os.path.isfile(path):
+            log.error(
+                "Payload {} not found: {}".format(
+                    parameter, config[""][scope][parameter]
+                )
+            )
+            raise Exception
+
+
 # Function for introducing systematic variations to producers and depending quantities
 def AddSystematicShift(
     config, name, change_dict, base_producers, sanetize_producers=[]
@@ -135,3 +159,23 @@ def OptimizeProducerOrdering(config):
         ordering = ProducerOrdering(config, scope)
         ordering.Optimize()
         config["producers"][scope] = ordering.ordering
+
+
+# Function for ordering the filters according to a filter profile, written by an
+# executable run with the --filter-profile option
+def ApplyFilterProfile(config, filename):
+    profile = FilterProfile(filename)
+    profile.sort_vector_filters(config)
+    for scope in config["producers"].keys():
+        log.info("Ordering filters in scope {} using the filter profile".format(scope))
+        ordering = ProducerOrdering(config, scope, profile)
+        ordering.Optimize()
+        config["producers"][scope] = ordering.ordering
+
+
+# Function for removing the producers and shifts, which do not contribute to the
+# output. Has to be called after all shifts are added.
+def PruneProducers(config):
+    log.info("Removing unused producers and shifts")
+    pruning = ProducerPruning(config)
+    pruning.Prune()
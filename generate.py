@@ -6,6 +6,7 @@ import logging
 import logging.handlers
 
 from code_generation.code_generation import fill_template
+from config.utility import ApplyFilterProfile
 
 parser = argparse.ArgumentParser(description="Generate the C++ code for a given config")
 parser.add_argument("--template", type=str, help="Path to the template")
@@ -24,6 +25,18 @@ parser.add_argument(
     "--samples", type=str, help='Samples to be processed. To select all, choose "auto"'
 )
 parser.add_argument("--debug", type=str, help='set debug mode for building"')
+parser.add_argument(
+    "--filter-profile",
+    type=str,
+    default="",
+    help="Filter profile written by an executable with --filter-profile, used to order the filters",
+)
+parser.add_argument(
+    "--instrumentation",
+    type=str,
+    default="false",
+    help="Count the calls, time and allocations of each producer and shift",
+)
 args = parser.parse_args()
 # Executables for each era and per following processes:
 # ggH
@@ -37,6 +50,10 @@ args = parser.parse_args()
 # data
 
 executables = []
+# debug builds keep the debug logging of the C++ code, otherwise it is removed
+# at compile time
+loglevel = "DEBUG" if args.debug != "false" else "INFO"
+instrumentation = args.instrumentation != "false"
 eras = ["2018"]
 sample_groups = ["emb"]
 for era in eras:
@@ -63,14 +80,18 @@ for era in eras:
         root.info("Generating code for {}...".format(sample_group))
         root.info("Configuration used: {}".format(analysis))
         config = analysis.build_config(era, sample_group)
+        if args.filter_profile != "":
+            ApplyFilterProfile(config, args.filter_profile)
         # fill code template and write executable
         with open(args.template, "r") as template_file:
             template = template_file.read()
-        template = fill_template(template, config)
+        template = fill_template(template, config, instrumentation)
         template = (
             template.replace("{ANALYSISTAG}", '"Analysis=%s"' % args.analysis)
             .replace("{ERATAG}", '"Era=%s"' % era)
             .replace("{SAMPLETAG}", '"Samplegroup=%s"' % sample_group)
+            .replace("{LOGLEVEL}", loglevel)
+            .replace("{INSTRUMENTATION}", "1" if instrumentation else "0")
         )
         with open(executable, "w") as executable_file:
             executable_file.write(template)
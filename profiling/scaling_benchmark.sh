@@ -0,0 +1,20 @@
+#!/bin/bash
+
+EXECUTABLE=$1
+INPUTFILE=$2
+OUTPUTFILE=$3
+MAXTHREADS=${4:-0}
+
+# The number of clusters in the input file limits the multi-thread scaling,
+# see root_cluster_ranges.sh. Print it first to put the results into context.
+NCLUSTERS=$(rootls -t ${INPUTFILE}:Events | grep "Cluster INCLUSIVE ranges:" -A 100000 | grep -c "^ *- #")
+echo "Number of clusters in ${INPUTFILE}: ${NCLUSTERS}"
+
+# Run the event loop with 1, 2, 4, ... MAXTHREADS threads (all available cores
+# if MAXTHREADS is not given) and report the event throughput, the parallel
+# efficiency and the peak memory usage for each setting.
+if [ ${MAXTHREADS} -gt 0 ]; then
+    $EXECUTABLE --scaling-benchmark --threads ${MAXTHREADS} $INPUTFILE $OUTPUTFILE
+else
+    $EXECUTABLE --scaling-benchmark $INPUTFILE $OUTPUTFILE
+fi
@@ -0,0 +1,430 @@
+#include "JetEnergyCorrector.hxx"
+#include "../utility/CorrectionRegistry.hxx"
+#include "../utility/Logger.hxx"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// A section of a JetMET text payload. Files with several uncertainty sources
+// contain one section per source, started by a line `[SourceName]`.
+struct PayloadSection {
+    std::string name;
+    std::vector<std::string> header;
+    std::vector<std::vector<float>> rows;
+};
+
+[[noreturn]] void PayloadError(const std::string &filename,
+                               const std::string &message) {
+    Logger::get("JetEnergyCorrector")
+        ->critical("Invalid jet correction payload {}: {}", filename, message);
+    throw std::runtime_error("Invalid jet correction payload");
+}
+
+std::vector<PayloadSection> ReadPayload(const std::string &filename) {
+    std::ifstream file(filename);
+    if (!file)
+        PayloadError(filename, "file can not be opened");
+    std::vector<PayloadSection> sections;
+    std::string line;
+    while (std::getline(file, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+        if (line[first] == '[') {
+            const auto last = line.find(']', first);
+            sections.emplace_back();
+            sections.back().name = line.substr(first + 1, last - first - 1);
+        } else if (line[first] == '{') {
+            // files with a single uncertainty have no section names
+            if (sections.empty() || !sections.back().header.empty()) {
+                sections.emplace_back();
+                sections.back().name = "Total";
+            }
+            const auto last = line.rfind('}');
+            std::istringstream tokens(line.substr(first + 1, last - first - 1));
+            std::string token;
+            while (tokens >> token)
+                sections.back().header.push_back(token);
+        } else {
+            if (sections.empty() || sections.back().header.empty())
+                PayloadError(filename, "values before the header");
+            std::istringstream values(line);
+            std::vector<float> row;
+            float value;
+            while (values >> value)
+                row.push_back(value);
+            sections.back().rows.push_back(std::move(row));
+        }
+    }
+    return sections;
+}
+
+// Adds the eta bin of a row to the eta edges, rows of the same eta bin have
+// to follow each other
+void AddEtaBin(const std::string &filename, std::vector<float> &etaEdges,
+               std::vector<std::size_t> &offsets, float etaMin, float etaMax,
+               std::size_t row) {
+    if (!etaEdges.empty() && etaEdges[etaEdges.size() - 2] == etaMin)
+        return;
+    if (etaEdges.empty()) {
+        etaEdges = {etaMin, etaMax};
+        offsets = {row, row};
+    } else if (etaEdges.back() == etaMin) {
+        etaEdges.push_back(etaMax);
+        offsets.push_back(row);
+    } else {
+        PayloadError(filename, "eta bins are not contiguous");
+    }
+}
+
+// Finds the eta bin, values outside of the table are clamped to the first or
+// last bin. Tables starting at zero are binned in |eta|.
+std::size_t FindEtaBin(const std::vector<float> &etaEdges, float eta) {
+    if (etaEdges.front() >= 0.f)
+        eta = std::abs(eta);
+    const auto upper =
+        std::upper_bound(etaEdges.begin() + 1, etaEdges.end() - 1, eta);
+    return upper - etaEdges.begin() - 1;
+}
+
+JetUncertaintyTable BuildUncertaintyTable(const std::string &filename,
+                                          const PayloadSection &section) {
+    JetUncertaintyTable table;
+    for (const auto &row : section.rows) {
+        if (row.size() < 3 || row.size() != 3 + std::size_t(row[2]) ||
+            row[2] == 0 || std::size_t(row[2]) % 3 != 0)
+            PayloadError(filename, "malformed row in source " + section.name);
+        AddEtaBin(filename, table.etaEdges, table.offsets, row[0], row[1],
+                  table.pts.size());
+        for (std::size_t i = 3; i < row.size(); i += 3) {
+            table.pts.push_back(row[i]);
+            table.up.push_back(row[i + 1]);
+            table.down.push_back(row[i + 2]);
+        }
+        table.offsets.back() = table.pts.size();
+    }
+    if (table.etaEdges.empty())
+        PayloadError(filename, "no entries in source " + section.name);
+    return table;
+}
+
+// The header of a parametrization is
+// {<nBins> <bin variables> <nVariables> <variables> <formula> <type>}
+// and each row contains the bin ranges, the number of values, the ranges of
+// the formula variables and the parameters.
+JetParameterTable BuildParameterTable(const std::string &filename,
+                                      const PayloadSection &section,
+                                      std::size_t nParameters) {
+    const auto &header = section.header;
+    const std::size_t nBins = std::stoul(header.at(0));
+    const std::size_t nVariables = std::stoul(header.at(nBins + 1));
+    if (nBins < 1 || nBins > 2 || header.at(1) != "JetEta" || nVariables > 1)
+        PayloadError(filename, "unsupported binning");
+    JetParameterTable table;
+    table.hasSecondVariable = nBins == 2;
+    table.hasFormulaRange = nVariables == 1;
+    table.nParameters = nParameters;
+    const std::size_t first = 2 * nBins + 1;
+    for (const auto &row : section.rows) {
+        if (row.size() < first ||
+            row.size() != first + std::size_t(row[2 * nBins]) ||
+            row.size() < first + 2 * nVariables + nParameters)
+            PayloadError(filename, "malformed row");
+        AddEtaBin(filename, table.etaEdges, table.offsets, row[0], row[1],
+                  table.secondMin.size());
+        table.secondMin.push_back(table.hasSecondVariable ? row[2] : 0.f);
+        table.secondMax.push_back(table.hasSecondVariable ? row[3] : 0.f);
+        table.xMin.push_back(table.hasFormulaRange ? row[first] : 0.f);
+        table.xMax.push_back(table.hasFormulaRange ? row[first + 1] : 0.f);
+        const auto parameters = row.begin() + first + 2 * nVariables;
+        table.parameters.insert(table.parameters.end(), parameters,
+                                parameters + nParameters);
+        table.offsets.back() = table.secondMin.size();
+    }
+    if (table.etaEdges.empty())
+        PayloadError(filename, "no entries");
+    return table;
+}
+
+// Standard normal random number derived from the direction of the jet, so
+// that a jet is smeared by the same amount in all variations and runs. The
+// bits of eta and phi are mixed with the splitmix64 generator and converted
+// with the Box-Muller transform.
+float JetRandomGaus(float eta, float phi) {
+    std::uint32_t etaBits, phiBits;
+    std::memcpy(&etaBits, &eta, sizeof(float));
+    std::memcpy(&phiBits, &phi, sizeof(float));
+    std::uint64_t state = (std::uint64_t(etaBits) << 32) | phiBits;
+    auto next = [&state]() {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    };
+    const double u1 = ((next() >> 11) + 1) * 0x1.0p-53;
+    const double u2 = (next() >> 11) * 0x1.0p-53;
+    return std::sqrt(-2. * std::log(u1)) * std::cos(2. * M_PI * u2);
+}
+
+} // namespace
+
+float JetUncertaintyTable::Uncertainty(float pt, float eta, int shift) const {
+    const std::size_t bin = FindEtaBin(etaEdges, eta);
+    const std::size_t begin = offsets[bin];
+    const std::size_t end = offsets[bin + 1];
+    const auto &values = shift > 0 ? up : down;
+    if (pt <= pts[begin])
+        return values[begin];
+    if (pt >= pts[end - 1])
+        return values[end - 1];
+    const std::size_t upper =
+        std::upper_bound(pts.begin() + begin, pts.begin() + end, pt) -
+        pts.begin();
+    const float fraction =
+        (pt - pts[upper - 1]) / (pts[upper] - pts[upper - 1]);
+    return values[upper - 1] + fraction * (values[upper] - values[upper - 1]);
+}
+
+std::size_t JetParameterTable::FindRow(float eta, float second) const {
+    const std::size_t bin = FindEtaBin(etaEdges, eta);
+    std::size_t row = offsets[bin];
+    if (hasSecondVariable) {
+        // values outside of the bins are clamped to the first or last bin
+        for (std::size_t i = offsets[bin]; i < offsets[bin + 1]; ++i) {
+            if (secondMin[i] <= second)
+                row = i;
+        }
+    }
+    return row;
+}
+
+std::shared_ptr<const JetEnergyCorrector>
+JetEnergyCorrector::Load(const std::string &uncertaintyFile,
+                         const std::string &resolutionFile,
+                         const std::string &scaleFactorFile) {
+    return CorrectionRegistry::getOrCreate<const JetEnergyCorrector>(
+        uncertaintyFile, "JetEnergyCorrector",
+        resolutionFile + ";" + scaleFactorFile, [&]() {
+            return std::make_shared<const JetEnergyCorrector>(
+                uncertaintyFile, resolutionFile, scaleFactorFile);
+        });
+}
+
+JetEnergyCorrector::JetEnergyCorrector(const std::string &uncertaintyFile,
+                                       const std::string &resolutionFile,
+                                       const std::string &scaleFactorFile) {
+    auto log = Logger::get("JetEnergyCorrector");
+    if (!uncertaintyFile.empty()) {
+        for (const auto &section : ReadPayload(uncertaintyFile)) {
+            _sourceNames.push_back(section.name);
+            _sources.push_back(BuildUncertaintyTable(uncertaintyFile, section));
+        }
+        log->info("Loaded {} jet energy scale uncertainty sources from {}",
+                  _sources.size(), uncertaintyFile);
+    }
+    if (resolutionFile.empty() != scaleFactorFile.empty()) {
+        log->critical("The jet energy resolution and its scale factors have "
+                      "to be given together");
+        throw std::runtime_error("Incomplete jet energy resolution payloads");
+    }
+    if (resolutionFile.empty()) {
+        if (uncertaintyFile.empty())
+            log->warn("No jet energy correction payloads given, the jets are "
+                      "not corrected");
+        return;
+    }
+    const auto resolution = ReadPayload(resolutionFile);
+    if (resolution.size() != 1)
+        PayloadError(resolutionFile, "expected a single parametrization");
+    // only the standard parametrization of the resolution is supported
+    const auto &header = resolution[0].header;
+    if (header.size() < 2 ||
+        header[header.size() - 2] !=
+            "sqrt([0]*abs([0])/(x*x)+[1]*[1]*pow(x,[3])+[2]*[2])")
+        PayloadError(resolutionFile, "unsupported resolution formula");
+    _resolution = BuildParameterTable(resolutionFile, resolution[0], 4);
+    // the jet pt is clamped to the range of the formula, without it the
+    // formula diverges for small pts
+    if (!_resolution.hasFormulaRange)
+        PayloadError(resolutionFile, "no range of the jet pt given");
+    const auto scaleFactors = ReadPayload(scaleFactorFile);
+    if (scaleFactors.size() != 1)
+        PayloadError(scaleFactorFile, "expected a single parametrization");
+    // the scale factors are given as nominal, down and up value
+    _scaleFactors = BuildParameterTable(scaleFactorFile, scaleFactors[0], 3);
+    _smearing = true;
+    log->info("Loaded jet energy resolution from {} and scale factors from {}",
+              resolutionFile, scaleFactorFile);
+}
+
+JetEnergyCorrector::Variation
+JetEnergyCorrector::MakeVariation(const std::vector<std::string> &sources,
+                                  int scaleShift, int resolutionShift) const {
+    auto log = Logger::get("JetEnergyCorrector");
+    Variation variation;
+    variation.scaleShift = scaleShift;
+    variation.resolutionShift = resolutionShift;
+    for (const auto &source : sources) {
+        if (source.empty())
+            continue;
+        const auto found =
+            std::find(_sourceNames.begin(), _sourceNames.end(), source);
+        if (found == _sourceNames.end()) {
+            log->critical("Unknown jet energy scale uncertainty source {}",
+                          source);
+            throw std::runtime_error("Unknown uncertainty source");
+        }
+        variation.sources.push_back(found - _sourceNames.begin());
+    }
+    // a shift without payloads would be identical to the nominal jets
+    if (scaleShift != 0 && variation.sources.empty()) {
+        log->critical("Jet energy scale shift without uncertainty sources");
+        throw std::runtime_error("Jet energy scale shift without sources");
+    }
+    if (resolutionShift != 0 && !_smearing) {
+        log->critical("Jet energy resolution shift without resolution "
+                      "payloads");
+        throw std::runtime_error("Jet energy resolution shift without "
+                                 "payloads");
+    }
+    return variation;
+}
+
+float JetEnergyCorrector::Resolution(float pt, float eta, float rho) const {
+    const std::size_t row = _resolution.FindRow(eta, rho);
+    const float x =
+        std::clamp(pt, _resolution.xMin[row], _resolution.xMax[row]);
+    const float *p = &_resolution.parameters[row * 4];
+    return std::sqrt(p[0] * std::abs(p[0]) / (x * x) +
+                     p[1] * p[1] * std::pow(x, p[3]) + p[2] * p[2]);
+}
+
+float JetEnergyCorrector::ScaleFactor(float pt, float eta, int shift) const {
+    const std::size_t row = _scaleFactors.FindRow(eta, pt);
+    const int index = shift == 0 ? 0 : (shift < 0 ? 1 : 2);
+    return _scaleFactors.parameters[row * 3 + index];
+}
+
+std::vector<ROOT::RVec<float>> JetEnergyCorrector::Correct(
+    const ROOT::RVec<float> &pt, const ROOT::RVec<float> &eta,
+    const ROOT::RVec<float> &phi, const ROOT::RVec<float> &genPt,
+    const ROOT::RVec<float> &genEta, const ROOT::RVec<float> &genPhi,
+    float rho, const std::vector<Variation> &variations) const {
+    const std::size_t njets = pt.size();
+    // the gen jet matching in eta and phi and the random numbers do not
+    // depend on the variation, the pt requirement of the matching does
+    ROOT::RVec<float> matchedGenPt(njets, -1.f);
+    ROOT::RVec<float> gaus(njets, 0.f);
+    if (_smearing) {
+        // the gen jets are sorted in eta once per event, so that each jet is
+        // only compared to the gen jets within matchDeltaR in eta
+        const std::size_t ngenjets = genPt.size();
+        std::vector<std::size_t> genOrder(ngenjets);
+        std::iota(genOrder.begin(), genOrder.end(), 0);
+        std::sort(genOrder.begin(), genOrder.end(),
+                  [&genEta](std::size_t a, std::size_t b) {
+                      return genEta[a] < genEta[b];
+                  });
+        std::vector<float> sortedGenEta(ngenjets);
+        for (std::size_t k = 0; k < ngenjets; ++k)
+            sortedGenEta[k] = genEta[genOrder[k]];
+        for (std::size_t i = 0; i < njets; ++i) {
+            // the window is computed in double precision, so that it contains
+            // all gen jets passing the requirement on deta below
+            const double etaMin = double(eta[i]) - matchDeltaR;
+            const double etaMax = double(eta[i]) + matchDeltaR;
+            float minDeltaR2 = matchDeltaR * matchDeltaR;
+            std::size_t best = ngenjets;
+            for (std::size_t k =
+                     std::lower_bound(sortedGenEta.begin(), sortedGenEta.end(),
+                                      etaMin) -
+                     sortedGenEta.begin();
+                 k < ngenjets && sortedGenEta[k] <= etaMax; ++k) {
+                const std::size_t j = genOrder[k];
+                const float deta = genEta[j] - eta[i];
+                if (std::abs(deta) >= matchDeltaR)
+                    continue;
+                const float dphi = ROOT::VecOps::DeltaPhi(genPhi[j], phi[i]);
+                const float deltaR2 = deta * deta + dphi * dphi;
+                // for equal distances, the first gen jet is kept
+                if (deltaR2 < minDeltaR2 ||
+                    (deltaR2 == minDeltaR2 && best < ngenjets && j < best)) {
+                    minDeltaR2 = deltaR2;
+                    best = j;
+                }
+            }
+            if (best < ngenjets)
+                matchedGenPt[i] = genPt[best];
+            gaus[i] = JetRandomGaus(eta[i], phi[i]);
+        }
+    }
+
+    std::vector<ROOT::RVec<float>> results;
+    results.reserve(variations.size());
+    ROOT::RVec<float> scale(njets, 1.f);
+    ROOT::RVec<float> resolution(njets, 0.f);
+    ROOT::RVec<float> scaleFactor(njets, 1.f);
+    for (const auto &variation : variations) {
+        // table lookups
+        for (std::size_t i = 0; i < njets; ++i) {
+            float shift = 0.f;
+            if (variation.scaleShift != 0 && variation.sources.size() == 1) {
+                // a single source keeps its sign
+                shift = variation.scaleShift *
+                        _sources[variation.sources[0]].Uncertainty(
+                            pt[i], eta[i], variation.scaleShift);
+            } else if (variation.scaleShift != 0) {
+                for (const auto source : variation.sources) {
+                    const float uncertainty = _sources[source].Uncertainty(
+                        pt[i], eta[i], variation.scaleShift);
+                    shift += uncertainty * uncertainty;
+                }
+                shift = variation.scaleShift * std::sqrt(shift);
+            }
+            scale[i] = 1.f + shift;
+            if (_smearing) {
+                resolution[i] = Resolution(pt[i] * scale[i], eta[i], rho);
+                scaleFactor[i] = ScaleFactor(pt[i] * scale[i], eta[i],
+                                             variation.resolutionShift);
+            }
+        }
+        // the correction itself is free of branches and lookups, so that it
+        // can be vectorized. Jets with a matching gen jet are smeared with
+        // the scaled difference to the gen jet, all others stochastically
+        // (hybrid method).
+        ROOT::RVec<float> corrected(njets);
+        for (std::size_t i = 0; i < njets; ++i) {
+            const float scaled = pt[i] * scale[i];
+            const float sf = scaleFactor[i];
+            const bool matched =
+                matchedGenPt[i] > 0.f &&
+                std::abs(scaled - matchedGenPt[i]) <
+                    3.f * resolution[i] * scaled;
+            const float hybrid =
+                1.f + (sf - 1.f) * (scaled - matchedGenPt[i]) / scaled;
+            const float stochastic =
+                1.f + gaus[i] * resolution[i] *
+                          std::sqrt(std::max(sf * sf - 1.f, 0.f));
+            corrected[i] =
+                scaled * std::max(0.f, matched ? hybrid : stochastic);
+        }
+        results.push_back(std::move(corrected));
+    }
+    return results;
+}
+
+ROOT::RVec<float> JetEnergyCorrector::Correct(
+    const ROOT::RVec<float> &pt, const ROOT::RVec<float> &eta,
+    const ROOT::RVec<float> &phi, const ROOT::RVec<float> &genPt,
+    const ROOT::RVec<float> &genEta, const ROOT::RVec<float> &genPhi,
+    float rho, const Variation &variation) const {
+    const std::vector<Variation> variations = {variation};
+    return std::move(
+        Correct(pt, eta, phi, genPt, genEta, genPhi, rho, variations)[0]);
+}
@@ -0,0 +1,113 @@
+#ifndef GUARDJETENERGYCORRECTOR_H
+#define GUARDJETENERGYCORRECTOR_H
+
+#include "ROOT/RVec.hxx"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Table of the jet energy scale uncertainty of one source, as given in the
+// JetMET uncertainty payloads: for each eta bin, the relative up and down
+// uncertainties are given at a list of pt values and interpolated linearly.
+struct JetUncertaintyTable {
+    // relative uncertainty for the given shift direction (+1 up, -1 down)
+    float Uncertainty(float pt, float eta, int shift) const;
+
+    std::vector<float> etaEdges;
+    // the points of eta bin i are stored from offsets[i] to offsets[i + 1]
+    std::vector<std::size_t> offsets;
+    std::vector<float> pts;
+    std::vector<float> up;
+    std::vector<float> down;
+};
+
+// Table of a parametrization binned in eta and, optionally, a second
+// variable, as given in the JetMET resolution and scale factor payloads.
+// All rows are stored in flat arrays, grouped by the eta bin.
+struct JetParameterTable {
+    // index of the row containing the given eta and second variable
+    std::size_t FindRow(float eta, float second) const;
+
+    std::vector<float> etaEdges;
+    // the rows of eta bin i are stored from offsets[i] to offsets[i + 1]
+    std::vector<std::size_t> offsets;
+    // range of the second binning variable of each row, if present
+    bool hasSecondVariable = false;
+    std::vector<float> secondMin;
+    std::vector<float> secondMax;
+    // validity range of the formula variable (the jet pt) of each row, if
+    // present
+    bool hasFormulaRange = false;
+    std::vector<float> xMin;
+    std::vector<float> xMax;
+    std::size_t nParameters = 0;
+    std::vector<float> parameters;
+};
+
+// Engine for the jet energy scale uncertainties and the jet energy
+// resolution smearing. The payloads are read from the text files provided by
+// JetMET when the engine is constructed and converted into flat tables. The
+// engine is not modified afterwards, so a single instance can be used by all
+// threads and all systematic variations. An empty file name disables the
+// corresponding correction.
+class JetEnergyCorrector {
+
+  public:
+    // A variation of the jet energies: the jet energy scale is shifted by
+    // scaleShift (0 nominal, +1 up, -1 down) times the uncertainty of the
+    // given sources, and the resolution scale factor by resolutionShift.
+    struct Variation {
+        int scaleShift = 0;
+        std::vector<std::size_t> sources;
+        int resolutionShift = 0;
+    };
+
+    JetEnergyCorrector(const std::string &uncertaintyFile,
+                       const std::string &resolutionFile,
+                       const std::string &scaleFactorFile);
+
+    // Returns the engine for the given payloads. A single instance per set of
+    // files is shared by all users via the CorrectionRegistry.
+    static std::shared_ptr<const JetEnergyCorrector>
+    Load(const std::string &uncertaintyFile, const std::string &resolutionFile,
+         const std::string &scaleFactorFile);
+
+    // Builds a variation, the sources are given by their names in the
+    // uncertainty payload. Empty names are ignored. Shifts without the
+    // corresponding payloads are rejected.
+    Variation MakeVariation(const std::vector<std::string> &sources,
+                            int scaleShift, int resolutionShift) const;
+
+    // Corrects the jet pts of an event for all given variations. The gen
+    // jet matching and the random numbers are shared by all variations.
+    std::vector<ROOT::RVec<float>>
+    Correct(const ROOT::RVec<float> &pt, const ROOT::RVec<float> &eta,
+            const ROOT::RVec<float> &phi, const ROOT::RVec<float> &genPt,
+            const ROOT::RVec<float> &genEta, const ROOT::RVec<float> &genPhi,
+            float rho, const std::vector<Variation> &variations) const;
+
+    ROOT::RVec<float>
+    Correct(const ROOT::RVec<float> &pt, const ROOT::RVec<float> &eta,
+            const ROOT::RVec<float> &phi, const ROOT::RVec<float> &genPt,
+            const ROOT::RVec<float> &genEta, const ROOT::RVec<float> &genPhi,
+            float rho, const Variation &variation) const;
+
+    bool HasUncertainties() const { return !_sources.empty(); }
+    bool HasSmearing() const { return _smearing; }
+
+    // maximal distance between a jet and its gen jet, half the jet radius
+    constexpr static float matchDeltaR = 0.2;
+
+  private:
+    float Resolution(float pt, float eta, float rho) const;
+    float ScaleFactor(float pt, float eta, int shift) const;
+
+    std::vector<std::string> _sourceNames;
+    std::vector<JetUncertaintyTable> _sources;
+    bool _smearing = false;
+    JetParameterTable _resolution;
+    JetParameterTable _scaleFactors;
+};
+
+#endif /* GUARDJETENERGYCORRECTOR_H */
@@ -1,16 +1,46 @@
 #include "MetSystematics.hxx"
+#include "../utility/CorrectionRegistry.hxx"
 #include "../utility/Logger.hxx"
+#include <algorithm>
 
-MetSystematic::MetSystematic(std::string filepath) {
+HistogramInterpolation::HistogramInterpolation(const TH1 &hist) {
+    for (int bin = 1; bin <= hist.GetNbinsX(); ++bin) {
+        _centers.push_back(hist.GetBinCenter(bin));
+        _contents.push_back(hist.GetBinContent(bin));
+    }
+}
+
+double HistogramInterpolation::Interpolate(double x) const {
+    if (x <= _centers.front())
+        return _contents.front();
+    if (x >= _centers.back())
+        return _contents.back();
+    const std::size_t upper =
+        std::upper_bound(_centers.begin(), _centers.end(), x) -
+        _centers.begin();
+    const std::size_t lower = upper - 1;
+    return _contents[lower] + (x - _centers[lower]) *
+                                  (_contents[upper] - _contents[lower]) /
+                                  (_centers[upper] - _centers[lower]);
+}
+
+std::shared_ptr<const MetSystematic>
+MetSystematic::Load(const std::string &filepath) {
+    return CorrectionRegistry::get<const MetSystematic>(
+        filepath, "MetSystematic", "", [](TFile &file) {
+            return std::make_shared<const MetSystematic>(file);
+        });
+}
+
+MetSystematic::MetSystematic(TFile &file) {
 
-    fileName = filepath;
-    TFile *file = new TFile(fileName, "READ");
-    if (file->IsZombie()) {
+    fileName = file.GetName();
+    if (file.IsZombie()) {
         Logger::get("MetSystematics")
             ->debug("file {} is not found...   quitting ", fileName);
         exit(-1);
     }
-    TH1D *jetBinsH = (TH1D *)file->Get("nJetBinsH");
+    TH1D *jetBinsH = (TH1D *)file.Get("nJetBinsH");
     if (jetBinsH == NULL) {
         Logger::get("MetSystematics")
             ->debug("Histogram nJetBinsH should be contained in file {}",
@@ -29,7 +59,7 @@ MetSystematic::MetSystematic(std::string filepath) {
     TString uncType[2] = {"Response", "Resolution"};
 
     TString histName = "syst";
-    TH2D *hist = (TH2D *)file->Get(histName);
+    TH2D *hist = (TH2D *)file.Get(histName);
     if (hist == NULL) {
         Logger::get("MetSystematics")
             ->debug("Histogram {} should be contained in file {}", histName,
@@ -49,8 +79,8 @@ MetSystematic::MetSystematic(std::string filepath) {
 
     for (int j = 0; j < nJetBins; ++j) {
         TString histName = JetBins[j];
-        responseHist[j] = (TH1D *)file->Get(histName);
-        if (responseHist[j] == NULL) {
+        TH1D *hist = (TH1D *)file.Get(histName);
+        if (hist == NULL) {
             Logger::get("MetSystematics")
                 ->debug("Histogram {} should be contained in file {}", histName,
                         fileName);
@@ -58,13 +88,15 @@ MetSystematic::MetSystematic(std::string filepath) {
                 ->debug("Check content of the file {}", fileName);
             exit(-1);
         }
+        responseHist[j] = HistogramInterpolation(*hist);
     }
 }
 
 void MetSystematic::ComputeHadRecoilFromMet(float metX, float metY,
                                             float genVPx, float genVPy,
                                             float visVPx, float visVPy,
-                                            float &Hparal, float &Hperp) {
+                                            float &Hparal,
+                                            float &Hperp) const {
 
     float genVPt = TMath::Sqrt(genVPx * genVPx + genVPy * genVPy);
     float unitX = genVPx / genVPt;
@@ -84,7 +116,7 @@ void MetSystematic::ComputeHadRecoilFromMet(float metX, float metY,
 void MetSystematic::ComputeMetFromHadRecoil(float Hparal, float Hperp,
                                             float genVPx, float genVPy,
                                             float visVPx, float visVPy,
-                                            float &metX, float &metY) {
+                                            float &metX, float &metY) const {
 
     float genVPt = TMath::Sqrt(genVPx * genVPx + genVPy * genVPy);
     float unitX = genVPx / genVPt;
@@ -105,7 +137,8 @@ void MetSystematic::ComputeMetFromHadRecoil(float Hparal, float Hperp,
 void MetSystematic::ShiftResponseMet(float metPx, float metPy, float genVPx,
                                      float genVPy, float visVPx, float visVPy,
                                      int njets, float sysShift,
-                                     float &metShiftPx, float &metShiftPy) {
+                                     float &metShiftPx,
+                                     float &metShiftPy) const {
 
     float Hparal = 0;
     float Hperp = 0;
@@ -129,7 +162,7 @@ void MetSystematic::ShiftResponseMet(float metPx, float metPy, float genVPx,
         exit(-1);
     }
 
-    float mean = -responseHist[jets]->Interpolate(genVPt) * genVPt;
+    float mean = -responseHist[jets].Interpolate(genVPt) * genVPt;
     float shift = sysShift * mean;
     Hparal = Hparal + (shift - mean);
 
@@ -140,7 +173,8 @@ void MetSystematic::ShiftResponseMet(float metPx, float metPy, float genVPx,
 void MetSystematic::ShiftResolutionMet(float metPx, float metPy, float genVPx,
                                        float genVPy, float visVPx, float visVPy,
                                        int njets, float sysShift,
-                                       float &metShiftPx, float &metShiftPy) {
+                                       float &metShiftPx,
+                                       float &metShiftPy) const {
 
     float Hparal = 0;
     float Hperp = 0;
@@ -164,7 +198,7 @@ void MetSystematic::ShiftResolutionMet(float metPx, float metPy, float genVPx,
         exit(-1);
     }
 
-    float mean = -responseHist[jets]->Interpolate(genVPt) * genVPt;
+    float mean = -responseHist[jets].Interpolate(genVPt) * genVPt;
     Hperp = sysShift * Hperp;
     Hparal = mean + (Hparal - mean) * sysShift;
 
@@ -175,7 +209,7 @@ void MetSystematic::ShiftResolutionMet(float metPx, float metPy, float genVPx,
 void MetSystematic::ShiftMet(float metPx, float metPy, float genVPx,
                              float genVPy, float visVPx, float visVPy,
                              int njets, int sysType, float sysShift,
-                             float &metShiftPx, float &metShiftPy) {
+                             float &metShiftPx, float &metShiftPy) const {
 
     metShiftPx = metPx;
     metShiftPy = metPy;
@@ -189,7 +223,8 @@ void MetSystematic::ShiftMet(float metPx, float metPy, float genVPx,
         ShiftResolutionMet(metPx, metPy, genVPx, genVPy, visVPx, visVPy, njets,
                            sysShift, metShiftPx, metShiftPy);
     else if (sysType == -1)
-        Logger::get("MetSystematics")->debug("No type --> doing nothing");
+        SPDLOG_LOGGER_DEBUG(Logger::get("MetSystematics"),
+                            "No type --> doing nothing");
     else {
         Logger::get("MetSystematics")
             ->debug("Unknown systematic type --> exiting");
@@ -200,7 +235,8 @@ void MetSystematic::ShiftMet(float metPx, float metPy, float genVPx,
 void MetSystematic::ApplyMetSystematic(float metPx, float metPy, float genVPx,
                                        float genVPy, float visVPx, float visVPy,
                                        int njets, int sysType, int sysShift,
-                                       float &metShiftPx, float &metShiftPy) {
+                                       float &metShiftPx,
+                                       float &metShiftPy) const {
 
     int jets = njets;
     if (jets > 2)
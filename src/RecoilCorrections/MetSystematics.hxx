@@ -9,30 +9,53 @@
 #include <TRandom.h>
 #include <TString.h>
 #include <assert.h>
+#include <memory>
+#include <vector>
 
+// Linear interpolation between the bin centers of a histogram, same as
+// TH1::Interpolate, but without access to the histogram
+struct HistogramInterpolation {
+    HistogramInterpolation() = default;
+    HistogramInterpolation(const TH1 &hist);
+
+    double Interpolate(double x) const;
+
+  private:
+    std::vector<double> _centers;
+    std::vector<double> _contents;
+};
+
+// The systematics read all required information from the file when they
+// are constructed and close the file afterwards. They are not modified after
+// the construction, so a single instance can be used by all threads.
 class MetSystematic {
 
   public:
-    MetSystematic(std::string filepath);
+    MetSystematic(TFile &file);
     ~MetSystematic(){};
 
+    // Returns the systematics for the given file, loaded only once via the
+    // CorrectionRegistry.
+    static std::shared_ptr<const MetSystematic>
+    Load(const std::string &filepath);
+
     void ApplyMetSystematic(float metPx, float metPy, float genVPx,
                             float genVPy, float visVPx, float visVPy, int njets,
                             int sysType, int shiftType, float &metShiftPx,
-                            float &metShiftPy);
+                            float &metShiftPy) const;
 
     void ShiftMet(float metPx, float metPy, float genVPx, float genVPy,
                   float visVPx, float visVPy, int njets, int sysType,
-                  float sysShift, float &metShiftPx, float &metShiftPy);
+                  float sysShift, float &metShiftPx, float &metShiftPy) const;
 
     void ShiftResponseMet(float metPx, float metPy, float genVPx, float genVPy,
                           float visVPx, float visVPy, int njets, float sysShift,
-                          float &metShiftPx, float &metShiftPy);
+                          float &metShiftPx, float &metShiftPy) const;
 
     void ShiftResolutionMet(float metPx, float metPy, float genVPx,
                             float genVPy, float visVPx, float visVPy, int njets,
                             float sysShift, float &metShiftPx,
-                            float &metShiftPy);
+                            float &metShiftPy) const;
 
     enum SysType { Response = 0, Resolution = 1, None = -1 };
     enum SysShift { Up = 0, Down = 1, Nominal = -1 };
@@ -40,15 +63,15 @@ class MetSystematic {
   private:
     void ComputeHadRecoilFromMet(float metX, float metY, float genVPx,
                                  float genVPy, float visVPx, float visVPy,
-                                 float &Hparal, float &Hperp);
+                                 float &Hparal, float &Hperp) const;
 
     void ComputeMetFromHadRecoil(float Hparal, float Hperp, float genVPx,
                                  float genVPy, float visVPx, float visVPy,
-                                 float &metX, float &metY);
+                                 float &metX, float &metY) const;
 
     int nJetBins;
     TString fileName;
-    TH1D *responseHist[3];
+    HistogramInterpolation responseHist[3];
     float sysUnc[2][3];
     // first index : type of uncertainty 0=response, 1=resolution
     // second index  : jet multiplicity bin (0,1,2);
@@ -1,16 +1,75 @@
 #include "RecoilCorrector.hxx"
+#include "../utility/CorrectionRegistry.hxx"
 #include "../utility/Logger.hxx"
+#include <algorithm>
+
+CumulativeDistribution::CumulativeDistribution(const TH1 &hist) {
+    const int nbins = hist.GetNbinsX();
+    _edges.resize(nbins + 1);
+    std::vector<double> cumulative(nbins + 1, 0.);
+    for (int bin = 1; bin <= nbins; ++bin) {
+        _edges[bin - 1] = hist.GetBinLowEdge(bin);
+        cumulative[bin] = cumulative[bin - 1] + hist.GetBinContent(bin);
+    }
+    _edges[nbins] = hist.GetXaxis()->GetXmax();
+    const double integral = cumulative[nbins];
+    if (integral == 0)
+        return;
+    for (auto &value : cumulative)
+        value /= integral;
+    _cumulative = std::move(cumulative);
+}
+
+double CumulativeDistribution::Probability(double x) const {
+    if (x <= _edges.front())
+        return 0.;
+    if (x >= _edges.back())
+        return 1.;
+    const std::size_t bin =
+        std::upper_bound(_edges.begin(), _edges.end(), x) - _edges.begin();
+    return _cumulative[bin - 1] + (_cumulative[bin] - _cumulative[bin - 1]) *
+                                      (x - _edges[bin - 1]) /
+                                      (_edges[bin] - _edges[bin - 1]);
+}
+
+double CumulativeDistribution::Quantile(double prob) const {
+    // same algorithm as TH1::GetQuantiles: find the last bin edge with an
+    // integral below prob, skipping empty bins, and interpolate linearly
+    const std::size_t nbins = _edges.size() - 1;
+    std::size_t bin =
+        std::upper_bound(_cumulative.begin(), _cumulative.begin() + nbins,
+                         prob) -
+        _cumulative.begin();
+    bin = bin > 0 ? bin - 1 : 0;
+    while (bin + 1 < nbins && _cumulative[bin + 1] == prob &&
+           _cumulative[bin + 2] == prob)
+        ++bin;
+    double quantile = _edges[bin];
+    const double dint = _cumulative[bin + 1] - _cumulative[bin];
+    if (dint > 0)
+        quantile +=
+            (_edges[bin + 1] - _edges[bin]) * (prob - _cumulative[bin]) / dint;
+    return quantile;
+}
 
-RecoilCorrector::RecoilCorrector(std::string filepath) {
-    fileName = filepath;
-    TFile *file = new TFile(fileName, "READ");
-    if (file->IsZombie()) {
+std::shared_ptr<const RecoilCorrector>
+RecoilCorrector::Load(const std::string &filepath) {
+    return CorrectionRegistry::get<const RecoilCorrector>(
+        filepath, "RecoilCorrector", "", [](TFile &file) {
+            return std::make_shared<const RecoilCorrector>(file);
+        });
+}
+
+RecoilCorrector::RecoilCorrector(TFile &file) {
+    // all information is copied out of the file, which is closed afterwards
+    fileName = file.GetName();
+    if (file.IsZombie()) {
         Logger::get("RecoilCorrector")
             ->debug("file {} is not found...   quitting ", fileName);
         exit(-1);
     }
 
-    TH1D *projH = (TH1D *)file->Get("projH");
+    TH1D *projH = (TH1D *)file.Get("projH");
     if (projH == NULL) {
         Logger::get("RecoilCorrector")
             ->debug("File should contain histogram with the name projH ");
@@ -32,7 +91,7 @@ RecoilCorrector::RecoilCorrector(std::string filepath) {
     Logger::get("RecoilCorrector")
         ->debug("Perpendicular component (U2) : {}", perpZStr);
 
-    TH1D *ZPtBinsH = (TH1D *)file->Get("ZPtBinsH");
+    TH1D *ZPtBinsH = (TH1D *)file.Get("ZPtBinsH");
     if (ZPtBinsH == NULL) {
         Logger::get("RecoilCorrector")
             ->debug("File should contain histogram with the name ZPtBinsH");
@@ -49,7 +108,7 @@ RecoilCorrector::RecoilCorrector(std::string filepath) {
             ZPtStr[i] = ZPtBinsH->GetXaxis()->GetBinLabel(i + 1);
     }
 
-    TH1D *nJetBinsH = (TH1D *)file->Get("nJetBinsH");
+    TH1D *nJetBinsH = (TH1D *)file.Get("nJetBinsH");
     if (nJetBinsH == NULL) {
         Logger::get("RecoilCorrector")
             ->debug("File should contain histogram with the name nJetBinsH");
@@ -62,7 +121,7 @@ RecoilCorrector::RecoilCorrector(std::string filepath) {
     for (int i = 0; i < nJetsBins; ++i) {
         nJetsStr[i] = nJetBinsH->GetXaxis()->GetBinLabel(i + 1);
     }
-    InitMEtWeights(file, perpZStr, paralZStr, nZPtBins, ZPtBins, ZPtStr,
+    InitMEtWeights(&file, perpZStr, paralZStr, nZPtBins, ZPtBins, ZPtStr,
                    nJetsBins, nJetsStr);
     _epsrel = 5e-4;
     _epsabs = 5e-4;
@@ -124,22 +183,25 @@ void RecoilCorrector::InitMEtWeights(
             TString binStrParalMC =
                 _paralZStr + "_" + _nJetsStr[jetBin] + _ZPtStr[ZPtBin] + "_mc";
 
-            _metZParalData[ZPtBin][jetBin] =
-                (TF1 *)_fileMet->Get(binStrParalData);
-            _metZPerpData[ZPtBin][jetBin] =
-                (TF1 *)_fileMet->Get(binStrPerpData);
-            _metZParalMC[ZPtBin][jetBin] = (TF1 *)_fileMet->Get(binStrParalMC);
-            _metZPerpMC[ZPtBin][jetBin] = (TF1 *)_fileMet->Get(binStrPerpMC);
+            // the functions are only needed to compute the ranges and moments
+            // below
+            std::unique_ptr<TF1> metZParalData(
+                (TF1 *)_fileMet->Get(binStrParalData));
+            std::unique_ptr<TF1> metZPerpData(
+                (TF1 *)_fileMet->Get(binStrPerpData));
+            std::unique_ptr<TF1> metZParalMC(
+                (TF1 *)_fileMet->Get(binStrParalMC));
+            std::unique_ptr<TF1> metZPerpMC((TF1 *)_fileMet->Get(binStrPerpMC));
 
             // checking functions
-            if (_metZParalData[ZPtBin][jetBin] == NULL) {
+            if (metZParalData == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Function with name {} is not found in file {} "
                             "quitting program...",
                             binStrParalData, fileName);
                 exit(-1);
             }
-            if (_metZPerpData[ZPtBin][jetBin] == NULL) {
+            if (metZPerpData == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Function with name {} is not found in file {} "
                             "quitting program...",
@@ -147,7 +209,7 @@ void RecoilCorrector::InitMEtWeights(
                 exit(-1);
             }
 
-            if (_metZParalMC[ZPtBin][jetBin] == NULL) {
+            if (metZParalMC == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Function with name {} is not found in file {} "
                             "quitting program...",
@@ -155,7 +217,7 @@ void RecoilCorrector::InitMEtWeights(
 
                 exit(-1);
             }
-            if (_metZPerpMC[ZPtBin][jetBin] == NULL) {
+            if (metZPerpMC == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Function with name {} is not found in file {} "
                             "quitting program...",
@@ -172,24 +234,22 @@ void RecoilCorrector::InitMEtWeights(
             TString binStrParalMCHist = _paralZStr + "_" + _nJetsStr[jetBin] +
                                         _ZPtStr[ZPtBin] + "_hist_mc";
 
-            _metZParalDataHist[ZPtBin][jetBin] =
+            TH1D *metZParalDataHist =
                 ((TH1D *)_fileMet->Get(binStrParalDataHist));
-            _metZPerpDataHist[ZPtBin][jetBin] =
+            TH1D *metZPerpDataHist =
                 ((TH1D *)_fileMet->Get(binStrPerpDataHist));
-            _metZParalMCHist[ZPtBin][jetBin] =
-                ((TH1D *)_fileMet->Get(binStrParalMCHist));
-            _metZPerpMCHist[ZPtBin][jetBin] =
-                ((TH1D *)_fileMet->Get(binStrPerpMCHist));
+            TH1D *metZParalMCHist = ((TH1D *)_fileMet->Get(binStrParalMCHist));
+            TH1D *metZPerpMCHist = ((TH1D *)_fileMet->Get(binStrPerpMCHist));
 
             // checking histograms
-            if (_metZParalDataHist[ZPtBin][jetBin] == NULL) {
+            if (metZParalDataHist == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Histogram with name {} is not found in file {}... "
                             "quitting program...",
                             binStrParalDataHist, fileName);
                 exit(-1);
             }
-            if (_metZPerpDataHist[ZPtBin][jetBin] == NULL) {
+            if (metZPerpDataHist == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Histogram with name {} is not found in file {}... "
                             "quitting program...",
@@ -197,14 +257,14 @@ void RecoilCorrector::InitMEtWeights(
                 exit(-1);
             }
 
-            if (_metZParalMCHist[ZPtBin][jetBin] == NULL) {
+            if (metZParalMCHist == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Histogram with name {} is not found in file {}... "
                             "quitting program...",
                             binStrParalMCHist, fileName);
                 exit(-1);
             }
-            if (_metZPerpMCHist[ZPtBin][jetBin] == NULL) {
+            if (metZPerpMCHist == NULL) {
                 Logger::get("RecoilCorrector")
                     ->debug("Histogram with name {} is not found in file {}... "
                             "quitting program...",
@@ -212,24 +272,35 @@ void RecoilCorrector::InitMEtWeights(
                 exit(-1);
             }
 
+            // the cumulative distributions replace the histograms in the
+            // event loop
+            _metZParalDataCDF[ZPtBin][jetBin] =
+                CumulativeDistribution(*metZParalDataHist);
+            _metZPerpDataCDF[ZPtBin][jetBin] =
+                CumulativeDistribution(*metZPerpDataHist);
+            _metZParalMCCDF[ZPtBin][jetBin] =
+                CumulativeDistribution(*metZParalMCHist);
+            _metZPerpMCCDF[ZPtBin][jetBin] =
+                CumulativeDistribution(*metZPerpMCHist);
+
             Logger::get("RecoilCorrector")
                 ->debug(" {} : {}", _ZPtStr[ZPtBin], _nJetsStr[jetBin]);
 
             double xminD, xmaxD;
 
-            _metZParalData[ZPtBin][jetBin]->GetRange(xminD, xmaxD);
+            metZParalData->GetRange(xminD, xmaxD);
             _xminMetZParalData[ZPtBin][jetBin] = float(xminD);
             _xmaxMetZParalData[ZPtBin][jetBin] = float(xmaxD);
 
-            _metZPerpData[ZPtBin][jetBin]->GetRange(xminD, xmaxD);
+            metZPerpData->GetRange(xminD, xmaxD);
             _xminMetZPerpData[ZPtBin][jetBin] = float(xminD);
             _xmaxMetZPerpData[ZPtBin][jetBin] = float(xmaxD);
 
-            _metZParalMC[ZPtBin][jetBin]->GetRange(xminD, xmaxD);
+            metZParalMC->GetRange(xminD, xmaxD);
             _xminMetZParalMC[ZPtBin][jetBin] = float(xminD);
             _xmaxMetZParalMC[ZPtBin][jetBin] = float(xmaxD);
 
-            _metZPerpMC[ZPtBin][jetBin]->GetRange(xminD, xmaxD);
+            metZPerpMC->GetRange(xminD, xmaxD);
             _xminMetZPerpMC[ZPtBin][jetBin] = float(xminD);
             _xmaxMetZPerpMC[ZPtBin][jetBin] = float(xmaxD);
 
@@ -248,30 +319,30 @@ void RecoilCorrector::InitMEtWeights(
                            _xmaxMetZPerpMC[ZPtBin][jetBin]);
 
             _meanMetZParalData[ZPtBin][jetBin] =
-                _metZParalData[ZPtBin][jetBin]->Mean(
+                metZParalData->Mean(
                     _xminMetZParalData[ZPtBin][jetBin],
                     _xmaxMetZParalData[ZPtBin][jetBin]);
             _rmsMetZParalData[ZPtBin][jetBin] =
-                TMath::Sqrt(_metZParalData[ZPtBin][jetBin]->CentralMoment(
+                TMath::Sqrt(metZParalData->CentralMoment(
                     2, _xminMetZParalData[ZPtBin][jetBin],
                     _xmaxMetZParalData[ZPtBin][jetBin]));
             _meanMetZPerpData[ZPtBin][jetBin] = 0;
             _rmsMetZPerpData[ZPtBin][jetBin] =
-                TMath::Sqrt(_metZPerpData[ZPtBin][jetBin]->CentralMoment(
+                TMath::Sqrt(metZPerpData->CentralMoment(
                     2, _xminMetZPerpData[ZPtBin][jetBin],
                     _xmaxMetZPerpData[ZPtBin][jetBin]));
 
             _meanMetZParalMC[ZPtBin][jetBin] =
-                _metZParalMC[ZPtBin][jetBin]->Mean(
+                metZParalMC->Mean(
                     _xminMetZParalMC[ZPtBin][jetBin],
                     _xmaxMetZParalMC[ZPtBin][jetBin]);
             _rmsMetZParalMC[ZPtBin][jetBin] =
-                TMath::Sqrt(_metZParalMC[ZPtBin][jetBin]->CentralMoment(
+                TMath::Sqrt(metZParalMC->CentralMoment(
                     2, _xminMetZParalMC[ZPtBin][jetBin],
                     _xmaxMetZParalMC[ZPtBin][jetBin]));
             _meanMetZPerpMC[ZPtBin][jetBin] = 0;
             _rmsMetZPerpMC[ZPtBin][jetBin] =
-                TMath::Sqrt(_metZPerpMC[ZPtBin][jetBin]->CentralMoment(
+                TMath::Sqrt(metZPerpMC->CentralMoment(
                     2, _xminMetZPerpMC[ZPtBin][jetBin],
                     _xmaxMetZPerpMC[ZPtBin][jetBin]));
         }
@@ -281,7 +352,7 @@ void RecoilCorrector::InitMEtWeights(
 void RecoilCorrector::CorrectWithHist(float MetPx, float MetPy, float genVPx,
                                       float genVPy, float visVPx, float visVPy,
                                       int njets, float &MetCorrPx,
-                                      float &MetCorrPy) {
+                                      float &MetCorrPy) const {
 
     // input parameters
     // MetPx, MetPy - missing transverse momentum
@@ -290,6 +361,9 @@ void RecoilCorrector::CorrectWithHist(float MetPx, float MetPy, float genVPx,
     // njets - number of jets
     // MetCorrPx, MetCorrPy - corrected missing transverse momentum
 
+    // called for every event, so resolve the logger only once
+    static const auto log = Logger::get("RecoilCorrector");
+
     Double_t Zpt = TMath::Sqrt(genVPx * genVPx + genVPy * genVPy);
 
     Double_t U1 = 0.0;
@@ -306,55 +380,40 @@ void RecoilCorrector::CorrectWithHist(float MetPx, float MetPy, float genVPx,
 
     int ZptBin = binNumber(Zpt, _ZPtBins);
 
-    TH1D *metZParalDataHist = ((TH1D *)_metZParalDataHist[ZptBin][njets]);
-    TH1D *metZPerpDataHist = ((TH1D *)_metZPerpDataHist[ZptBin][njets]);
+    const auto &metZParalDataCDF = _metZParalDataCDF[ZptBin][njets];
+    const auto &metZPerpDataCDF = _metZPerpDataCDF[ZptBin][njets];
 
-    TH1D *metZParalMCHist = ((TH1D *)_metZParalMCHist[ZptBin][njets]);
-    TH1D *metZPerpMCHist = ((TH1D *)_metZPerpMCHist[ZptBin][njets]);
+    const auto &metZParalMCCDF = _metZParalMCCDF[ZptBin][njets];
+    const auto &metZPerpMCCDF = _metZPerpMCCDF[ZptBin][njets];
 
     if (U1 > _range * _xminMetZParal[ZptBin][njets] &&
-        U1 < _range * _xmaxMetZParal[ZptBin][njets]) {
-
-        int nSumProb = 1;
-        double q[1];
-        double sumProb[1];
-
-        const int ibin = metZParalMCHist->FindBin(U1);
-        const double integralToNextBinEdge =
-            metZParalMCHist->GetBinContent(ibin) *
-            (metZParalMCHist->GetBinLowEdge(ibin + 1) - U1) /
-            metZParalMCHist->GetBinWidth(ibin);
-        sumProb[0] =
-            (metZParalMCHist->Integral(1, ibin) - integralToNextBinEdge) /
-            metZParalMCHist->Integral();
-        Logger::get("RecoilCorrector")
-            ->debug("U1 value: {} bin in MC hist: {}Integral: {}", U1,
-                    metZParalMCHist->FindBin(U1), sumProb[0]);
+        U1 < _range * _xmaxMetZParal[ZptBin][njets] &&
+        metZParalDataCDF.IsValid() && metZParalMCCDF.IsValid()) {
 
-        if (sumProb[0] < 0) {
-            Logger::get("RecoilCorrector")
-                ->debug("Warning ! ProbSum[0] = {}", sumProb[0]);
-            sumProb[0] = 1e-5;
+        double sumProb = metZParalMCCDF.Probability(U1);
+        SPDLOG_LOGGER_DEBUG(log, "U1 value: {} Integral: {}", U1, sumProb);
+
+        if (sumProb < 0) {
+            SPDLOG_LOGGER_DEBUG(log, "Warning ! ProbSum[0] = {}", sumProb);
+            sumProb = 1e-5;
         }
-        if (sumProb[0] > 1) {
-            Logger::get("RecoilCorrector")
-                ->debug("Warning ! ProbSum[0] = {}", sumProb[0]);
-            sumProb[0] = 1.0 - 1e-5;
+        if (sumProb > 1) {
+            SPDLOG_LOGGER_DEBUG(log, "Warning ! ProbSum[0] = {}", sumProb);
+            sumProb = 1.0 - 1e-5;
         }
-        metZParalDataHist->GetQuantiles(nSumProb, q, sumProb);
-        Logger::get("RecoilCorrector")
-            ->debug("Parallel component. Detemined probability: {} Projection "
-                    "value. old = {}",
-                    sumProb[0], U1);
-        float U1reco = float(q[0]);
+        SPDLOG_LOGGER_DEBUG(log,
+                            "Parallel component. Detemined probability: {} "
+                            "Projection value. old = {}",
+                            sumProb, U1);
+        float U1reco = float(metZParalDataCDF.Quantile(sumProb));
         U1 = U1reco;
-        Logger::get("RecoilCorrector")->debug(" new = {}", U1);
+        SPDLOG_LOGGER_DEBUG(log, " new = {}", U1);
 
     } else {
-        Logger::get("RecoilCorrector")
-            ->debug("Warning: parallel Met component out of histogram range: "
-                    "{}. Correction won't be applied",
-                    U1);
+        SPDLOG_LOGGER_DEBUG(log,
+                            "Warning: parallel Met component out of histogram "
+                            "range: {}. Correction won't be applied",
+                            U1);
         //  float U1reco = rescale(U1,
         //      		   _meanMetZParalData[ZptBin][njets],
         //      		   _meanMetZParalMC[ZptBin][njets],
@@ -363,49 +422,34 @@ void RecoilCorrector::CorrectWithHist(float MetPx, float MetPy, float genVPx,
         //  U1 = U1reco;
     }
 
-    if (std::abs(U2) < _range * _xmaxMetZPerp[ZptBin][njets]) {
-
-        int nSumProb = 1;
-        double q[1];
-        double sumProb[1];
+    if (std::abs(U2) < _range * _xmaxMetZPerp[ZptBin][njets] &&
+        metZPerpDataCDF.IsValid() && metZPerpMCCDF.IsValid()) {
 
-        Logger::get("RecoilCorrector")
-            ->debug("U2 value: {} bin in MC hist: {}", U2,
-                    metZParalMCHist->FindBin(U2));
         const double absU2 = std::abs(U2);
         const int signU2 = TMath::Sign(1.0, U2);
-        const int ibin = metZPerpMCHist->FindBin(absU2);
-        const double integralToNextBinEdge =
-            metZPerpMCHist->GetBinContent(ibin) *
-            (metZPerpMCHist->GetBinLowEdge(ibin + 1) - absU2) /
-            metZPerpMCHist->GetBinWidth(ibin);
-        sumProb[0] =
-            ((metZPerpMCHist->Integral(1, ibin) - integralToNextBinEdge) /
-             metZPerpMCHist->Integral());
-        if (sumProb[0] < 0) {
-            Logger::get("RecoilCorrector")
-                ->debug("Warning ! ProbSum[0] = {}", sumProb[0]);
-            sumProb[0] = 1e-5;
+        double sumProb = metZPerpMCCDF.Probability(absU2);
+        SPDLOG_LOGGER_DEBUG(log, "U2 value: {} Integral: {}", U2, sumProb);
+        if (sumProb < 0) {
+            SPDLOG_LOGGER_DEBUG(log, "Warning ! ProbSum[0] = {}", sumProb);
+            sumProb = 1e-5;
         }
-        if (sumProb[0] > 1) {
-            Logger::get("RecoilCorrector")
-                ->debug("Warning ! ProbSum[0] = {}", sumProb[0]);
-            sumProb[0] = 1.0 - 1e-5;
+        if (sumProb > 1) {
+            SPDLOG_LOGGER_DEBUG(log, "Warning ! ProbSum[0] = {}", sumProb);
+            sumProb = 1.0 - 1e-5;
         }
-        metZPerpDataHist->GetQuantiles(nSumProb, q, sumProb);
-        Logger::get("RecoilCorrector")
-            ->debug("Perpendicular component. Determined probability: {} "
-                    "Projection value. old = {}",
-                    sumProb[0], U2);
-        float U2reco = float(q[0]) * signU2;
+        SPDLOG_LOGGER_DEBUG(log,
+                            "Perpendicular component. Determined probability: "
+                            "{} Projection value. old = {}",
+                            sumProb, U2);
+        float U2reco = float(metZPerpDataCDF.Quantile(sumProb)) * signU2;
         U2 = U2reco;
-        Logger::get("RecoilCorrector")->debug(" new = {}", U2);
+        SPDLOG_LOGGER_DEBUG(log, " new = {}", U2);
 
     } else {
-        Logger::get("RecoilCorrector")
-            ->debug("Warning: perpendicular Met component out of histogram "
-                    "range: {}. Correction won't be applied",
-                    U2);
+        SPDLOG_LOGGER_DEBUG(log,
+                            "Warning: perpendicular Met component out of "
+                            "histogram range: {}. Correction won't be applied",
+                            U2);
         //  float U2reco = rescale(U2,
         //      		   _meanMetZPerpData[ZptBin][njets],
         //      		   _meanMetZPerpMC[ZptBin][njets],
@@ -422,7 +466,8 @@ void RecoilCorrector::CalculateU1U2FromMet(float metPx, float metPy,
                                            float genZPx, float genZPy,
                                            float diLepPx, float diLepPy,
                                            Double_t &U1, Double_t &U2,
-                                           Double_t &metU1, Double_t &metU2) {
+                                           Double_t &metU1,
+                                           Double_t &metU2) const {
 
     auto diLep = ROOT::Math::XYVector(diLepPx, diLepPy);
     auto genZ = ROOT::Math::XYVector(genZPx, genZPy);
@@ -443,7 +488,7 @@ void RecoilCorrector::CalculateU1U2FromMet(float metPx, float metPy,
 void RecoilCorrector::CalculateMetFromU1U2(float U1, float U2, float genZPx,
                                            float genZPy, float diLepPx,
                                            float diLepPy, float &metPx,
-                                           float &metPy) {
+                                           float &metPy) const {
 
     float hadRecPt = TMath::Sqrt(U1 * U1 + U2 * U2);
 
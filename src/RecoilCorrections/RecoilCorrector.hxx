@@ -12,16 +12,50 @@
 #include <TRandom.h>
 #include <TString.h>
 #include <assert.h>
+#include <memory>
+#include <vector>
+
+// Cumulative distribution of a histogram, computed once, so that the mapping
+// between values and probabilities does not need to access the histogram in
+// the event loop
+struct CumulativeDistribution {
+    CumulativeDistribution() = default;
+    CumulativeDistribution(const TH1 &hist);
+
+    // fraction of the histogram integral below x, interpolated linearly
+    // within the bin containing x
+    double Probability(double x) const;
+    // value below which the given fraction of the histogram integral lies,
+    // same as TH1::GetQuantiles
+    double Quantile(double prob) const;
+    // false for histograms without entries, for which no mapping exists
+    bool IsValid() const { return !_cumulative.empty(); }
 
+  private:
+    // bin edges, the first and last entry are the histogram range
+    std::vector<double> _edges;
+    // normalized integral up to each bin edge, from 0 to 1
+    std::vector<double> _cumulative;
+};
+
+// The corrector reads all required information from the file when it is
+// constructed and closes the file afterwards. It is not modified after the
+// construction, so a single instance can be used by all threads.
 class RecoilCorrector {
 
   public:
-    RecoilCorrector(std::string filepath);
+    RecoilCorrector(TFile &file);
     ~RecoilCorrector();
 
+    // Returns the corrector for the given file. A single instance per file is
+    // shared by all users, e.g. all systematic variations, via the
+    // CorrectionRegistry.
+    static std::shared_ptr<const RecoilCorrector>
+    Load(const std::string &filepath);
+
     void CorrectWithHist(float MetPx, float MetPy, float genZPx, float genZPy,
                          float diLepPx, float diLepPy, int njets,
-                         float &MetCorrPx, float &MetCorrPy);
+                         float &MetCorrPx, float &MetCorrPy) const;
 
   private:
     int binNumber(float x, const std::vector<float> bins) const {
@@ -31,7 +65,7 @@ class RecoilCorrector {
         return 0;
     }
 
-    int binNumber(float x, int nbins, const float *bins) {
+    int binNumber(float x, int nbins, const float *bins) const {
         int binN = 0;
         for (int iB = 0; iB < nbins; ++iB) {
             if (x >= bins[iB] && x < bins[iB + 1]) {
@@ -57,11 +91,11 @@ class RecoilCorrector {
     void CalculateU1U2FromMet(float MetPx, float MetPy, float genZPx,
                               float genZPy, float diLepPx, float diLepPy,
                               Double_t &U1, Double_t &U2, Double_t &metU1,
-                              Double_t &metU2);
+                              Double_t &metU2) const;
 
     void CalculateMetFromU1U2(float U1, float U2, float genZPx, float genZPy,
                               float diLepPx, float diLepPy, float &metPx,
-                              float &metPy);
+                              float &metPy) const;
 
     // float * _ZPtBins;
     std::vector<float> _ZPtBins;
@@ -74,15 +108,10 @@ class RecoilCorrector {
     int _nZPtBins;
     int _nJetsBins;
 
-    TF1 *_metZParalData[5][3];
-    TF1 *_metZPerpData[5][3];
-    TF1 *_metZParalMC[5][3];
-    TF1 *_metZPerpMC[5][3];
-
-    TH1D *_metZParalDataHist[5][3];
-    TH1D *_metZPerpDataHist[5][3];
-    TH1D *_metZParalMCHist[5][3];
-    TH1D *_metZPerpMCHist[5][3];
+    CumulativeDistribution _metZParalDataCDF[5][3];
+    CumulativeDistribution _metZPerpDataCDF[5][3];
+    CumulativeDistribution _metZParalMCCDF[5][3];
+    CumulativeDistribution _metZPerpMCCDF[5][3];
 
     float _meanMetZParalData[5][3];
     float _meanMetZParalMC[5][3];
@@ -3,6 +3,7 @@
 
 #include "ROOT/RDataFrame.hxx"
 #include "ROOT/RVec.hxx"
+#include "utility/FilterProfile.hxx"
 #include "utility/Logger.hxx"
 #include "utility/RooFunctorThreadsafe.hxx"
 #include "utility/utility.hxx"
@@ -44,10 +45,12 @@ auto FilterFlagsAny(auto &df, const std::string &filtername,
     utility::appendParameterPackToVector(FlagList, flags...);
     const auto nFlags = sizeof...(Flags);
     using namespace ROOT::VecOps;
-    return df.Filter(
-        ROOT::RDF::PassAsVec<nFlags, bool>(
-            [](const ROOT::RVec<bool> &flags) { return Any(flags); }),
-        FlagList, filtername);
+    return df.Filter(utility::FilterProfile::wrap(
+                         filtername, ROOT::RDF::PassAsVec<nFlags, bool>(
+                                         [](const ROOT::RVec<bool> &flags) {
+                                             return Any(flags);
+                                         })),
+                     FlagList, filtername);
 }
 
 /// This function defines a flag being true if either of the input flags is
@@ -86,12 +89,14 @@ template <typename T>
 auto FilterIntSelection(auto &df, const std::string &quantity,
                         const std::vector<T> &selection,
                         const std::string &filtername) {
-    return df.Filter(
-        [selection](const T probe) {
-            return std::find(selection.begin(), selection.end(), probe) !=
-                   selection.end();
-        },
-        {quantity}, filtername);
+    return df.Filter(utility::FilterProfile::wrap(
+                         filtername,
+                         [selection](const T probe) {
+                             return std::find(selection.begin(),
+                                              selection.end(),
+                                              probe) != selection.end();
+                         }),
+                     {quantity}, filtername);
 }
 
 /// Function to apply a maximal filter requirement to a quantity.
@@ -220,25 +225,60 @@ auto evaluateWorkspaceFunction(
     auto &df, const std::string &outputname,
     const std::shared_ptr<RooFunctorThreadsafe> &function,
     const Inputs &... inputs) {
-    Logger::get("evaluateWorkspaceFunction")
-        ->debug("Starting evaluation for {}", outputname);
-    auto getValue = [function](const ROOT::RVec<float> &values) {
-        Logger::get("evaluateWorkspaceFunction")
-            ->debug("Type: {} ", typeid(function).name());
-        std::vector<double> argvalues(values.begin(), values.end());
-        auto result = function->eval(argvalues.data());
-        Logger::get("evaluateWorkspaceFunction")->debug("result {}", result);
+    auto log = Logger::get("evaluateWorkspaceFunction");
+    log->debug("Starting evaluation for {}", outputname);
+    constexpr auto nInputs = sizeof...(Inputs);
+    auto getValue = [log,
+                     function](const std::array<double, nInputs> &values) {
+        SPDLOG_LOGGER_DEBUG(log, "Type: {} ", typeid(function).name());
+        auto result = function->eval(values.data());
+        SPDLOG_LOGGER_DEBUG(log, "result {}", result);
         return result;
     };
     std::vector<std::string> InputList;
     utility::appendParameterPackToVector(InputList, inputs...);
-    const auto nInputs = sizeof...(Inputs);
-    Logger::get("evaluateWorkspaceFunction")->debug("nInputs: {} ", nInputs);
+    log->debug("nInputs: {} ", nInputs);
     auto df1 = df.Define(
-        outputname, utility::PassAsVec<nInputs, float>(getValue), InputList);
+        outputname, utility::PassAsArray<nInputs, float>(getValue), InputList);
     // change back to ROOT::RDF as soon as fix is available
     return df1;
 }
+/// Function to evaluate a `RooWorkspace` function and put the output into a new
+/// dataframe column. This version uses one clone of the function per
+/// processing slot of the dataframe, so that the evaluation within the event
+/// loop does not need any locking.
+///
+/// \param[in] df The dataframe, where the new column should be added
+/// \param[in] outputname name of the new column
+/// \param[in] function A `RooFunctorPerSlot` pointer, which has to be loaded
+/// from a Roo Workspace with one functor per slot of the dataframe
+/// \param[in] inputs a paramter pack containing all column names needed to be
+/// able to evaluate the workspace function
+///
+/// \returns a dataframe with the newly defined output column
+template <class... Inputs>
+auto evaluateWorkspaceFunction(
+    auto &df, const std::string &outputname,
+    const std::shared_ptr<RooFunctorPerSlot> &function,
+    const Inputs &... inputs) {
+    auto log = Logger::get("evaluateWorkspaceFunction");
+    log->debug("Starting evaluation for {}", outputname);
+    constexpr auto nInputs = sizeof...(Inputs);
+    // the inputs are passed on the stack, so no memory is allocated per event
+    auto getValue = [log, function](unsigned int slot,
+                                    const std::array<double, nInputs> &values) {
+        auto result = function->eval(slot, values);
+        SPDLOG_LOGGER_DEBUG(log, "result {}", result);
+        return result;
+    };
+    std::vector<std::string> InputList;
+    utility::appendParameterPackToVector(InputList, inputs...);
+    log->debug("nInputs: {} ", nInputs);
+    auto df1 = df.DefineSlot(
+        outputname, utility::PassAsArrayWithSlot<nInputs, float>(getValue),
+        InputList);
+    return df1;
+}
 /// Helper function to recursively define columns for each entry of a vector
 /// quantity
 ///
@@ -2,6 +2,7 @@
 #include "TFile.h"
 #include "TGraphErrors.h"
 #include "basefunctions.hxx"
+#include "utility/CorrectionRegistry.hxx"
 #include "utility/Logger.hxx"
 #include "utility/ggF_qcd_uncertainty_2017.cxx"
 #include "utility/qq2Hqq_uncert_scheme.cpp"
@@ -25,31 +26,27 @@ auto ggHNLLOWeights(auto &df, const std::string &weight_name,
                     const std::string &rootfilename,
                     const std::string &generator, const std::string &htxs_pth,
                     const std::string &htxs_njets) {
-    TGraphErrors *WeightsGraphs[4];
-    TFile rootFile(rootfilename.c_str(), "READ");
+    std::array<std::shared_ptr<const TGraphErrors>, 4> WeightsGraphs;
+    std::string graphprefix;
     if (generator == "powheg") {
-        WeightsGraphs[0] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_powheg_0jet");
-        WeightsGraphs[1] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_powheg_1jet");
-        WeightsGraphs[2] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_powheg_2jet");
-        WeightsGraphs[3] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_powheg_3jet");
+        graphprefix = "gr_NNLOPSratio_pt_powheg_";
     } else if (generator == "amcatnlo") {
-        WeightsGraphs[0] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_mcatnlo_0jet");
-        WeightsGraphs[1] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_mcatnlo_1jet");
-        WeightsGraphs[2] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_mcatnlo_2jet");
-        WeightsGraphs[3] =
-            (TGraphErrors *)rootFile.Get("gr_NNLOPSratio_pt_mcatnlo_3jet");
+        graphprefix = "gr_NNLOPSratio_pt_mcatnlo_";
     } else
         Logger::get("ggHNLLOWeights")
             ->critical("WARNING: Invalid ggH generator configured. "
                        "ggHNNLOWeights cannot be determined!");
-    rootFile.Close();
+    if (!graphprefix.empty()) {
+        for (int njets = 0; njets < 4; ++njets) {
+            const std::string graphname =
+                graphprefix + std::to_string(njets) + "jet";
+            WeightsGraphs[njets] = CorrectionRegistry::get<const TGraphErrors>(
+                rootfilename, graphname, "", [&graphname](TFile &file) {
+                    return std::shared_ptr<const TGraphErrors>(
+                        (TGraphErrors *)file.Get(graphname.c_str()));
+                });
+        }
+    }
     const Float_t cutoff[4] = {125.0, 625.0, 800.0, 925.0};
     auto readout_lambda = [WeightsGraphs, cutoff](const Float_t &htxs_pth,
                                                   const UChar_t &htxs_njets) {
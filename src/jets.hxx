@@ -1,8 +1,9 @@
+#include "JetCorrections/JetEnergyCorrector.cxx"
 #include "ROOT/RDataFrame.hxx"
 #include "ROOT/RVec.hxx"
-#include "TRandom3.h"
 #include "basefunctions.hxx"
 #include "utility/Logger.hxx"
+#include "utility/Variations.hxx"
 #include <Math/Vector3D.h>
 #include <Math/Vector4D.h>
 #include <Math/VectorUtil.h>
@@ -23,31 +24,28 @@ auto VetoOverlappingJets(auto &df, const std::string &output_col,
                          const std::string &jet_eta, const std::string &jet_phi,
                          const std::string &p4_1, const std::string &p4_2,
                          const float &deltaRmin) {
+    auto log = Logger::get("VetoOverlappingJets");
     auto df1 = df.Define(
         output_col,
-        [deltaRmin](const ROOT::RVec<float> &jet_eta,
-                    const ROOT::RVec<float> &jet_phi,
-                    const ROOT::Math::PtEtaPhiMVector &p4_1,
-                    ROOT::Math::PtEtaPhiMVector &p4_2) {
-            Logger::get("VetoOverlappingJets")->debug("Checking jets");
+        [log, deltaRmin](const ROOT::RVec<float> &jet_eta,
+                         const ROOT::RVec<float> &jet_phi,
+                         const ROOT::Math::PtEtaPhiMVector &p4_1,
+                         ROOT::Math::PtEtaPhiMVector &p4_2) {
+            SPDLOG_LOGGER_DEBUG(log, "Checking jets");
             ROOT::RVec<int> mask(jet_eta.size(), 1);
             for (std::size_t idx = 0; idx < mask.size(); ++idx) {
                 ROOT::Math::RhoEtaPhiVectorF jet(0, jet_eta.at(idx),
                                                  jet_phi.at(idx));
-                Logger::get("VetoOverlappingJets")
-                    ->debug("Jet:  Eta: {} Phi: {} ", jet.Eta(), jet.Phi());
-                Logger::get("VetoOverlappingJets")
-                    ->debug("Letpon 1 {}:  Eta: {} Phi: {}, Pt{}", p4_1,
-                            p4_1.Eta(), p4_1.Phi(), p4_1.Pt());
-                Logger::get("VetoOverlappingJets")
-                    ->debug("Lepton 2 {}:  Eta: {} Phi: {}, Pt{}", p4_2,
-                            p4_2.Eta(), p4_2.Phi(), p4_2.Pt());
+                SPDLOG_LOGGER_DEBUG(log, "Jet:  Eta: {} Phi: {} ", jet.Eta(),
+                                    jet.Phi());
+                SPDLOG_LOGGER_DEBUG(log, "Letpon 1 {}:  Eta: {} Phi: {}, Pt{}",
+                                    p4_1, p4_1.Eta(), p4_1.Phi(), p4_1.Pt());
+                SPDLOG_LOGGER_DEBUG(log, "Lepton 2 {}:  Eta: {} Phi: {}, Pt{}",
+                                    p4_2, p4_2.Eta(), p4_2.Phi(), p4_2.Pt());
                 auto deltaR_1 = ROOT::Math::VectorUtil::DeltaR(jet, p4_1);
                 auto deltaR_2 = ROOT::Math::VectorUtil::DeltaR(jet, p4_2);
-                Logger::get("VetoOverlappingJets")
-                    ->debug("DeltaR 1 {}", deltaR_1);
-                Logger::get("VetoOverlappingJets")
-                    ->debug("DeltaR 2 {}", deltaR_2);
+                SPDLOG_LOGGER_DEBUG(log, "DeltaR 1 {}", deltaR_1);
+                SPDLOG_LOGGER_DEBUG(log, "DeltaR 2 {}", deltaR_2);
                 mask[idx] = (deltaR_1 > deltaRmin && deltaR_2 > deltaRmin);
             }
             return mask;
@@ -66,24 +64,25 @@ auto VetoOverlappingJets(auto &df, const std::string &output_col,
 /// \return a dataframe containing a list of jet indices sorted by pt
 auto OrderJetsByPt(auto &df, const std::string &output_col,
                    const std::string &jet_pt, const std::string &jetmask) {
+    auto log = Logger::get("OrderJetsByPt");
     auto df1 = df.Define(
         output_col,
-        [](const ROOT::RVec<int> &jetmask, const ROOT::RVec<float> &jet_pt) {
-            Logger::get("OrderJetsByPt")->debug("Ordering good jets by pt");
-            Logger::get("OrderJetsByPt")->debug("Jetpt before {}", jet_pt);
-            Logger::get("OrderJetsByPt")->debug("Mask {}", jetmask);
+        [log](const ROOT::RVec<int> &jetmask, const ROOT::RVec<float> &jet_pt) {
+            SPDLOG_LOGGER_DEBUG(log, "Ordering good jets by pt");
+            SPDLOG_LOGGER_DEBUG(log, "Jetpt before {}", jet_pt);
+            SPDLOG_LOGGER_DEBUG(log, "Mask {}", jetmask);
             auto good_jets_pt =
                 ROOT::VecOps::Where(jetmask > 0, jet_pt, (float)0.);
-            Logger::get("OrderJetsByPt")->debug("Jetpt after {}", good_jets_pt);
+            SPDLOG_LOGGER_DEBUG(log, "Jetpt after {}", good_jets_pt);
             // we have to convert the result into an RVec of ints since argsort
             // gives back an unsigned long vector
             auto temp =
                 ROOT::VecOps::Argsort(ROOT::VecOps::Nonzero(good_jets_pt));
-            Logger::get("OrderJetsByPt")->debug("jet Indices {}", temp);
+            SPDLOG_LOGGER_DEBUG(log, "jet Indices {}", temp);
             ROOT::RVec<int> result(temp.size());
             std::transform(temp.begin(), temp.end(), result.begin(),
                            [](unsigned long int x) { return (int)x; });
-            Logger::get("OrderJetsByPt")->debug("jet Indices int {}", result);
+            SPDLOG_LOGGER_DEBUG(log, "jet Indices int {}", result);
             return result;
         },
         {jetmask, jet_pt});
@@ -108,7 +107,13 @@ auto CutID(auto &df, const std::string &maskname, const std::string &nameID,
     return df1;
 }
 
-/// Function to shift and smear jet pt
+/// Function to shift and smear jet pt. The jet energy scale uncertainties,
+/// the jet energy resolution and its scale factors are read from the JetMET
+/// text payloads, see JetEnergyCorrector. The jets are shifted by the
+/// uncertainty of the given sources and afterwards smeared with the hybrid
+/// method: jets with a matching gen jet are scaled with respect to the gen jet,
+/// all other jets are smeared stochastically. If no payloads are given, the
+/// jet pts are not modified.
 ///
 /// \param[in] df the input dataframe
 /// \param[out] corrected_jet_pt the name of the shifted and smeared jet pts
@@ -119,10 +124,16 @@ auto CutID(auto &df, const std::string &maskname, const std::string &nameID,
 /// \param[in] gen_jet_eta name of the gen jet etas
 /// \param[in] gen_jet_phi name of the gen jet phis
 /// \param[in] rho name of the pileup density
+/// \param[in] jec_uncertainty_file path to the file with the JEC uncertainty
+/// sources, an empty string disables the energy scale shifts
 /// \param[in] energy_shift_sources vector of JEC unc source names to be applied
 /// in one group
 /// \param[in] energy_shift_state parameter to control jet energy
 /// scale shift: 0 - nominal; 1 - Up; -1 - Down
+/// \param[in] jer_resolution_file path to the file with the jet pt resolution,
+/// an empty string disables the smearing
+/// \param[in] jer_scalefactor_file path to the file with the jet energy
+/// resolution scale factors, an empty string disables the smearing
 /// \param[in] energy_reso_shift parameter to control jet energy resolution
 /// shift: 0 - nominal; 1 - Up; -1 - Down
 ///
@@ -132,118 +143,31 @@ auto JetPtCorrection(auto &df, const std::string &corrected_jet_pt,
                      const std::string &jet_phi, const std::string &gen_jet_pt,
                      const std::string &gen_jet_eta,
                      const std::string &gen_jet_phi, const std::string &rho,
+                     const std::string &jec_uncertainty_file,
                      const std::vector<std::string> &energy_shift_sources,
                      const int &energy_shift_state,
+                     const std::string &jer_resolution_file,
+                     const std::string &jer_scalefactor_file,
                      const int &energy_reso_shift) {
-    // configure readout tool here and capture it in lambda below
-    // dummy lambdas for now:
-    std::vector<std::function<float(float, float)>> JetEnergyShiftSources;
-    for (const auto &source : energy_shift_sources) {
-        JetEnergyShiftSources.push_back(
-            [&](float x1, float x2) { return 0.05; });
-    }
-    auto JetEnergyResolution = [](const float pt, const float eta,
-                                  const float rho) {
-        return 1.0 / std::sqrt(pt);
-    };
-    auto JetEnergyResolutionSF = [](const float pt, const float eta,
-                                    const int jer_shift) {
-        return 1.02 + 0.01 * jer_shift;
-    };
-    // lambda run with dataframe
+    auto log = Logger::get("JetEnergyResolution");
+    // the engine is shared by the nominal correction and all its shifts
+    auto corrector = JetEnergyCorrector::Load(
+        jec_uncertainty_file, jer_resolution_file, jer_scalefactor_file);
+    const auto variation = corrector->MakeVariation(
+        energy_shift_sources, energy_shift_state, energy_reso_shift);
     auto JetEnergyCorrectionLambda =
-        [JetEnergyShiftSources, JetEnergyResolution, JetEnergyResolutionSF,
-         energy_shift_state, energy_reso_shift](
-            const ROOT::RVec<float> &pt_values,
-            const ROOT::RVec<float> &eta_values,
-            const ROOT::RVec<float> &phi_values,
-            const ROOT::RVec<float> &gen_pt_values,
-            const ROOT::RVec<float> &gen_eta_values,
-            const ROOT::RVec<float> &gen_phi_values, const float &rho_value) {
-            ROOT::RVec<float> pt_values_corrected;
-            for (int i = 0; i < pt_values.size(); i++) {
-                float pt_scale_shift = 0.0;
-                // jet energy scale should already be corrected
-                // apply uncertainty shifts related to the energy scale
-                if (energy_shift_state != 0.0) {
-                    // Single source keeps sign
-                    if (JetEnergyShiftSources.size() == 1) {
-                        pt_scale_shift = energy_shift_state *
-                                         JetEnergyShiftSources.at(0)(
-                                             pt_values.at(i), eta_values.at(i));
-                    } else {
-                        for (const auto &source : JetEnergyShiftSources) {
-                            pt_scale_shift += std::pow(
-                                source(pt_values.at(i), eta_values.at(i)), 2.0);
-                        }
-                        pt_scale_shift =
-                            energy_shift_state * std::sqrt(pt_scale_shift);
-                    }
-                }
-                pt_values_corrected.push_back(pt_values.at(i) + pt_scale_shift);
-                Logger::get("JetEnergyResolution")
-                    ->debug("JE scale: Shifting jet pt from {} to {} ",
-                            pt_values.at(i), pt_values_corrected.at(i));
-                // apply jet energy smearing - hybrid method
-                float reso = JetEnergyResolution(pt_values_corrected.at(i),
-                                                 eta_values.at(i), rho_value);
-                float resoSF =
-                    JetEnergyResolutionSF(pt_values_corrected.at(i),
-                                          eta_values.at(i), energy_reso_shift);
-                // search for gen jet
-                ROOT::Math::RhoEtaPhiVectorF jet(pt_values_corrected.at(i),
-                                                 eta_values.at(i),
-                                                 phi_values.at(i));
-                float genjetpt = -1.0;
-                Logger::get("JetEnergyResolution")
-                    ->debug("Going to smear jet:  Eta: {} Phi: {} ", jet.Eta(),
-                            jet.Phi());
-                double min_dR = std::numeric_limits<double>::infinity();
-                for (int j = 0; j < gen_pt_values.size(); j++) {
-                    ROOT::Math::RhoEtaPhiVectorF genjet(gen_pt_values.at(j),
-                                                        gen_eta_values.at(j),
-                                                        gen_phi_values.at(j));
-                    Logger::get("JetEnergyResolution")
-                        ->debug("Checking gen Jet:  Eta: {} Phi:", genjet.Eta(),
-                                genjet.Phi());
-                    auto deltaR =
-                        ROOT::Math::VectorUtil::DeltaR(jet, genjet) < 0.4;
-                    if (deltaR > min_dR)
-                        continue;
-                    if (deltaR < 0.4 &&
-                        std::abs(pt_values_corrected.at(i) -
-                                 gen_pt_values.at(j)) >
-                            3.0 * reso * pt_values_corrected.at(i)) {
-                        min_dR = deltaR;
-                        genjetpt = gen_pt_values.at(j);
-                    }
-                }
-                if (genjetpt > 0.0) { // matched gen jet
-                    Logger::get("JetEnergyResolution")
-                        ->debug("Found gen jet for hybrid smearing method");
-                    pt_values_corrected.at(i) +=
-                        (resoSF - 1.0) * (pt_values_corrected.at(i) - genjetpt);
-                } else {
-                    Logger::get("JetEnergyResolution")
-                        ->debug(
-                            "No gen jet found. Applying stochastic smearing.");
-                    TRandom3 randm = TRandom3(
-                        static_cast<int>((eta_values.at(i) + 5) * 1000) * 1000 +
-                        static_cast<int>((phi_values.at(i) + 4) * 1000) +
-                        10000);
-                    double shift =
-                        randm.Gaus(0, reso) *
-                        std::sqrt(std::max(resoSF * resoSF - 1, 0.0f));
-                    pt_values_corrected.at(i) *= std::max(0.0, 1.0 + shift);
-                }
-                Logger::get("JetEnergyResolution")
-                    ->debug("Shifting jet pt from {} to {} ",
-                            pt_values.at(i) + pt_scale_shift,
-                            pt_values_corrected.at(i));
-                // if (pt_values_corrected.at(i)>15.0), this
-                // correction should be propagated to MET
-                // (requirement for type I corrections)
-            }
+        [log, corrector, variation](const ROOT::RVec<float> &pt_values,
+                                    const ROOT::RVec<float> &eta_values,
+                                    const ROOT::RVec<float> &phi_values,
+                                    const ROOT::RVec<float> &gen_pt_values,
+                                    const ROOT::RVec<float> &gen_eta_values,
+                                    const ROOT::RVec<float> &gen_phi_values,
+                                    const float &rho_value) {
+            auto pt_values_corrected = corrector->Correct(
+                pt_values, eta_values, phi_values, gen_pt_values,
+                gen_eta_values, gen_phi_values, rho_value, variation);
+            SPDLOG_LOGGER_DEBUG(log, "Shifting jet pt from {} to {} ",
+                                pt_values, pt_values_corrected);
             return pt_values_corrected;
         };
     auto df1 = df.Define(
@@ -252,6 +176,82 @@ auto JetPtCorrection(auto &df, const std::string &corrected_jet_pt,
     return df1;
 }
 
+/// Function to shift and smear jet pt for several variations in a single
+/// step, see physicsobject::jet::JetPtCorrection. The gen jet matching and the
+/// inputs are shared by all variations. The corrected jet pts of all
+/// variations are stored in a single column, see utility::Variations, the
+/// first variation is the nominal one.
+///
+/// \param[in] df the input dataframe
+/// \param[out] corrected_jet_pt name of the shifted and smeared jet pts
+/// \param[in] jet_pt name of the input jet pts
+/// \param[in] jet_eta name of the jet etas
+/// \param[in] jet_phi name of the jet phis
+/// \param[in] gen_jet_pt name of the gen jet pts
+/// \param[in] gen_jet_eta name of the gen jet etas
+/// \param[in] gen_jet_phi name of the gen jet phis
+/// \param[in] rho name of the pileup density
+/// \param[in] jec_uncertainty_file path to the file with the JEC uncertainty
+/// sources
+/// \param[in] energy_shift_sources the JEC unc source names of each variation
+/// \param[in] energy_shift_states the jet energy scale shift of each variation
+/// \param[in] jer_resolution_file path to the file with the jet pt resolution
+/// \param[in] jer_scalefactor_file path to the file with the jet energy
+/// resolution scale factors
+/// \param[in] energy_reso_shifts the jet energy resolution shift of each
+/// variation
+///
+/// \return a dataframe containing the modified jet pts of all variations
+auto JetPtCorrectionVariations(
+    auto &df, const std::string &corrected_jet_pt, const std::string &jet_pt,
+    const std::string &jet_eta, const std::string &jet_phi,
+    const std::string &gen_jet_pt, const std::string &gen_jet_eta,
+    const std::string &gen_jet_phi, const std::string &rho,
+    const std::string &jec_uncertainty_file,
+    const std::vector<std::vector<std::string>> &energy_shift_sources,
+    const std::vector<int> &energy_shift_states,
+    const std::string &jer_resolution_file,
+    const std::string &jer_scalefactor_file,
+    const std::vector<int> &energy_reso_shifts) {
+    auto log = Logger::get("JetEnergyResolution");
+    const std::size_t nVariations = energy_shift_sources.size();
+    if (energy_shift_states.size() != nVariations ||
+        energy_reso_shifts.size() != nVariations) {
+        log->critical("Inconsistent number of jet energy variations, "
+                      "expected {}",
+                      nVariations);
+        throw std::runtime_error("Inconsistent number of variations");
+    }
+    auto corrector = JetEnergyCorrector::Load(
+        jec_uncertainty_file, jer_resolution_file, jer_scalefactor_file);
+    std::vector<JetEnergyCorrector::Variation> variations;
+    for (std::size_t i = 0; i < nVariations; ++i) {
+        variations.push_back(corrector->MakeVariation(
+            energy_shift_sources[i], energy_shift_states[i],
+            energy_reso_shifts[i]));
+    }
+    auto JetEnergyCorrectionLambda =
+        [corrector, variations](const ROOT::RVec<float> &pt_values,
+                                const ROOT::RVec<float> &eta_values,
+                                const ROOT::RVec<float> &phi_values,
+                                const ROOT::RVec<float> &gen_pt_values,
+                                const ROOT::RVec<float> &gen_eta_values,
+                                const ROOT::RVec<float> &gen_phi_values,
+                                const float &rho_value) {
+            auto corrected = corrector->Correct(
+                pt_values, eta_values, phi_values, gen_pt_values,
+                gen_eta_values, gen_phi_values, rho_value, variations);
+            utility::Variations<ROOT::RVec<float>> result;
+            result.values.reserve(corrected.size());
+            for (auto &values : corrected)
+                result.values.push_back(std::move(values));
+            return result;
+        };
+    return utility::DefineVariations<ROOT::RVec<float>>(
+        df, corrected_jet_pt, JetEnergyCorrectionLambda,
+        {jet_pt, jet_eta, jet_phi, gen_jet_pt, gen_jet_eta, gen_jet_phi, rho});
+}
+
 /// Function to select jets passing a ID requirement, using
 /// basefunctions::FilterMin
 ///
@@ -283,10 +283,11 @@ namespace jet {
 /// \return a dataframe containing a list of jet indices sorted by pt
 auto NumberOfJets(auto &df, const std::string &outputname,
                   const std::string &jetcollection) {
+    auto log = Logger::get("NumberOfJets");
     return df.Define(outputname,
-                     [](const ROOT::RVec<int> &jetcollection) {
-                         Logger::get("NumberOfJets")
-                             ->debug("NJets {}", jetcollection.size());
+                     [log](const ROOT::RVec<int> &jetcollection) {
+                         SPDLOG_LOGGER_DEBUG(log, "NJets {}",
+                                             jetcollection.size());
                          return (int)jetcollection.size();
                      },
                      {jetcollection});
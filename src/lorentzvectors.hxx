@@ -1,11 +1,38 @@
+#include "ROOT/RVec.hxx"
 #include "defaults.hxx"
 #include "utility/Logger.hxx"
 #include <Math/Vector4D.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 /// Namespace used for lorentzvector operations
 
 namespace lorentzvectors {
 
+/// Function to look up the index of a particle in the pair vector. The index
+/// is checked against the sizes of all given particle quantity vectors, so
+/// that no exceptions are needed for events without a valid particle.
+///
+/// \param pair the pair vector
+/// \param position the position of the particle in the pair vector
+/// \param columns the particle quantity vectors, which are read at the index
+///
+/// \returns the index of the particle, or -1 if it is not found
+template <class... Columns>
+inline int particleIndex(const ROOT::RVec<int> &pair, const int position,
+                         const Columns &... columns) {
+    if (position < 0 || position >= int(pair.size()))
+        return -1;
+    const int index = pair[position];
+    if (index < 0 || ((index >= int(columns.size())) || ...))
+        return -1;
+    return index;
+}
+
 /// Function to build the lorentzvector from the pt, eta, phi and mass of a
 /// particle. This utilizes the [PtEtaPhiMVector from
 /// ROOT](https://root.cern/doc/master/namespaceROOT_1_1Math.html#a6cea5921731c7ac99dea921fb188df31)
@@ -26,41 +53,103 @@ namespace lorentzvectors {
 /// \returns a new dataframe, which contains the new lorentz vector
 auto buildparticle(auto &df, const std::vector<std::string> &quantities,
                    const std::string &outputname, const int &position) {
+    auto log = Logger::get("lorentzvectors");
     auto df1 = df.Define(
         outputname,
-        [position](const ROOT::RVec<int> &pair, const ROOT::RVec<float> &pts,
-                   const ROOT::RVec<float> &etas, const ROOT::RVec<float> &phis,
-                   const ROOT::RVec<float> &masses) {
+        [log, position](
+            const ROOT::RVec<int> &pair, const ROOT::RVec<float> &pts,
+            const ROOT::RVec<float> &etas, const ROOT::RVec<float> &phis,
+            const ROOT::RVec<float> &masses) {
             // the index of the particle is stored in the pair vector
-            ROOT::Math::PtEtaPhiMVector p4;
-            Logger::get("lorentzvectors")
-                ->debug("starting to build 4vectors !");
-            try {
-                const int index = pair.at(position);
-                Logger::get("lorentzvectors")->debug("pair {}", pair);
-                Logger::get("lorentzvectors")->debug("pts {}", pts);
-                Logger::get("lorentzvectors")->debug("etas {}", etas);
-                Logger::get("lorentzvectors")->debug("phis {}", phis);
-                Logger::get("lorentzvectors")->debug("masses {}", masses);
-                Logger::get("lorentzvectors")->debug("Index {}", index);
-
-                p4 = ROOT::Math::PtEtaPhiMVector(pts.at(index), etas.at(index),
-                                                 phis.at(index),
-                                                 masses.at(index));
-            } catch (const std::out_of_range &e) {
-                p4 = ROOT::Math::PtEtaPhiMVector(default_float, default_float,
-                                                 default_float, default_float);
-                Logger::get("lorentzvectors")
-                    ->debug("Index not found, retuning dummy vector !");
+            SPDLOG_LOGGER_DEBUG(log, "starting to build 4vectors !");
+            SPDLOG_LOGGER_DEBUG(log, "pair {}", pair);
+            SPDLOG_LOGGER_DEBUG(log, "pts {}", pts);
+            SPDLOG_LOGGER_DEBUG(log, "etas {}", etas);
+            SPDLOG_LOGGER_DEBUG(log, "phis {}", phis);
+            SPDLOG_LOGGER_DEBUG(log, "masses {}", masses);
+            const int index =
+                particleIndex(pair, position, pts, etas, phis, masses);
+            SPDLOG_LOGGER_DEBUG(log, "Index {}", index);
+            if (index < 0) {
+                SPDLOG_LOGGER_DEBUG(
+                    log, "Index not found, retuning dummy vector !");
+                return ROOT::Math::PtEtaPhiMVector(
+                    default_float, default_float, default_float,
+                    default_float);
             }
-            Logger::get("lorentzvectors")
-                ->debug("P4 - Particle {} : {}", position, p4);
+            auto p4 = ROOT::Math::PtEtaPhiMVector(
+                pts[index], etas[index], phis[index], masses[index]);
+            SPDLOG_LOGGER_DEBUG(log, "P4 - Particle {} : {}", position, p4);
             return p4;
         },
         quantities);
     return df1;
 }
 
+/// Function to build the cartesian components of the lorentzvector of a
+/// particle, in contrast to lorentzvectors::buildparticle stored as four
+/// float columns. Quantities combining several particles, like the ones in
+/// quantities::cartesian, can then be calculated by adding up the components
+/// directly, without converting the vectors from and to the pt, eta, phi, mass
+/// representation for every sum.
+///
+/// The particle is looked up and all four components are calculated in a
+/// single step, and stored together in one column. The component columns
+/// only copy their entry of this column.
+///
+/// If the particle is not found, all components are set to `default_float`.
+/// As the energy of a particle is never negative, this is detected by the
+/// functions in quantities::cartesian.
+///
+/// \param df The input dataframe
+/// \param quantities the names of the pair, pt, eta, phi and mass columns,
+/// see lorentzvectors::buildparticle
+/// \param position The position in the pair vector, which is used to store the
+/// index of the particle in the particle quantity vectors.
+/// \param componentsname The name of the column containing all four components
+/// \param pxname The name of the px column
+/// \param pyname The name of the py column
+/// \param pzname The name of the pz column
+/// \param energyname The name of the energy column
+///
+/// \returns a new dataframe, which contains the new columns
+auto buildCartesian(auto &df, const std::vector<std::string> &quantities,
+                    const int &position, const std::string &componentsname,
+                    const std::string &pxname, const std::string &pyname,
+                    const std::string &pzname, const std::string &energyname) {
+    using Components = std::array<float, 4>;
+    auto df1 = df.Define(
+        componentsname,
+        [position](const ROOT::RVec<int> &pair, const ROOT::RVec<float> &pts,
+                   const ROOT::RVec<float> &etas,
+                   const ROOT::RVec<float> &phis,
+                   const ROOT::RVec<float> &masses) {
+            const int index =
+                particleIndex(pair, position, pts, etas, phis, masses);
+            if (index < 0)
+                return Components{default_float, default_float, default_float,
+                                  default_float};
+            const double pt = pts[index];
+            const double phi = phis[index];
+            const double mass = masses[index];
+            const double pz = pt * std::sinh(etas[index]);
+            // negative masses are treated as in ROOT::Math::PtEtaPhiM4D
+            const double energy = std::sqrt(
+                std::max(0., pt * pt + pz * pz + mass * std::abs(mass)));
+            return Components{float(pt * std::cos(phi)),
+                              float(pt * std::sin(phi)), float(pz),
+                              float(energy)};
+        },
+        quantities);
+    auto component = [](const std::size_t i) {
+        return [i](const Components &components) { return components[i]; };
+    };
+    auto df2 = df1.Define(pxname, component(0), {componentsname});
+    auto df3 = df2.Define(pyname, component(1), {componentsname});
+    auto df4 = df3.Define(pzname, component(2), {componentsname});
+    return df4.Define(energyname, component(3), {componentsname});
+}
+
 /**
  * @brief Function used to construct a 4-vector for a pair particle.
  *
@@ -106,6 +195,36 @@ auto buildMet(auto df, const std::string &met_pt, const std::string &met_phi,
     return df.Define(outputname, construct_metvector, {met_pt, met_phi});
 }
 
+/**
+ * @brief Function used to store the transverse components of the missing
+ * transverse energy lorentz vector as float columns, to be used together with
+ * lorentzvectors::buildCartesian.
+ *
+ * @param df the input dataframe
+ * @param met name of the column containing the missing transverse energy
+ * lorentz vector
+ * @param outputnames names of the two new columns, px and py in this order
+ * @return a new df, containing the new columns
+ */
+auto buildMetCartesian(auto &df, const std::string &met,
+                       const std::vector<std::string> &outputnames) {
+    if (outputnames.size() != 2) {
+        Logger::get("lorentzvectors")
+            ->critical("buildMetCartesian requires two output columns (px, "
+                       "py), but {} are given",
+                       outputnames.size());
+        throw std::runtime_error("Bad number of output columns");
+    }
+    auto df1 = df.Define(
+        outputnames[0],
+        [](const ROOT::Math::PtEtaPhiMVector &p4) { return (float)p4.Px(); },
+        {met});
+    return df1.Define(
+        outputnames[1],
+        [](const ROOT::Math::PtEtaPhiMVector &p4) { return (float)p4.Py(); },
+        {met});
+}
+
 /// namespace used for mutau lorentzvectors
 namespace mutau {
 auto build(auto df, const std::string &pairname,
@@ -57,14 +57,15 @@ auto calculateGenBosonVector(auto df, const std::string &genparticle_pt,
                              const std::string &genparticle_status,
                              const std::string &genparticle_statusflag,
                              const std::string outputname) {
+    auto log = Logger::get("getGenMet");
     auto calculateGenBosonVector =
-        [](const ROOT::RVec<float> &genparticle_pt,
-           const ROOT::RVec<float> &genparticle_eta,
-           const ROOT::RVec<float> &genparticle_phi,
-           const ROOT::RVec<float> &genparticle_mass,
-           const ROOT::RVec<int> &genparticle_id,
-           const ROOT::RVec<int> &genparticle_status,
-           const ROOT::RVec<int> &genparticle_statusflag) {
+        [log](const ROOT::RVec<float> &genparticle_pt,
+              const ROOT::RVec<float> &genparticle_eta,
+              const ROOT::RVec<float> &genparticle_phi,
+              const ROOT::RVec<float> &genparticle_mass,
+              const ROOT::RVec<int> &genparticle_id,
+              const ROOT::RVec<int> &genparticle_status,
+              const ROOT::RVec<int> &genparticle_statusflag) {
             ROOT::Math::PtEtaPhiMVector genBoson;
             ROOT::Math::PtEtaPhiMVector visgenBoson;
             ROOT::Math::PtEtaPhiMVector genparticle;
@@ -76,14 +77,14 @@ auto calculateGenBosonVector(auto df, const std::string &genparticle_pt,
                 // from statusflag and 1 from status
                 // 2. if it is isDirectHardProcessTauDecayProduct --> bit 10
                 // in statusflag
-                Logger::get("getGenMet")
-                    ->debug("Checking particle {} ", genparticle_id.at(index));
+                SPDLOG_LOGGER_DEBUG(log, "Checking particle {} ",
+                                    genparticle_id.at(index));
                 if ((abs(genparticle_id.at(index)) >= 11 &&
                      abs(genparticle_id.at(index)) <= 16 &&
                      (IntBits(genparticle_status.at(index)).test(8)) &&
                      genparticle_status.at(index) == 1) ||
                     (IntBits(genparticle_status.at(index)).test(10))) {
-                    Logger::get("getGenMet")->debug("Adding to gen p*");
+                    SPDLOG_LOGGER_DEBUG(log, "Adding to gen p*");
                     genparticle = ROOT::Math::PtEtaPhiMVector(
                         genparticle_pt.at(index), genparticle_eta.at(index),
                         genparticle_phi.at(index), genparticle_mass.at(index));
@@ -93,7 +94,7 @@ auto calculateGenBosonVector(auto df, const std::string &genparticle_pt,
                     if (abs(genparticle_id.at(index)) != 12 &&
                         abs(genparticle_id.at(index)) != 14 &&
                         abs(genparticle_id.at(index)) != 16) {
-                        Logger::get("getGenMet")->debug("Adding to vis p*");
+                        SPDLOG_LOGGER_DEBUG(log, "Adding to vis p*");
                         visgenBoson = visgenBoson + genparticle;
                     }
                 }
@@ -139,9 +140,10 @@ auto propagateLeptonsToMet(auto df, const std::string &met,
                            const std::string &p4_1, const std::string &p4_2,
                            const std::string &outputname,
                            bool apply_propagation) {
-    auto scaleMet = [](const ROOT::Math::PtEtaPhiMVector &met,
-                       const ROOT::Math::PtEtaPhiMVector &uncorrected_object,
-                       const ROOT::Math::PtEtaPhiMVector &corrected_object) {
+    auto log = Logger::get("propagateLeptonsToMet");
+    auto scaleMet = [log](const ROOT::Math::PtEtaPhiMVector &met,
+                          const ROOT::Math::PtEtaPhiMVector &uncorrected_object,
+                          const ROOT::Math::PtEtaPhiMVector &corrected_object) {
         // We propagate the lepton corrections to the Met by scaling the x
         // and y component of the Met according to the correction of the
         // lepton Recalculate Met with corrected lepton energies :
@@ -154,33 +156,30 @@ auto propagateLeptonsToMet(auto df, const std::string &met,
         float corr_y = uncorrected_object.Py() - corrected_object.Py();
         float MetX = met.Px() + corr_x;
         float MetY = met.Py() + corr_y;
-        Logger::get("propagateLeptonsToMet")->debug("corr_x {}", corr_x);
-        Logger::get("propagateLeptonsToMet")->debug("corr_y {}", corr_y);
-        Logger::get("propagateLeptonsToMet")->debug("MetX {}", MetX);
-        Logger::get("propagateLeptonsToMet")->debug("MetY {}", MetY);
+        SPDLOG_LOGGER_DEBUG(log, "corr_x {}", corr_x);
+        SPDLOG_LOGGER_DEBUG(log, "corr_y {}", corr_y);
+        SPDLOG_LOGGER_DEBUG(log, "MetX {}", MetX);
+        SPDLOG_LOGGER_DEBUG(log, "MetY {}", MetY);
         ROOT::Math::PtEtaPhiMVector corrected_met;
         corrected_met.SetPxPyPzE(MetX, MetY, 0,
                                  std::sqrt(MetX * MetX + MetY * MetY));
-        Logger::get("propagateLeptonsToMet")
-            ->debug("corrected_object pt - {}", corrected_object.Pt());
-        Logger::get("propagateLeptonsToMet")
-            ->debug("uncorrected_object pt - {}", uncorrected_object.Pt());
-        Logger::get("propagateLeptonsToMet")->debug("old met {}", met.Pt());
-        Logger::get("propagateLeptonsToMet")
-            ->debug("corrected met {}", corrected_met.Pt());
+        SPDLOG_LOGGER_DEBUG(log, "corrected_object pt - {}",
+                            corrected_object.Pt());
+        SPDLOG_LOGGER_DEBUG(log, "uncorrected_object pt - {}",
+                            uncorrected_object.Pt());
+        SPDLOG_LOGGER_DEBUG(log, "old met {}", met.Pt());
+        SPDLOG_LOGGER_DEBUG(log, "corrected met {}", corrected_met.Pt());
         return corrected_met;
     };
     if (apply_propagation) {
         // first correct for the first lepton, store the met in an
         // intermediate column
-        Logger::get("propagateLeptonsToMet")
-            ->debug("Setting up correction for first lepton {}", p4_1);
+        log->debug("Setting up correction for first lepton {}", p4_1);
         auto df1 = df.Define(outputname + "_intermediate", scaleMet,
                              {met, p4_1_uncorrected, p4_1});
         // after the second lepton correction, the correct output column is
         // used
-        Logger::get("propagateLeptonsToMet")
-            ->debug("Setting up correction for second lepton {}", p4_2);
+        log->debug("Setting up correction for second lepton {}", p4_2);
         return df1.Define(
             outputname, scaleMet,
             {outputname + "_intermediate", p4_2_uncorrected, p4_2});
@@ -233,15 +232,17 @@ auto propagateJetsToMet(auto df, const std::string &met,
                         float min_jet_pt) {
     // propagate jet corrections to met, since we can have an arbitrary
     // amount of jets, this has to be done per event
-    auto scaleMet = [min_jet_pt](const ROOT::Math::PtEtaPhiMVector &met,
-                                 const ROOT::RVec<float> &jet_pt_corrected,
-                                 const ROOT::RVec<float> &jet_eta_corrected,
-                                 const ROOT::RVec<float> &jet_phi_corrected,
-                                 const ROOT::RVec<float> &jet_mass_corrected,
-                                 const ROOT::RVec<float> &jet_pt,
-                                 const ROOT::RVec<float> &jet_eta,
-                                 const ROOT::RVec<float> &jet_phi,
-                                 const ROOT::RVec<float> &jet_mass) {
+    auto log = Logger::get("propagateJetsToMet");
+    auto scaleMet = [log, min_jet_pt](
+                        const ROOT::Math::PtEtaPhiMVector &met,
+                        const ROOT::RVec<float> &jet_pt_corrected,
+                        const ROOT::RVec<float> &jet_eta_corrected,
+                        const ROOT::RVec<float> &jet_phi_corrected,
+                        const ROOT::RVec<float> &jet_mass_corrected,
+                        const ROOT::RVec<float> &jet_pt,
+                        const ROOT::RVec<float> &jet_eta,
+                        const ROOT::RVec<float> &jet_phi,
+                        const ROOT::RVec<float> &jet_mass) {
         ROOT::Math::PtEtaPhiMVector corrected_met;
         ROOT::Math::PtEtaPhiMVector uncorrected_jet;
         ROOT::Math::PtEtaPhiMVector corrected_jet;
@@ -266,15 +267,14 @@ auto propagateJetsToMet(auto df, const std::string &met,
         }
         float MetX = met.Px() + corr_x;
         float MetY = met.Py() + corr_y;
-        Logger::get("propagateJetsToMet")->debug("corr_x {}", corr_x);
-        Logger::get("propagateJetsToMet")->debug("corr_y {}", corr_y);
-        Logger::get("propagateJetsToMet")->debug("MetX {}", MetX);
-        Logger::get("propagateJetsToMet")->debug("MetY {}", MetY);
+        SPDLOG_LOGGER_DEBUG(log, "corr_x {}", corr_x);
+        SPDLOG_LOGGER_DEBUG(log, "corr_y {}", corr_y);
+        SPDLOG_LOGGER_DEBUG(log, "MetX {}", MetX);
+        SPDLOG_LOGGER_DEBUG(log, "MetY {}", MetY);
         corrected_met.SetPxPyPzE(MetX, MetY, 0,
                                  std::sqrt(MetX * MetX + MetY * MetY));
-        Logger::get("propagateJetsToMet")->debug("old met {}", met.Pt());
-        Logger::get("propagateJetsToMet")
-            ->debug("corrected met {}", corrected_met.Pt());
+        SPDLOG_LOGGER_DEBUG(log, "old met {}", met.Pt());
+        SPDLOG_LOGGER_DEBUG(log, "corrected met {}", corrected_met.Pt());
         return corrected_met;
     };
     if (apply_propagation) {
@@ -321,9 +321,11 @@ auto applyRecoilCorrections(
     bool applyRecoilCorrections, bool resolution, bool response, bool shiftUp,
     bool shiftDown, bool isWjets) {
     if (applyRecoilCorrections) {
-        Logger::get("RecoilCorrections")->debug("Will run recoil corrections");
-        const auto corrector = new RecoilCorrector(recoilfile);
-        const auto systematics = new MetSystematic(systematicsfile);
+        auto log = Logger::get("RecoilCorrections");
+        log->debug("Will run recoil corrections");
+        // the corrections are shared by all variations using the same files
+        const auto corrector = RecoilCorrector::Load(recoilfile);
+        const auto systematics = MetSystematic::Load(systematicsfile);
         auto shiftType = MetSystematic::SysShift::Nominal;
         if (shiftUp) {
             shiftType = MetSystematic::SysShift::Up;
@@ -336,8 +338,8 @@ auto applyRecoilCorrections(
         } else if (resolution) {
             sysType = MetSystematic::SysType::Resolution;
         }
-        auto RecoilCorrections = [sysType, systematics, shiftType, corrector,
-                                  isWjets](
+        auto RecoilCorrections = [log, sysType, systematics, shiftType,
+                                  corrector, isWjets](
                                      ROOT::Math::PtEtaPhiMVector &met,
                                      std::pair<ROOT::Math::PtEtaPhiMVector,
                                                ROOT::Math::PtEtaPhiMVector>
@@ -360,26 +362,24 @@ auto applyRecoilCorrections(
             float genPy = genboson.first.Py();  // generator Z(W) py
             float visPx = genboson.second.Px(); // visible (generator) Z(W) px
             float visPy = genboson.second.Py(); // visible (generator) Z(W) py
-            Logger::get("RecoilCorrections")->debug("Corrector Inputs");
-            Logger::get("RecoilCorrections")->debug("nJets30 {} ", nJets30);
-            Logger::get("RecoilCorrections")->debug("genPx {} ", genPx);
-            Logger::get("RecoilCorrections")->debug("genPy {} ", genPy);
-            Logger::get("RecoilCorrections")->debug("visPx {} ", visPx);
-            Logger::get("RecoilCorrections")->debug("visPy {} ", visPy);
-            Logger::get("RecoilCorrections")->debug("MetX {} ", MetX);
-            Logger::get("RecoilCorrections")->debug("MetY {} ", MetY);
-            Logger::get("RecoilCorrections")
-                ->debug("correctedMetX {} ", correctedMetX);
-            Logger::get("RecoilCorrections")
-                ->debug("correctedMetY {} ", correctedMetY);
-            Logger::get("RecoilCorrections")->debug("old met {} ", met.Pt());
+            SPDLOG_LOGGER_DEBUG(log, "Corrector Inputs");
+            SPDLOG_LOGGER_DEBUG(log, "nJets30 {} ", nJets30);
+            SPDLOG_LOGGER_DEBUG(log, "genPx {} ", genPx);
+            SPDLOG_LOGGER_DEBUG(log, "genPy {} ", genPy);
+            SPDLOG_LOGGER_DEBUG(log, "visPx {} ", visPx);
+            SPDLOG_LOGGER_DEBUG(log, "visPy {} ", visPy);
+            SPDLOG_LOGGER_DEBUG(log, "MetX {} ", MetX);
+            SPDLOG_LOGGER_DEBUG(log, "MetY {} ", MetY);
+            SPDLOG_LOGGER_DEBUG(log, "correctedMetX {} ", correctedMetX);
+            SPDLOG_LOGGER_DEBUG(log, "correctedMetY {} ", correctedMetY);
+            SPDLOG_LOGGER_DEBUG(log, "old met {} ", met.Pt());
             corrector->CorrectWithHist(MetX, MetY, genPx, genPy, visPx, visPy,
                                        nJets30, correctedMetX, correctedMetY);
             // only apply shifts if the correpsonding variables are set
             if (sysType != MetSystematic::SysType::None &&
                 shiftType != MetSystematic::SysShift::Nominal) {
-                Logger::get("RecoilCorrections")
-                    ->debug(" apply systematics {} {}", sysType, shiftType);
+                SPDLOG_LOGGER_DEBUG(log, " apply systematics {} {}", sysType,
+                                    shiftType);
                 systematics->ApplyMetSystematic(
                     correctedMetX, correctedMetY, genPx, genPy, visPx, visPy,
                     nJets30, sysType, shiftType, correctedMetX, correctedMetY);
@@ -387,8 +387,8 @@ auto applyRecoilCorrections(
             corrected_met.SetPxPyPzE(correctedMetX, correctedMetY, 0,
                                      std::sqrt(correctedMetX * correctedMetX +
                                                correctedMetY * correctedMetY));
-            Logger::get("RecoilCorrections")
-                ->debug("shifted and corrected met {} ", corrected_met.Pt());
+            SPDLOG_LOGGER_DEBUG(log, "shifted and corrected met {} ",
+                                corrected_met.Pt());
 
             return corrected_met;
         };
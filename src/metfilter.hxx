@@ -1,3 +1,5 @@
+#include "utility/FilterProfile.hxx"
+
 /// The namespace that contains the metfilter function.
 
 namespace metfilter {
@@ -11,8 +13,9 @@ namespace metfilter {
 /// \returns a dataframe with the filter applied
 auto ApplyMetFilter(auto &df, const std::string &flagname,
                     const std::string &filtername) {
-    return df.Filter([](const bool flag) { return flag; }, {flagname},
-                     filtername);
+    return df.Filter(utility::FilterProfile::wrap(
+                         filtername, [](const bool flag) { return flag; }),
+                     {flagname}, filtername);
 }
 
 } // namespace metfilter
\ No newline at end of file
@@ -4,8 +4,7 @@
 #include "utility/Logger.hxx"
 #include "utility/utility.hxx"
 
-// TODO general: enable proper logging at COMPILE (!!!) time.
-//               use namespaces appropriately in functions, and use "using" to
+// TODO general: use namespaces appropriately in functions, and use "using" to
 //               make types shorter.
 //
 // Examples: void foo() {
@@ -34,15 +33,15 @@ auto buildgenpair(auto &df, const std::string &recopair,
                   const std::string &genindex_particle1,
                   const std::string &genindex_particle2,
                   const std::string &genpair) {
-    auto getGenPair = [](const ROOT::RVec<int> &recopair,
-                         const ROOT::RVec<int> &genindex_particle1,
-                         const ROOT::RVec<int> &genindex_particle2) {
+    auto log = Logger::get("buildgenpair");
+    auto getGenPair = [log](const ROOT::RVec<int> &recopair,
+                            const ROOT::RVec<int> &genindex_particle1,
+                            const ROOT::RVec<int> &genindex_particle2) {
         ROOT::RVec<int> genpair = {-1, -1};
-        Logger::get("buildgenpair")->debug("existing DiTauPair: {}", recopair);
+        SPDLOG_LOGGER_DEBUG(log, "existing DiTauPair: {}", recopair);
         genpair[0] = genindex_particle1.at(recopair.at(0), -1);
         genpair[1] = genindex_particle2.at(recopair.at(1), -1);
-        Logger::get("buildgenpair")
-            ->debug("matching GenDiTauPair: {}", genpair);
+        SPDLOG_LOGGER_DEBUG(log, "matching GenDiTauPair: {}", genpair);
         return genpair;
     };
     return df.Define(genpair, getGenPair,
@@ -90,52 +89,50 @@ auto compareForPairs(const ROOT::RVec<float> &lep1pt,
                      const ROOT::RVec<float> &lep1iso,
                      const ROOT::RVec<float> &lep2pt,
                      const ROOT::RVec<float> &lep2iso) {
+    // the comparator is built for every event, so resolve the logger only once
+    static const auto log = Logger::get("PairSelectionCompare");
     return [lep1pt, lep1iso, lep2pt, lep2iso](auto value_next,
                                               auto value_previous) {
-        Logger::get("PairSelectionCompare")->debug("lep1 Pt: {}", lep1pt);
-        Logger::get("PairSelectionCompare")->debug("lep1 Iso: {}", lep1iso);
-        Logger::get("PairSelectionCompare")->debug("lep2 Pt: {}", lep2pt);
-        Logger::get("PairSelectionCompare")->debug("lep2 Iso: {}", lep2iso);
-
-        Logger::get("PairSelectionCompare")
-            ->debug("Next pair: {}, {}", std::to_string(value_next.first),
-                    std::to_string(value_next.second));
-        Logger::get("PairSelectionCompare")
-            ->debug("Previous pair: {}, {}",
-                    std::to_string(value_previous.first),
-                    std::to_string(value_previous.second));
+        SPDLOG_LOGGER_DEBUG(log, "lep1 Pt: {}", lep1pt);
+        SPDLOG_LOGGER_DEBUG(log, "lep1 Iso: {}", lep1iso);
+        SPDLOG_LOGGER_DEBUG(log, "lep2 Pt: {}", lep2pt);
+        SPDLOG_LOGGER_DEBUG(log, "lep2 Iso: {}", lep2iso);
+
+        SPDLOG_LOGGER_DEBUG(log, "Next pair: {}, {}", value_next.first,
+                            value_next.second);
+        SPDLOG_LOGGER_DEBUG(log, "Previous pair: {}, {}", value_previous.first,
+                            value_previous.second);
         const auto i1_next = value_next.first;
-        const auto i1_previous = value_previous.second;
+        const auto i1_previous = value_previous.first;
 
         // start with lep1 isolation
         const auto iso1_next = lep1iso.at(i1_next);
         const auto iso1_previous = lep1iso.at(i1_previous);
-        Logger::get("PairSelectionCompare")
-            ->debug("Isolations: {}, {}", iso1_next, iso1_previous);
+        SPDLOG_LOGGER_DEBUG(log, "Isolations: {}, {}", iso1_next,
+                            iso1_previous);
         if (not utility::ApproxEqual(iso1_next, iso1_previous)) {
             return iso1_next > iso1_previous;
         } else {
             // if too similar, compare lep1 pt
-            Logger::get("PairSelectionCompare")
-                ->debug("Isolation lep 1 too similar, taking pt");
+            SPDLOG_LOGGER_DEBUG(log, "Isolation lep 1 too similar, taking pt");
             const auto pt1_next = lep1pt.at(i1_next);
             const auto pt1_previous = lep1pt.at(i1_previous);
             if (not utility::ApproxEqual(pt1_next, pt1_previous)) {
                 return pt1_next > pt1_previous;
             } else {
                 // if too similar, compare lep2 iso
-                const auto i2_next = value_next.first;
+                const auto i2_next = value_next.second;
                 const auto i2_previous = value_previous.second;
-                Logger::get("PairSelectionCompare")
-                    ->debug("Pt lep 1 too similar, taking lep2 iso");
+                SPDLOG_LOGGER_DEBUG(log,
+                                    "Pt lep 1 too similar, taking lep2 iso");
                 const auto iso2_next = lep2iso.at(i2_next);
                 const auto iso2_previous = lep2iso.at(i2_previous);
                 if (not utility::ApproxEqual(iso2_next, iso2_previous)) {
                     return iso2_next > iso2_previous;
                 } else {
                     // if too similar, compare lep2 pt
-                    Logger::get("PairSelectionCompare")
-                        ->debug("Isolation lep 2 too similar, taking pt");
+                    SPDLOG_LOGGER_DEBUG(
+                        log, "Isolation lep 2 too similar, taking pt");
                     const auto pt2_next = lep2pt.at(i2_next);
                     const auto pt2_previous = lep2pt.at(i2_previous);
                     return pt2_next > pt2_previous;
@@ -145,96 +142,140 @@ auto compareForPairs(const ROOT::RVec<float> &lep1pt,
     };
 }
 
+/// Channels, for which a pair selection is available
+enum class Channel { MT, ET, TT, EM };
+
+/// Properties of the two particles of a pair in the given channel. For
+/// electrons and muons, a smaller isolation is better, while for taus the
+/// isolation is the raw value of the tau ID, where a larger value is better.
+/// In the tautau channel, both particles are taken from the same collection.
+template <Channel channel> struct PairTraits;
+
+template <> struct PairTraits<Channel::MT> {
+    static constexpr bool lowerIso1IsBetter = true;
+    static constexpr bool lowerIso2IsBetter = false;
+    static constexpr bool sameCollection = false;
+};
+template <> struct PairTraits<Channel::ET> {
+    static constexpr bool lowerIso1IsBetter = true;
+    static constexpr bool lowerIso2IsBetter = false;
+    static constexpr bool sameCollection = false;
+};
+template <> struct PairTraits<Channel::TT> {
+    static constexpr bool lowerIso1IsBetter = false;
+    static constexpr bool lowerIso2IsBetter = false;
+    static constexpr bool sameCollection = true;
+};
+template <> struct PairTraits<Channel::EM> {
+    static constexpr bool lowerIso1IsBetter = true;
+    static constexpr bool lowerIso2IsBetter = true;
+    static constexpr bool sameCollection = false;
+};
+
+/// Function to check, if a candidate pair is preferred over the current best
+/// pair. The criteria are the same as in pairselection::compareForPairs:
+/// -# Isolation of the first particle
+/// -# pt of the first particle
+/// -# Isolation of the second particle
+/// -# pt of the second particle
+///
+/// If two quantities are the same within an epsilon of 1e-5, the next
+/// criterion is applied.
+///
+/// \param candidate1 index of the first particle of the candidate pair
+/// \param candidate2 index of the second particle of the candidate pair
+/// \param best1 index of the first particle of the current best pair
+/// \param best2 index of the second particle of the current best pair
+/// \param pt1 pts of the first particle collection
+/// \param iso1 isolations of the first particle collection
+/// \param pt2 pts of the second particle collection
+/// \param iso2 isolations of the second particle collection
+///
+/// \returns true if the candidate pair is better than the current best pair
+template <Channel channel>
+bool isBetterPair(const std::size_t candidate1, const std::size_t candidate2,
+                  const std::size_t best1, const std::size_t best2,
+                  const ROOT::RVec<float> &pt1, const ROOT::RVec<float> &iso1,
+                  const ROOT::RVec<float> &pt2,
+                  const ROOT::RVec<float> &iso2) {
+    using Traits = PairTraits<channel>;
+    if (not utility::ApproxEqual(iso1[candidate1], iso1[best1])) {
+        if constexpr (Traits::lowerIso1IsBetter)
+            return iso1[candidate1] < iso1[best1];
+        else
+            return iso1[candidate1] > iso1[best1];
+    }
+    if (not utility::ApproxEqual(pt1[candidate1], pt1[best1]))
+        return pt1[candidate1] > pt1[best1];
+    if (not utility::ApproxEqual(iso2[candidate2], iso2[best2])) {
+        if constexpr (Traits::lowerIso2IsBetter)
+            return iso2[candidate2] < iso2[best2];
+        else
+            return iso2[candidate2] > iso2[best2];
+    }
+    return pt2[candidate2] > pt2[best2];
+}
+
+/// Implementation of the pair selection algorithm for the given channel. All
+/// combinations of particles passing the masks are checked in a single pass
+/// and the best pair, according to pairselection::isBetterPair, is kept. If
+/// several pairs are equally good, the first one is selected. The masks are
+/// constructed using the functions from the physicsobject namespace (e.g.
+/// physicsobject::CutPt). The inputs of the second particle are given before
+/// the ones of the first particle.
+///
+/// \returns an `ROOT::RVec<int>` with two values, the index of the first and
+/// of the second particle. If no pair is found, both indices are -1.
+template <Channel channel> auto PairSelectionAlgo() {
+    auto log = Logger::get("PairSelection");
+    log->debug("Setting up algorithm");
+    return [log](const ROOT::RVec<float> &pt2, const ROOT::RVec<float> &iso2,
+                 const ROOT::RVec<float> &pt1, const ROOT::RVec<float> &iso1,
+                 const ROOT::RVec<int> &mask2, const ROOT::RVec<int> &mask1) {
+        int best1 = -1;
+        int best2 = -1;
+        for (std::size_t i1 = 0; i1 < mask1.size(); ++i1) {
+            if (!mask1[i1])
+                continue;
+            for (std::size_t i2 = 0; i2 < mask2.size(); ++i2) {
+                if (!mask2[i2])
+                    continue;
+                if constexpr (PairTraits<channel>::sameCollection) {
+                    if (i1 == i2)
+                        continue;
+                }
+                if (best1 < 0 || isBetterPair<channel>(i1, i2, best1, best2,
+                                                       pt1, iso1, pt2, iso2)) {
+                    best1 = i1;
+                    best2 = i2;
+                }
+            }
+        }
+        SPDLOG_LOGGER_DEBUG(log, "Selected original pair indices: {} , {}",
+                            best1, best2);
+        return ROOT::RVec<int>{best1, best2};
+    };
+}
+
 /// namespace for pairs in the MuTau channel
 namespace mutau {
 
-/// Implementation of the pair selection algorithm. First, only events that
-/// contain at least one goodMuon and one goodTau are considered. Events contain
-/// at least one good muon and one good tau, if the taumask and the mounmask
-/// both have nonzero elements. These masks are constructed using the functions
-/// from the physicsobject namespace (e.g. physicsobject::CutPt).
+/// Implementation of the pair selection algorithm for the MuTau channel, see
+/// pairselection::PairSelectionAlgo. The inputs are the tau pt and isolation,
+/// the muon pt and isolation and the tau and muon masks.
 ///
 /// \returns an `ROOT::RVec<int>` with two values, the first one beeing the muon
 /// index and the second one beeing the tau index.
 auto PairSelectionAlgo() {
-    Logger::get("PairSelection")->debug("Setting up algorithm");
-    return [](const ROOT::RVec<float> &taupt, const ROOT::RVec<float> &tauiso,
-              const ROOT::RVec<float> &muonpt, const ROOT::RVec<float> &muoniso,
-              const ROOT::RVec<int> &taumask, const ROOT::RVec<int> &muonmask) {
-        ROOT::RVec<int> selected_pair; // first entry is the muon index, second
-                                       // entry is the tau index
-        const auto original_tau_indices = ROOT::VecOps::Nonzero(taumask);
-        const auto original_muon_indices = ROOT::VecOps::Nonzero(muonmask);
-
-        if (original_tau_indices.size() == 0 or
-            original_muon_indices.size() == 0) {
-            selected_pair = {-1, -1};
-            return selected_pair;
-        }
-        Logger::get("PairSelection")
-            ->debug("Running algorithm on good taus and muons");
-
-        const auto selected_taupt =
-            ROOT::VecOps::Take(taupt, original_tau_indices);
-        const auto selected_tauiso =
-            ROOT::VecOps::Take(tauiso, original_tau_indices);
-        const auto selected_muonpt =
-            ROOT::VecOps::Take(muonpt, original_muon_indices);
-        const auto selected_muoniso =
-            ROOT::VecOps::Take(muoniso, original_muon_indices);
-
-        const auto pair_indices = ROOT::VecOps::Combinations(
-            selected_muonpt, selected_taupt); // Gives indices of mu-tau pair
-        Logger::get("PairSelection")->debug("Pairs: ", pair_indices);
-
-        // TODO, try out std::pair<UInt_t>, or std::tuple<UInt_t>.
-        const auto pairs = ROOT::VecOps::Construct<std::pair<UInt_t, UInt_t>>(
-            pair_indices[0], pair_indices[1]);
-        Logger::get("PairSelection")->debug("Pairs size: {}", pairs.size());
-        Logger::get("PairSelection")
-            ->debug("Constituents pair 0: {} {}", pairs[0].first,
-                    pairs[0].second);
-
-        if (pairs.size() > 1) {
-            Logger::get("PairSelection")
-                ->debug("Constituents pair 1: {} {}",
-                        std::to_string(pairs[1].first),
-                        std::to_string(pairs[1].second));
-        }
-
-        const auto sorted_pairs = ROOT::VecOps::Sort(
-            pairs, compareForPairs(selected_muonpt, -1. * selected_muoniso,
-                                   selected_taupt, selected_tauiso));
-
-        Logger::get("PairSelection")->debug("TauPt: {}", selected_taupt);
-        Logger::get("PairSelection")->debug("TauIso: {}", selected_tauiso);
-        Logger::get("PairSelection")->debug("MuonPt: {}", selected_muonpt);
-        Logger::get("PairSelection")->debug("MuonIso: {}", selected_muoniso);
-
-        const auto selected_mu_index = sorted_pairs[0].first;
-        const auto selected_tau_index = sorted_pairs[0].second;
-        selected_pair = {
-            static_cast<int>(original_muon_indices[selected_mu_index]),
-            static_cast<int>(original_tau_indices[selected_tau_index])};
-        Logger::get("PairSelection")
-            ->debug("Selected original pair indices: mu = {} , tau = {}",
-                    selected_pair[0], selected_pair[1]);
-        Logger::get("PairSelection")
-            ->debug("MuonPt = {} , TauPt = {} ",
-                    muonpt[static_cast<UInt_t>(selected_pair[0])],
-                    taupt[static_cast<UInt_t>(selected_pair[1])]);
-        Logger::get("PairSelection")
-            ->debug("MuonIso = {} , TauIso = {} ",
-                    muoniso[static_cast<UInt_t>(selected_pair[0])],
-                    tauiso[static_cast<UInt_t>(selected_pair[1])]);
-
-        return selected_pair;
-    };
+    return pairselection::PairSelectionAlgo<Channel::MT>();
 }
 
 /// Function to add the Pairselection result to a dataframe
 ///
-///  TODO add documentation here
+/// \param df the input dataframe
+/// \param input_vector the tau pt and isolation, the muon pt and isolation, the
+/// tau mask and the muon mask
+/// \param pairname name of the new column containing the pair indices
 ///
 /// \returns a dataframe containing the new pairname column
 auto PairSelection(auto &df, const std::vector<std::string> &input_vector,
@@ -247,4 +288,70 @@ auto PairSelection(auto &df, const std::vector<std::string> &input_vector,
 
 } // end namespace mutau
 
+/// namespace for pairs in the ElTau channel
+namespace eltau {
+
+/// Function to add the Pairselection result to a dataframe, see
+/// pairselection::PairSelectionAlgo. The first particle is the electron, the
+/// second one the tau.
+///
+/// \param df the input dataframe
+/// \param input_vector the tau pt and isolation, the electron pt and
+/// isolation, the tau mask and the electron mask
+/// \param pairname name of the new column containing the pair indices
+///
+/// \returns a dataframe containing the new pairname column
+auto PairSelection(auto &df, const std::vector<std::string> &input_vector,
+                   const std::string &pairname) {
+    Logger::get("PairSelection")->debug("Setting up eltau pair building");
+    return df.Define(pairname, PairSelectionAlgo<Channel::ET>(), input_vector);
+}
+
+} // end namespace eltau
+
+/// namespace for pairs in the TauTau channel
+namespace tautau {
+
+/// Function to add the Pairselection result to a dataframe, see
+/// pairselection::PairSelectionAlgo. Both particles are taken from the tau
+/// collection, so the first tau is the better one of the pair.
+///
+/// \param df the input dataframe
+/// \param input_vector the tau pt and isolation and the tau mask. They are
+/// used for both particles of the pair.
+/// \param pairname name of the new column containing the pair indices
+///
+/// \returns a dataframe containing the new pairname column
+auto PairSelection(auto &df, const std::vector<std::string> &input_vector,
+                   const std::string &pairname) {
+    Logger::get("PairSelection")->debug("Setting up tautau pair building");
+    const std::vector<std::string> columns = {
+        input_vector.at(0), input_vector.at(1), input_vector.at(0),
+        input_vector.at(1), input_vector.at(2), input_vector.at(2)};
+    return df.Define(pairname, PairSelectionAlgo<Channel::TT>(), columns);
+}
+
+} // end namespace tautau
+
+/// namespace for pairs in the ElMu channel
+namespace elmu {
+
+/// Function to add the Pairselection result to a dataframe, see
+/// pairselection::PairSelectionAlgo. The first particle is the electron, the
+/// second one the muon.
+///
+/// \param df the input dataframe
+/// \param input_vector the muon pt and isolation, the electron pt and
+/// isolation, the muon mask and the electron mask
+/// \param pairname name of the new column containing the pair indices
+///
+/// \returns a dataframe containing the new pairname column
+auto PairSelection(auto &df, const std::vector<std::string> &input_vector,
+                   const std::string &pairname) {
+    Logger::get("PairSelection")->debug("Setting up elmu pair building");
+    return df.Define(pairname, PairSelectionAlgo<Channel::EM>(), input_vector);
+}
+
+} // end namespace elmu
+
 } // end namespace pairselection
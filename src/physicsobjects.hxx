@@ -1,9 +1,15 @@
 #include "ROOT/RDataFrame.hxx"
 #include "basefunctions.hxx"
+#include "utility/Logger.hxx"
+#include "utility/ObjectMask.hxx"
+#include "utility/Variations.hxx"
 #include "utility/utility.hxx"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 /// Namespace containing function to apply cuts on physics objects. The
 /// cut results are typically stored within a mask, which is represented by
@@ -14,7 +20,8 @@
 ///    0 --> cut is not passed by the object
 ///    \endcode
 /// multiple cuts can be combined by multiplying masks using
-/// physicsobject::CombineMasks.
+/// physicsobject::CombineMasks. The functions in physicsobject::packed store
+/// the masks as bits of a single word, see utility::ObjectMask.
 namespace physicsobject {
 /// Function to select objects above a pt threshold, using
 /// basefunctions::FilterMin
@@ -107,6 +114,173 @@ auto CombineMasks(auto &df, const std::string &maskname,
         MaskList);
 }
 
+/// Cuts of the fused object selections physicsobject::SelectObjects and
+/// physicsobject::SelectObjectMask. A cut holds the name of the column it is
+/// applied to and its parameters, `value_type` is the element type of the
+/// column. Each cut corresponds to one of the cut functions above, e.g.
+/// selection::Min to physicsobject::CutPt.
+namespace selection {
+/// objects with a value of at least the threshold pass, like
+/// basefunctions::FilterMin
+struct Min {
+    using value_type = float;
+    Min(const std::string &column, const float &threshold)
+        : column(column), threshold(threshold) {}
+    bool operator()(const value_type value) const { return value >= threshold; }
+    std::string column;
+    float threshold;
+};
+/// objects with an integer value of at least the threshold pass, like
+/// basefunctions::FilterMinInt
+struct MinInt {
+    using value_type = int;
+    MinInt(const std::string &column, const int &threshold)
+        : column(column), threshold(threshold) {}
+    bool operator()(const value_type value) const { return value >= threshold; }
+    std::string column;
+    int threshold;
+};
+/// objects with a value below the threshold pass, like
+/// basefunctions::FilterMax
+struct Max {
+    using value_type = float;
+    Max(const std::string &column, const float &threshold)
+        : column(column), threshold(threshold) {}
+    bool operator()(const value_type value) const { return value < threshold; }
+    std::string column;
+    float threshold;
+};
+/// objects with an absolute value below the threshold pass, like
+/// basefunctions::FilterAbsMax
+struct AbsMax {
+    using value_type = float;
+    AbsMax(const std::string &column, const float &threshold)
+        : column(column), threshold(threshold) {}
+    bool operator()(const value_type value) const {
+        return std::abs(value) < threshold;
+    }
+    std::string column;
+    float threshold;
+};
+/// objects with a true boolean ID pass, like physicsobject::muon::CutID
+struct Flag {
+    using value_type = Bool_t;
+    explicit Flag(const std::string &column) : column(column) {}
+    bool operator()(const value_type value) const { return value; }
+    std::string column;
+};
+/// taus passing the working point `index` of a tau ID pass, like
+/// basefunctions::FilterID
+struct TauID {
+    using value_type = UChar_t;
+    TauID(const std::string &column, const int &index)
+        : column(column), index(index) {}
+    bool operator()(const value_type value) const {
+        return (value >> (index - 1)) & 1;
+    }
+    std::string column;
+    int index;
+};
+/// jets with the bit `index` of the jet ID set pass, like
+/// basefunctions::FilterJetID
+struct JetID {
+    using value_type = Int_t;
+    JetID(const std::string &column, const int &index)
+        : column(column), index(index) {}
+    bool operator()(const value_type value) const {
+        return (value >> index) & 1;
+    }
+    std::string column;
+    int index;
+};
+/// objects with one of the selected values pass, like
+/// physicsobject::tau::CutDecayModes
+struct Values {
+    using value_type = Int_t;
+    Values(const std::string &column, const std::vector<int> &selected)
+        : column(column), selected(selected) {}
+    bool operator()(const value_type value) const {
+        return std::find(selected.begin(), selected.end(), value) !=
+               selected.end();
+    }
+    std::string column;
+    std::vector<int> selected;
+};
+/// objects passing an existing mask pass, e.g. to refine a selection
+struct Mask {
+    using value_type = int;
+    explicit Mask(const std::string &column) : column(column) {}
+    bool operator()(const value_type value) const { return value != 0; }
+    std::string column;
+};
+} // end namespace selection
+
+/// Function to select objects, which pass all of the given cuts. All cuts are
+/// evaluated in a single loop over the objects, so that the selection is one
+/// node of the dataframe instead of one node per cut and a
+/// physicsobject::CombineMasks. The cuts of an object are evaluated in the
+/// given order, until one of them fails. The result is the list of indices of
+/// the selected objects, in increasing order.
+///
+/// \code
+/// physicsobject::SelectObjects(df, "good_taus",
+///                              selection::Min("Tau_pt", 20.),
+///                              selection::AbsMax("Tau_eta", 2.3),
+///                              selection::TauID("Tau_idDeepTau2017v2p1VSjet",
+///                                               4));
+/// \endcode
+///
+/// \param[in] df the input dataframe
+/// \param[out] outputname the name of the index list to be added as column
+/// to the dataframe
+/// \param[in] cuts a parameter pack of cuts from physicsobject::selection,
+/// all cuts have to be applied to columns of the same collection
+///
+/// \return a dataframe containing the new index list
+template <class... Cuts>
+auto SelectObjects(auto &df, const std::string &outputname,
+                   const Cuts &... cuts) {
+    static_assert(sizeof...(Cuts) > 0, "At least one cut is required");
+    auto selector =
+        [cuts...](const ROOT::RVec<typename Cuts::value_type> &... columns) {
+            const std::size_t n = std::min({columns.size()...});
+            ROOT::RVec<int> indices;
+            indices.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                if ((cuts(columns[i]) && ...))
+                    indices.push_back(i);
+            }
+            return indices;
+        };
+    return df.Define(outputname, selector, {cuts.column...});
+}
+
+/// Function to select objects, which pass all of the given cuts, see
+/// physicsobject::SelectObjects. Instead of an index list, a mask is
+/// created, which can be used in place of the result of
+/// physicsobject::CombineMasks.
+///
+/// \param[in] df the input dataframe
+/// \param[out] maskname the name of the new mask to be added as column to the
+/// dataframe
+/// \param[in] cuts a parameter pack of cuts from physicsobject::selection
+///
+/// \return a dataframe containing the new mask
+template <class... Cuts>
+auto SelectObjectMask(auto &df, const std::string &maskname,
+                      const Cuts &... cuts) {
+    static_assert(sizeof...(Cuts) > 0, "At least one cut is required");
+    auto selector =
+        [cuts...](const ROOT::RVec<typename Cuts::value_type> &... columns) {
+            const std::size_t n = std::min({columns.size()...});
+            ROOT::RVec<int> mask(n);
+            for (std::size_t i = 0; i < n; ++i)
+                mask[i] = (cuts(columns[i]) && ...);
+            return mask;
+        };
+    return df.Define(maskname, selector, {cuts.column...});
+}
+
 /// Function to take a mask and create a new one where a tau candidate is set to
 /// false
 ///
@@ -203,6 +377,42 @@ auto ObjectMassCorrectionWithPt(auto &df, const std::string &corrected_mass,
     return df1;
 }
 
+/// Function to check whether a pair of leptons with opposite charge and an
+/// angular distance of at least dR_cut is among the given leptons
+///
+/// \param[in] indices the indices of the leptons to be taken into account
+/// \param[in] pt_values the pts of the lepton collection
+/// \param[in] eta_values the etas of the lepton collection
+/// \param[in] phi_values the phis of the lepton collection
+/// \param[in] mass_values the masses of the lepton collection
+/// \param[in] charge_values the charges of the lepton collection
+/// \param[in] dR_cut minimum required angular distance between the leptons
+///
+/// \return true, if such a pair is found
+inline bool HasDiLeptonPair(const ROOT::RVec<int> &indices,
+                            const ROOT::RVec<float> &pt_values,
+                            const ROOT::RVec<float> &eta_values,
+                            const ROOT::RVec<float> &phi_values,
+                            const ROOT::RVec<float> &mass_values,
+                            const ROOT::RVec<int> &charge_values,
+                            const float dR_cut) {
+    for (auto it1 = indices.begin(); it1 != indices.end(); it1++) {
+        for (auto it2 = it1 + 1; it2 != indices.end(); it2++) {
+            if (charge_values.at(*it1) != charge_values.at(*it2)) {
+                auto p4_1 = ROOT::Math::PtEtaPhiMVector(
+                    pt_values.at(*it1), eta_values.at(*it1),
+                    phi_values.at(*it1), mass_values.at(*it1));
+                auto p4_2 = ROOT::Math::PtEtaPhiMVector(
+                    pt_values.at(*it2), eta_values.at(*it2),
+                    phi_values.at(*it2), mass_values.at(*it2));
+                if (ROOT::Math::VectorUtil::DeltaR(p4_1, p4_2) >= dR_cut)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
 /// Function to check whether at least one lepton pair is present
 ///
 /// \param[in] df the input dataframe
@@ -228,23 +438,9 @@ auto CheckForDiLeptonPairs(
                                        const ROOT::RVec<float> &mass_values,
                                        const ROOT::RVec<int> &charge_values,
                                        const ROOT::RVec<int> &mask) {
-        const auto valid_lepton_indices = ROOT::VecOps::Nonzero(mask);
-        for (auto it1 = valid_lepton_indices.begin();
-             it1 != valid_lepton_indices.end(); it1++) {
-            for (auto it2 = it1 + 1; it2 != valid_lepton_indices.end(); it2++) {
-                if (charge_values.at(*it1) != charge_values.at(*it2)) {
-                    auto p4_1 = ROOT::Math::PtEtaPhiMVector(
-                        pt_values.at(*it1), eta_values.at(*it1),
-                        phi_values.at(*it1), mass_values.at(*it1));
-                    auto p4_2 = ROOT::Math::PtEtaPhiMVector(
-                        pt_values.at(*it2), eta_values.at(*it2),
-                        phi_values.at(*it2), mass_values.at(*it2));
-                    if (ROOT::Math::VectorUtil::DeltaR(p4_1, p4_2) >= dR_cut)
-                        return true;
-                }
-            }
-        }
-        return false;
+        return HasDiLeptonPair(ROOT::VecOps::Nonzero(mask), pt_values,
+                               eta_values, phi_values, mass_values,
+                               charge_values, dR_cut);
     };
     auto df1 = df.Define(output_flag, pair_finder_lambda,
                          {leptons_pt, leptons_eta, leptons_phi, leptons_mass,
@@ -326,6 +522,29 @@ auto CutTauID(auto &df, const std::string &maskname, const std::string &nameID,
     auto df1 = df.Define(maskname, basefunctions::FilterID(idxID), {nameID});
     return df1;
 }
+/// Function to get the energy scale factor of a tau with the given decay
+/// mode
+///
+/// \param[in] decay_mode the decay mode of the tau
+/// \param[in] sf_dm0 scale factor of taus with decay mode 0
+/// \param[in] sf_dm1 scale factor of other 1 prong taus
+/// \param[in] sf_dm10 scale factor of taus with decay mode 10
+/// \param[in] sf_dm11 scale factor of other 3 prong taus
+///
+/// \return the scale factor, 1 for other decay modes
+inline float EnergyScaleFactor(const int &decay_mode, const float &sf_dm0,
+                               const float &sf_dm1, const float &sf_dm10,
+                               const float &sf_dm11) {
+    if (decay_mode == 0)
+        return sf_dm0;
+    else if (decay_mode > 0 && decay_mode < 5)
+        return sf_dm1;
+    else if (decay_mode == 10)
+        return sf_dm10;
+    else if (decay_mode > 10 && decay_mode < 15)
+        return sf_dm11;
+    return 1.;
+}
 /// Function to correct tau pt
 ///
 /// \param[in] df the input dataframe
@@ -347,16 +566,10 @@ auto PtCorrection(auto &df, const std::string &corrected_pt,
                                            const ROOT::RVec<int> &decay_modes) {
             ROOT::RVec<float> corrected_pt_values(pt_values.size());
             for (int i = 0; i < pt_values.size(); i++) {
-                if (decay_modes.at(i) == 0)
-                    corrected_pt_values[i] = pt_values.at(i) * sf_dm0;
-                else if (decay_modes.at(i) > 0 && decay_modes.at(i) < 5)
-                    corrected_pt_values[i] = pt_values.at(i) * sf_dm1;
-                else if (decay_modes.at(i) == 10)
-                    corrected_pt_values[i] = pt_values.at(i) * sf_dm10;
-                else if (decay_modes.at(i) > 10 && decay_modes.at(i) < 15)
-                    corrected_pt_values[i] = pt_values.at(i) * sf_dm11;
-                else
-                    corrected_pt_values[i] = pt_values.at(i);
+                corrected_pt_values[i] =
+                    pt_values.at(i) * EnergyScaleFactor(decay_modes.at(i),
+                                                        sf_dm0, sf_dm1,
+                                                        sf_dm10, sf_dm11);
             }
             return corrected_pt_values;
         };
@@ -364,6 +577,58 @@ auto PtCorrection(auto &df, const std::string &corrected_pt,
         df.Define(corrected_pt, tau_pt_correction_lambda, {pt, decayMode});
     return df1;
 }
+/// Function to correct tau pt for several variations of the energy scale in
+/// a single step, see physicsobject::tau::PtCorrection. The corrected pts of
+/// all variations are stored in a single column, see utility::Variations,
+/// the first variation is the nominal one.
+///
+/// \param[in] df the input dataframe
+/// \param[out] corrected_pt name of the corrected tau pt to be calculated
+/// \param[in] pt name of the raw tau pt
+/// \param[in] decayMode name of the tau decay mode quantity
+/// \param[in] sf_dm0 scale factors of taus with decay mode 0, one per
+/// variation
+/// \param[in] sf_dm1 scale factors of other 1 prong taus, one per variation
+/// \param[in] sf_dm10 scale factors of taus with decay mode 10, one per
+/// variation
+/// \param[in] sf_dm11 scale factors of other 3 prong taus, one per variation
+///
+/// \return a dataframe containing the corrected tau pts of all variations
+auto PtCorrectionVariations(auto &df, const std::string &corrected_pt,
+                            const std::string &pt,
+                            const std::string &decayMode,
+                            const std::vector<float> &sf_dm0,
+                            const std::vector<float> &sf_dm1,
+                            const std::vector<float> &sf_dm10,
+                            const std::vector<float> &sf_dm11) {
+    const std::size_t nVariations = sf_dm0.size();
+    if (sf_dm1.size() != nVariations || sf_dm10.size() != nVariations ||
+        sf_dm11.size() != nVariations) {
+        Logger::get("TauPtCorrection")
+            ->critical("Inconsistent number of tau energy scale variations, "
+                       "expected {}",
+                       nVariations);
+        throw std::runtime_error("Inconsistent number of variations");
+    }
+    auto tau_pt_correction_lambda = [sf_dm0, sf_dm1, sf_dm10, sf_dm11,
+                                     nVariations](
+                                        const ROOT::RVec<float> &pt_values,
+                                        const ROOT::RVec<int> &decay_modes) {
+        utility::Variations<ROOT::RVec<float>> result;
+        result.values.resize(nVariations, ROOT::RVec<float>(pt_values.size()));
+        for (int i = 0; i < pt_values.size(); i++) {
+            for (std::size_t j = 0; j < nVariations; ++j) {
+                result.values[j][i] =
+                    pt_values.at(i) *
+                    EnergyScaleFactor(decay_modes.at(i), sf_dm0[j], sf_dm1[j],
+                                      sf_dm10[j], sf_dm11[j]);
+            }
+        }
+        return result;
+    };
+    return utility::DefineVariations<ROOT::RVec<float>>(
+        df, corrected_pt, tau_pt_correction_lambda, {pt, decayMode});
+}
 
 } // end namespace tau
 
@@ -413,4 +678,292 @@ auto CutIsolation(auto &df, const std::string &maskname,
 
 } // end namespace electron
 
+/// Object selections with bit-packed masks of type utility::ObjectMask. They
+/// are drop-in alternatives for the cuts above, for selections where the
+/// intermediate masks are only combined with each other. A packed mask is a
+/// single word per event, so neither the cuts nor physicsobject::packed::
+/// CombineMasks allocate memory. Functions expecting a `ROOT::RVec<int>` mask
+/// are served by converting the combined mask with
+/// physicsobject::packed::Unpack.
+namespace packed {
+/// Function to select objects with a value of at least the threshold
+///
+/// \param[in] df the input dataframe
+/// \param[in] quantity name of the column in the NanoAOD
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+/// \param[in] threshold minimal value
+///
+/// \return a dataframe containing the new mask
+auto CutMin(auto &df, const std::string &quantity, const std::string &maskname,
+            const float &threshold) {
+    return df.Define(
+        maskname,
+        [threshold](const ROOT::RVec<float> &values) {
+            return utility::ObjectMask::FromPredicate(
+                values,
+                [threshold](float value) { return value >= threshold; });
+        },
+        {quantity});
+}
+/// Function to select objects with an integer value of at least the threshold
+///
+/// \param[in] df the input dataframe
+/// \param[in] quantity name of the column in the NanoAOD
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+/// \param[in] threshold minimal value
+///
+/// \return a dataframe containing the new mask
+auto CutMinInt(auto &df, const std::string &quantity,
+               const std::string &maskname, const int &threshold) {
+    return df.Define(
+        maskname,
+        [threshold](const ROOT::RVec<int> &values) {
+            return utility::ObjectMask::FromPredicate(
+                values, [threshold](int value) { return value >= threshold; });
+        },
+        {quantity});
+}
+/// Function to select objects with a value below the threshold
+///
+/// \param[in] df the input dataframe
+/// \param[in] quantity name of the column in the NanoAOD
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+/// \param[in] threshold maximal value
+///
+/// \return a dataframe containing the new mask
+auto CutMax(auto &df, const std::string &quantity, const std::string &maskname,
+            const float &threshold) {
+    return df.Define(
+        maskname,
+        [threshold](const ROOT::RVec<float> &values) {
+            return utility::ObjectMask::FromPredicate(
+                values, [threshold](float value) { return value < threshold; });
+        },
+        {quantity});
+}
+/// Function to select objects with an absolute value below the threshold,
+/// e.g. for cuts on eta, dxy or dz
+///
+/// \param[in] df the input dataframe
+/// \param[in] quantity name of the column in the NanoAOD
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+/// \param[in] threshold maximal absolute value
+///
+/// \return a dataframe containing the new mask
+auto CutAbsMax(auto &df, const std::string &quantity,
+               const std::string &maskname, const float &threshold) {
+    return df.Define(
+        maskname,
+        [threshold](const ROOT::RVec<float> &values) {
+            return utility::ObjectMask::FromPredicate(
+                values,
+                [threshold](float value) {
+                    return std::abs(value) < threshold;
+                });
+        },
+        {quantity});
+}
+/// Function to select objects, which have a bit of an ID bitmask set. For the
+/// tau IDs, the working point `idxID` of physicsobject::tau::CutTauID
+/// corresponds to the bit `idxID - 1`, for the jet ID, the index of
+/// physicsobject::jet::CutID is the bit.
+///
+/// \param[in] df the input dataframe
+/// \param[in] quantity name of the ID column in the NanoAOD
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+/// \param[in] bit the bit, which has to be set
+///
+/// \return a dataframe containing the new mask
+template <typename T = UChar_t>
+auto CutBit(auto &df, const std::string &quantity, const std::string &maskname,
+            const int &bit) {
+    return df.Define(
+        maskname,
+        [bit](const ROOT::RVec<T> &IDs) {
+            return utility::ObjectMask::FromPredicate(
+                IDs, [bit](T ID) { return (int(ID) >> bit) & 1; });
+        },
+        {quantity});
+}
+/// Function to select objects based on a boolean ID column, e.g. the muon and
+/// electron IDs
+///
+/// \param[in] df the input dataframe
+/// \param[in] quantity name of the ID column in the NanoAOD
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+///
+/// \return a dataframe containing the new mask
+auto CutFlag(auto &df, const std::string &quantity,
+             const std::string &maskname) {
+    return df.Define(
+        maskname,
+        [](const ROOT::RVec<Bool_t> &flags) {
+            return utility::ObjectMask::FromPredicate(
+                flags, [](Bool_t flag) { return flag; });
+        },
+        {quantity});
+}
+/// Function to select objects with one of the given values, e.g. the selected
+/// tau decay modes
+///
+/// \param[in] df the input dataframe
+/// \param[in] quantity name of the column in the NanoAOD
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+/// \param[in] selected the values passing the cut
+///
+/// \return a dataframe containing the new mask
+auto CutValues(auto &df, const std::string &quantity,
+               const std::string &maskname, const std::vector<int> &selected) {
+    return df.Define(
+        maskname,
+        [selected](const ROOT::RVec<Int_t> &values) {
+            return utility::ObjectMask::FromPredicate(
+                values, [&selected](Int_t value) {
+                    return std::find(selected.begin(), selected.end(),
+                                     value) != selected.end();
+                });
+        },
+        {quantity});
+}
+
+/// Function to select objects, which pass all of the given cuts, see
+/// physicsobject::SelectObjectMask. Instead of a `ROOT::RVec<int>` mask, a
+/// packed mask is created.
+///
+/// \param[in] df the input dataframe
+/// \param[out] maskname the name of the packed mask to be added as column to
+/// the dataframe
+/// \param[in] cuts a parameter pack of cuts from physicsobject::selection
+///
+/// \return a dataframe containing the new mask
+template <class... Cuts>
+auto SelectObjectMask(auto &df, const std::string &maskname,
+                      const Cuts &... cuts) {
+    static_assert(sizeof...(Cuts) > 0, "At least one cut is required");
+    auto selector =
+        [cuts...](const ROOT::RVec<typename Cuts::value_type> &... columns) {
+            const std::size_t n = std::min({columns.size()...});
+            const std::size_t usable =
+                std::min(n, utility::ObjectMask::maxObjects);
+            std::uint64_t bits = 0;
+            for (std::size_t i = 0; i < usable; ++i)
+                bits |= std::uint64_t((cuts(columns[i]) && ...)) << i;
+            return utility::ObjectMask(bits, n);
+        };
+    return df.Define(maskname, selector, {cuts.column...});
+}
+
+/// Function object calculating the `and` of a fixed number of packed masks.
+/// Unlike `ROOT::RDF::PassAsVec`, the masks are passed as separate arguments,
+/// so no temporary vector is needed.
+template <typename I> class AndMasks;
+template <std::size_t... N> class AndMasks<std::index_sequence<N...>> {
+    template <std::size_t Idx> using AlwaysMask = utility::ObjectMask;
+
+  public:
+    utility::ObjectMask operator()(const AlwaysMask<N> &... masks) const {
+        return (masks & ...);
+    }
+};
+
+/// Function to combine a list of packed masks into a single packed mask, the
+/// equivalent of physicsobject::CombineMasks
+///
+/// \param[in] df the input dataframe
+/// \param[out] maskname the name of the new mask to be added as column to the
+/// dataframe
+/// \param[in] masks a parameter pack with the names of the packed masks to be
+/// combined
+///
+/// \return a dataframe containing the new mask
+template <class... Masks>
+auto CombineMasks(auto &df, const std::string &maskname,
+                  const Masks &... masks) {
+    std::vector<std::string> MaskList;
+    utility::appendParameterPackToVector(MaskList, masks...);
+    return df.Define(maskname,
+                     AndMasks<std::make_index_sequence<sizeof...(Masks)>>{},
+                     MaskList);
+}
+/// Function to convert a `ROOT::RVec<int>` mask into a packed mask, e.g. to
+/// combine a mask of another producer with packed masks
+///
+/// \param[in] df the input dataframe
+/// \param[out] outputname the name of the packed mask
+/// \param[in] maskname the name of the `ROOT::RVec<int>` mask
+///
+/// \return a dataframe containing the packed mask
+auto Pack(auto &df, const std::string &outputname,
+          const std::string &maskname) {
+    return df.Define(
+        outputname,
+        [](const ROOT::RVec<int> &mask) {
+            return utility::ObjectMask::FromRVec(mask);
+        },
+        {maskname});
+}
+/// Function to convert a packed mask into a `ROOT::RVec<int>` mask, which can
+/// be used by all functions expecting a mask, e.g. the pair selections or
+/// physicsobject::LeptonVetoFlag
+///
+/// \param[in] df the input dataframe
+/// \param[out] outputname the name of the `ROOT::RVec<int>` mask
+/// \param[in] maskname the name of the packed mask
+///
+/// \return a dataframe containing the unpacked mask
+auto Unpack(auto &df, const std::string &outputname,
+            const std::string &maskname) {
+    return df.Define(
+        outputname,
+        [](const utility::ObjectMask &mask) { return mask.ToRVec(); },
+        {maskname});
+}
+/// Function to check whether at least one lepton pair is present, see
+/// physicsobject::CheckForDiLeptonPairs, with the leptons taken into account
+/// given by a packed mask
+///
+/// \param[in] df the input dataframe
+/// \param[out] output_flag the name of the bool column that is created
+/// \param[in] leptons_pt name of the input pt column of the lepton collection
+/// \param[in] leptons_eta name of the input eta column of the lepton collection
+/// \param[in] leptons_phi name of the input phi column of the lepton collection
+/// \param[in] leptons_mass name of the input mass column of the lepton
+/// collection
+/// \param[in] leptons_charge name of the input charge column of the lepton
+/// collection
+/// \param[in] leptons_mask name of the packed mask of the leptons to be taken
+/// into account
+/// \param[in] dR_cut minimum required angular distance between the leptons
+///
+/// \return a dataframe containing the new bool column
+auto CheckForDiLeptonPairs(
+    auto &df, const std::string &output_flag, const std::string &leptons_pt,
+    const std::string &leptons_eta, const std::string &leptons_phi,
+    const std::string &leptons_mass, const std::string &leptons_charge,
+    const std::string &leptons_mask, const float dR_cut) {
+    auto pair_finder_lambda = [dR_cut](const ROOT::RVec<float> &pt_values,
+                                       const ROOT::RVec<float> &eta_values,
+                                       const ROOT::RVec<float> &phi_values,
+                                       const ROOT::RVec<float> &mass_values,
+                                       const ROOT::RVec<int> &charge_values,
+                                       const utility::ObjectMask &mask) {
+        // without a pair candidate, the indices are not needed
+        if (mask.count() < 2)
+            return false;
+        return HasDiLeptonPair(mask.Indices(), pt_values, eta_values,
+                               phi_values, mass_values, charge_values, dR_cut);
+    };
+    return df.Define(output_flag, pair_finder_lambda,
+                     {leptons_pt, leptons_eta, leptons_phi, leptons_mass,
+                      leptons_charge, leptons_mask});
+}
+} // end namespace packed
+
 } // namespace physicsobject
\ No newline at end of file
@@ -2,6 +2,13 @@
 #include "utility/Logger.hxx"
 #include "vectoroperations.hxx"
 #include <Math/Vector4D.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 /// The namespace that is used to hold the functions for basic quantities that
 /// are needed for every event
@@ -528,4 +535,274 @@ auto matching_genjet_pt(auto &df, const std::string &outputname,
                      {pairname, taujet_index, genjet_index, genjetpt_column});
 }
 } // end namespace tau
+
+/// Quantities calculated from the cartesian components of the particles, as
+/// created by lorentzvectors::buildCartesian and
+/// lorentzvectors::buildMetCartesian. The components are added up directly,
+/// so no conversions between the coordinate systems are needed. The inputs
+/// of a particle are given in the order px, py, pz, energy, or px, py for
+/// functions, which only use the transverse plane. Particles, which were not
+/// found, are marked by a negative energy and lead to `default_float`.
+namespace cartesian {
+
+/// Function to calculate the visible mass of the dilepton system, see
+/// quantities::m_vis
+///
+/// \param df the dataframe to add the quantity to
+/// \param outputname name of the new column containing the visible mass
+/// \param inputs the names of the four components of the two particles
+///
+/// \returns a dataframe with the new column
+auto m_vis(auto &df, const std::string &outputname,
+           const std::vector<std::string> &inputs) {
+    return df.Define(
+        outputname,
+        [](const float px_1, const float py_1, const float pz_1,
+           const float e_1, const float px_2, const float py_2,
+           const float pz_2, const float e_2) {
+            if (e_1 < 0.0 || e_2 < 0.0)
+                return default_float;
+            const double px = double(px_1) + px_2;
+            const double py = double(py_1) + py_2;
+            const double pz = double(pz_1) + pz_2;
+            const double e = double(e_1) + e_2;
+            const double m2 = e * e - px * px - py * py - pz * pz;
+            // as in ROOT, a negative squared mass gives a negative mass
+            return (float)(m2 >= 0 ? std::sqrt(m2) : -std::sqrt(-m2));
+        },
+        inputs);
+}
+
+/// Function to calculate the visible pt of the dilepton system, see
+/// quantities::pt_vis
+///
+/// \param df the dataframe to add the quantity to
+/// \param outputname name of the new column containing the visible pt
+/// \param inputs the names of the four components of the two particles
+///
+/// \returns a dataframe with the new column
+auto pt_vis(auto &df, const std::string &outputname,
+            const std::vector<std::string> &inputs) {
+    return df.Define(
+        outputname,
+        [](const float px_1, const float py_1, const float pz_1,
+           const float e_1, const float px_2, const float py_2,
+           const float pz_2, const float e_2) {
+            if (e_1 < 0.0 || e_2 < 0.0)
+                return default_float;
+            return (float)std::hypot(double(px_1) + px_2, double(py_1) + py_2);
+        },
+        inputs);
+}
+
+/// Function to calculate the transverse mass of a particle and the met, see
+/// quantities::mT. With the transverse components, the transverse mass is
+/// given by \f$ m_T^2 = 2 (p_T E_T^{miss} - \vec{p}_T \cdot
+/// \vec{p}_T^{miss}) \f$.
+///
+/// \param df the dataframe to add the quantity to
+/// \param outputname name of the new column containing the transverse mass
+/// \param inputs the names of the four components of the particle, followed
+/// by the two components of the met
+///
+/// \returns a dataframe with the new column
+auto mT(auto &df, const std::string &outputname,
+        const std::vector<std::string> &inputs) {
+    return df.Define(
+        outputname,
+        [](const float px, const float py, const float pz, const float e,
+           const float met_px, const float met_py) {
+            if (e < 0.0)
+                return default_float;
+            const double pt = std::hypot(px, py);
+            const double met = std::hypot(met_px, met_py);
+            const double mt2 =
+                2. * (pt * met - (double(px) * met_px + double(py) * met_py));
+            return (float)std::sqrt(std::max(0., mt2));
+        },
+        inputs);
+}
+
+/// Function to calculate the pt of the dilepton + met system, see
+/// quantities::pt_tt
+///
+/// \param df the dataframe to add the quantity to
+/// \param outputname name of the new column containing the pt_tt value
+/// \param inputs the names of the four components of the two particles,
+/// followed by the two components of the met
+///
+/// \returns a dataframe with the new column
+auto pt_tt(auto &df, const std::string &outputname,
+           const std::vector<std::string> &inputs) {
+    return df.Define(
+        outputname,
+        [](const float px_1, const float py_1, const float pz_1,
+           const float e_1, const float px_2, const float py_2,
+           const float pz_2, const float e_2, const float met_px,
+           const float met_py) {
+            if (e_1 < 0.0 || e_2 < 0.0)
+                return default_float;
+            return (float)std::hypot(double(px_1) + px_2 + met_px,
+                                     double(py_1) + py_2 + met_py);
+        },
+        inputs);
+}
+
+/// Function to calculate `pZetaMissVis`, see quantities::pzetamissvis for
+/// the definition. The bisector \f$\hat{\zeta}\f$ is built from the
+/// transverse components of the two particles.
+///
+/// \param df the dataframe to add the quantity to
+/// \param outputname name of the new column containing the pZetaMissVis value
+/// \param inputs the names of the four components of the two particles,
+/// followed by the two components of the met
+///
+/// \returns a dataframe with the new column
+auto pzetamissvis(auto &df, const std::string &outputname,
+                  const std::vector<std::string> &inputs) {
+    const float alpha = 0.85;
+    return df.Define(
+        outputname,
+        [alpha](const float px_1, const float py_1, const float pz_1,
+                const float e_1, const float px_2, const float py_2,
+                const float pz_2, const float e_2, const float met_px,
+                const float met_py) {
+            if (e_1 < 0.0 || e_2 < 0.0)
+                return (double)default_float;
+            const double pt_1 = std::hypot(px_1, py_1);
+            const double pt_2 = std::hypot(px_2, py_2);
+            double zeta_x = px_1 / pt_1 + px_2 / pt_2;
+            double zeta_y = py_1 / pt_1 + py_2 / pt_2;
+            const double norm = std::hypot(zeta_x, zeta_y);
+            zeta_x /= norm;
+            zeta_y /= norm;
+            const double pzetaVis = (double(px_1) + px_2) * zeta_x +
+                                    (double(py_1) + py_2) * zeta_y;
+            return met_px * zeta_x + met_py * zeta_y - alpha * pzetaVis;
+        },
+        inputs);
+}
+} // end namespace cartesian
+
+/// Quantities of a single particle, which can be gathered in one step by
+/// quantities::Unpack. Each quantity holds the name of its input column,
+/// `column_type` is the type of the column and `value_type` the type of the
+/// gathered value. The quantities correspond to the functions above, e.g.
+/// particle::Pt to quantities::pt and particle::Element to quantities::dxy.
+namespace particle {
+/// pt of the lorentz vector of the particle, like quantities::pt
+struct Pt {
+    using column_type = ROOT::Math::PtEtaPhiMVector;
+    using value_type = float;
+    explicit Pt(const std::string &column) : column(column) {}
+    value_type operator()(const column_type &p4, const int) const {
+        return p4.pt();
+    }
+    std::string column;
+};
+/// eta of the lorentz vector of the particle, like quantities::eta
+struct Eta {
+    using column_type = ROOT::Math::PtEtaPhiMVector;
+    using value_type = float;
+    explicit Eta(const std::string &column) : column(column) {}
+    value_type operator()(const column_type &p4, const int) const {
+        return p4.eta();
+    }
+    std::string column;
+};
+/// phi of the lorentz vector of the particle, like quantities::phi
+struct Phi {
+    using column_type = ROOT::Math::PtEtaPhiMVector;
+    using value_type = float;
+    explicit Phi(const std::string &column) : column(column) {}
+    value_type operator()(const column_type &p4, const int) const {
+        // negative pt is used to mark invalid LVs
+        return p4.pt() < 0.0 ? default_float : p4.phi();
+    }
+    std::string column;
+};
+/// mass of the lorentz vector of the particle, like quantities::mass
+struct Mass {
+    using column_type = ROOT::Math::PtEtaPhiMVector;
+    using value_type = float;
+    explicit Mass(const std::string &column) : column(column) {}
+    value_type operator()(const column_type &p4, const int) const {
+        return p4.pt() < 0.0 ? default_float : p4.mass();
+    }
+    std::string column;
+};
+/// entry of the particle in a column of its collection, e.g. the dxy or the
+/// charge, or the fallback value, if the particle is not found
+template <typename T> struct Element {
+    using column_type = ROOT::RVec<T>;
+    using value_type = T;
+    Element(const std::string &column, const T &fallback)
+        : column(column), fallback(fallback) {}
+    value_type operator()(const column_type &values, const int index) const {
+        return values.at(index, fallback);
+    }
+    std::string column;
+    T fallback;
+};
+} // end namespace particle
+
+/// Helper of quantities::Unpack, which defines one column for each entry of
+/// the gathered tuple
+template <typename Values, std::size_t... I>
+auto unpackTuple(auto df, const std::string &tuplename,
+                 const std::vector<std::string> &outputnames,
+                 std::index_sequence<I...>) {
+    ((df = df.Define(
+          outputnames[I],
+          [](const Values &values) { return std::get<I>(values); },
+          {tuplename})),
+     ...);
+    return df;
+}
+
+/// Function to writeout several quantities of a particle at once. The
+/// particle is identified via the index stored in the pair vector. Instead of
+/// one column per quantity, each reading the pair vector and looking up a
+/// single value, all quantities are gathered into a tuple column in one
+/// step. The quantities are then added as columns, which only copy their
+/// entry of the tuple.
+///
+/// \code
+/// quantities::Unpack(df, "quantities_1", {"pt_1", "dxy_1"}, 0, "ditaupair",
+///                    particle::Pt("p4_1"),
+///                    particle::Element<float>("Muon_dxy", default_float));
+/// \endcode
+///
+/// \param df the dataframe to add the quantities to
+/// \param tuplename name of the new column containing the gathered tuple
+/// \param outputnames names of the new columns, one for each quantity
+/// \param position index of the position in the pair vector
+/// \param pairname name of the column containing the pair vector
+/// \param quantities a parameter pack of quantities from
+/// quantities::particle
+///
+/// \returns a dataframe with the new columns
+template <class... Quantities>
+auto Unpack(auto &df, const std::string &tuplename,
+            const std::vector<std::string> &outputnames, const int &position,
+            const std::string &pairname, const Quantities &... quantities) {
+    static_assert(sizeof...(Quantities) > 0,
+                  "At least one quantity is required");
+    if (outputnames.size() != sizeof...(Quantities)) {
+        Logger::get("Unpack")->critical(
+            "{} output names given for {} quantities of {}",
+            outputnames.size(), sizeof...(Quantities), tuplename);
+        throw std::runtime_error("Bad number of output names");
+    }
+    using Values = std::tuple<typename Quantities::value_type...>;
+    auto gather = [position, quantities...](
+                      const ROOT::RVec<int> &pair,
+                      const typename Quantities::column_type &... columns) {
+        const int index = position < int(pair.size()) ? pair[position] : -1;
+        return Values(quantities(columns, index)...);
+    };
+    auto df1 = df.Define(tuplename, gather, {pairname, quantities.column...});
+    return unpackTuple<Values>(df1, tuplename, outputnames,
+                               std::index_sequence_for<Quantities...>{});
+}
 } // end namespace quantities
\ No newline at end of file
@@ -2,11 +2,18 @@
 #include "ROOT/RVec.hxx"
 #include "TFile.h"
 #include "TH1.h"
+#include "utility/CorrectionRegistry.hxx"
 #include "utility/Logger.hxx"
 #include "utility/RooFunctorThreadsafe.hxx"
 
 /// namespace used for reweighting related functions
 namespace reweighting {
+/// Pile-up weights read from a histogram, indexed by the bin number
+struct PileupWeights {
+    float bin_density = 1.0;
+    std::vector<float> weights;
+};
+
 /**
  * @brief Function used to read out pileup weights
  *
@@ -22,24 +29,25 @@ auto puweights(auto &df, const std::string &weightname,
                const std::string &truePUMean, const std::string &filename,
                const std::string &histogramname) {
 
-    float bin_density = 1.0;
-    std::vector<float> puweights;
     Logger::get("puweights")
         ->debug("Loading pile-up weights from {}", filename);
-    {
-        TFile inputfile(filename.c_str(), "READ");
-        TH1D *puhist = (TH1D *)inputfile.Get(histogramname.c_str());
-        for (int i = 0; i <= puhist->GetNbinsX(); ++i) {
-            puweights.push_back(puhist->GetBinContent(i));
-        }
-        bin_density = 1.0 / puhist->GetBinWidth(1);
-        delete puhist;
-        inputfile.Close();
-    }
+    const std::shared_ptr<const PileupWeights> puweights =
+        CorrectionRegistry::get<const PileupWeights>(
+            filename, histogramname, "", [&histogramname](TFile &inputfile) {
+                auto result = std::make_shared<PileupWeights>();
+                TH1D *puhist = (TH1D *)inputfile.Get(histogramname.c_str());
+                for (int i = 0; i <= puhist->GetNbinsX(); ++i) {
+                    result->weights.push_back(puhist->GetBinContent(i));
+                }
+                result->bin_density = 1.0 / puhist->GetBinWidth(1);
+                delete puhist;
+                return result;
+            });
 
-    auto puweightlambda = [bin_density, puweights](const float pu) {
-        size_t puBin = static_cast<size_t>(pu * bin_density);
-        return puBin < puweights.size() ? puweights[puBin] : 1.0;
+    auto puweightlambda = [puweights](const float pu) {
+        size_t puBin = static_cast<size_t>(pu * puweights->bin_density);
+        return puBin < puweights->weights.size() ? puweights->weights[puBin]
+                                                 : 1.0;
     };
     auto df1 = df.Define(weightname, puweightlambda, {truePUMean});
     return df1;
@@ -105,13 +113,16 @@ auto topptreweighting(auto &df, const std::string &weightname,
  * read
  * @param functor_name name of the function from the workspace
  * @param argset arguments of the function
+ * @param tabulation_tolerance if not negative, the function is replaced by a
+ * lookup table, if the table agrees with the function within this tolerance
  * @return a new dataframe containing the new column
  */
 auto zPtMassReweighting(auto &df, const std::string &weightname,
                         const std::string &gen_boson,
                         const std::string &workspace_file,
                         const std::string &functor_name,
-                        const std::string &argset) {
+                        const std::string &argset,
+                        const double tabulation_tolerance = -1.) {
 
     // retrieve pt and mass of gen boson reconstructed with the method used by
     // recoil corrections; resulting quantities are only for the purpose of this
@@ -136,8 +147,9 @@ auto zPtMassReweighting(auto &df, const std::string &weightname,
         ->debug("zPtMassReweighting - Function {} // argset {}", functor_name,
                 argset);
 
-    const std::shared_ptr<RooFunctorThreadsafe> weight_function =
-        loadFunctor(workspace_file, functor_name, argset);
+    const std::shared_ptr<RooFunctorPerSlot> weight_function =
+        loadFunctor(workspace_file, functor_name, argset, df2.GetNSlots(),
+                    tabulation_tolerance);
     auto df3 = basefunctions::evaluateWorkspaceFunction(
         df2, weightname, weight_function, gen_boson + "_mass",
         gen_boson + "_pt");
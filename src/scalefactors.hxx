@@ -18,18 +18,22 @@ namespace muon {
  * @param workspace_name path to the Rooworkspace
  * @param id_functor_name name of the function from the workspace
  * @param id_arguments arguments of the function
+ * @param tabulation_tolerance if not negative, the function is replaced by a
+ * lookup table, if the table agrees with the function within this tolerance
  * @return a new dataframe containing the new column
  */
 auto id(auto &df, const std::string &pt, const std::string &eta,
         const std::string &id_output, const std::string &workspace_name,
-        const std::string &id_functor_name, const std::string &id_arguments) {
+        const std::string &id_functor_name, const std::string &id_arguments,
+        const double tabulation_tolerance = -1.) {
 
     Logger::get("muonsf")->debug("Setting up functions for muon sf");
     Logger::get("muonsf")->debug("ID - Function {} // argset {}",
                                  id_functor_name, id_arguments);
 
-    const std::shared_ptr<RooFunctorThreadsafe> id_function =
-        loadFunctor(workspace_name, id_functor_name, id_arguments);
+    const std::shared_ptr<RooFunctorPerSlot> id_function =
+        loadFunctor(workspace_name, id_functor_name, id_arguments,
+                    df.GetNSlots(), tabulation_tolerance);
     auto df1 = basefunctions::evaluateWorkspaceFunction(df, id_output,
                                                         id_function, pt, eta);
     return df1;
@@ -45,19 +49,23 @@ auto id(auto &df, const std::string &pt, const std::string &eta,
  * @param workspace_name path to the Rooworkspace
  * @param iso_functor_name name of the function from the workspace
  * @param iso_arguments arguments of the function
+ * @param tabulation_tolerance if not negative, the function is replaced by a
+ * lookup table, if the table agrees with the function within this tolerance
  * @return a new dataframe containing the new column
  */
 auto iso(auto &df, const std::string &pt, const std::string &eta,
          const std::string &iso, const std::string &iso_output,
          const std::string &workspace_name, const std::string &iso_functor_name,
-         const std::string &iso_arguments) {
+         const std::string &iso_arguments,
+         const double tabulation_tolerance = -1.) {
 
     Logger::get("muonsf")->debug("Setting up functions for muon sf");
     Logger::get("muonsf")->debug("Iso - Function {} // argset {}",
                                  iso_functor_name, iso_arguments);
 
-    const std::shared_ptr<RooFunctorThreadsafe> iso_function =
-        loadFunctor(workspace_name, iso_functor_name, iso_arguments);
+    const std::shared_ptr<RooFunctorPerSlot> iso_function =
+        loadFunctor(workspace_name, iso_functor_name, iso_arguments,
+                    df.GetNSlots(), tabulation_tolerance);
     auto df1 = basefunctions::evaluateWorkspaceFunction(
         df, iso_output, iso_function, pt, eta, iso);
     return df1;
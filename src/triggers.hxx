@@ -5,12 +5,144 @@
 #include <Math/Vector3D.h>
 #include <Math/Vector4D.h>
 #include <Math/VectorUtil.h>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 typedef std::bitset<20> IntBits;
 
 namespace trigger {
 
+/// Per-event view of the trigger objects, built once per event from the
+/// `TrigObj_*` columns and shared by all trigger flags. The objects are
+/// grouped by their trigger object id, so that the matching of a path only
+/// scans the objects with the required id.
+class TriggerObjectView {
+  public:
+    /// trigger object ids are stored in buckets 0 to maxId - 1, objects with
+    /// other ids can not be matched
+    static constexpr int maxId = 32;
+    /// maximal number of trigger objects per event, further objects are
+    /// ignored
+    static constexpr std::size_t maxObjects = 512;
+    using MatchedObjects = std::bitset<maxObjects>;
+
+    TriggerObjectView() = default;
+    TriggerObjectView(const ROOT::RVec<int> &ids, const ROOT::RVec<int> &bits,
+                      const ROOT::RVec<float> &pts,
+                      const ROOT::RVec<float> &etas,
+                      const ROOT::RVec<float> &phis) {
+        // counting sort of the objects by id
+        if (ids.size() > maxObjects) {
+            static std::once_flag warned;
+            std::call_once(warned, [&ids]() {
+                Logger::get("TriggerObjectView")
+                    ->warn("Event with {} trigger objects, only the first {} "
+                           "are used for the trigger matching",
+                           ids.size(), maxObjects);
+            });
+        }
+        std::array<std::uint16_t, maxId + 1> counts{};
+        const std::size_t nobjects = std::min(ids.size(), maxObjects);
+        for (std::size_t i = 0; i < nobjects; ++i) {
+            if (ids[i] >= 0 && ids[i] < maxId)
+                ++counts[ids[i] + 1];
+        }
+        for (int id = 0; id < maxId; ++id)
+            _offsets[id + 1] = _offsets[id] + counts[id + 1];
+        const std::size_t nselected = _offsets[maxId];
+        _bits.resize(nselected);
+        _pts.resize(nselected);
+        _etas.resize(nselected);
+        _phis.resize(nselected);
+        auto position = _offsets;
+        for (std::size_t i = 0; i < nobjects; ++i) {
+            if (ids[i] < 0 || ids[i] >= maxId)
+                continue;
+            const std::size_t j = position[ids[i]]++;
+            _bits[j] = bits[i];
+            _pts[j] = pts[i];
+            _etas[j] = etas[i];
+            _phis[j] = phis[i];
+        }
+    }
+
+    /// first index of the objects with the given id
+    std::size_t begin(int id) const {
+        return (id >= 0 && id < maxId) ? _offsets[id] : 0;
+    }
+    /// index after the last object with the given id
+    std::size_t end(int id) const {
+        return (id >= 0 && id < maxId) ? _offsets[id + 1] : 0;
+    }
+    std::size_t size() const { return _pts.size(); }
+
+    int bits(std::size_t i) const { return _bits[i]; }
+    float pt(std::size_t i) const { return _pts[i]; }
+    float eta(std::size_t i) const { return _etas[i]; }
+    float phi(std::size_t i) const { return _phis[i]; }
+
+  private:
+    std::array<std::uint16_t, maxId + 1> _offsets{};
+    ROOT::RVec<int> _bits;
+    ROOT::RVec<float> _pts;
+    ROOT::RVec<float> _etas;
+    ROOT::RVec<float> _phis;
+};
+
+/// Requirements on the trigger object matched to a particle. The cuts are
+/// converted once at setup time into the form used in the event loop.
+struct TriggerObjectRequirement {
+    TriggerObjectRequirement(const float pt_cut, const float eta_cut,
+                             const int trigger_particle_id_cut,
+                             const int triggerbit_cut, const float matchDeltaR)
+        : pt_cut(pt_cut), eta_cut(eta_cut), id(trigger_particle_id_cut),
+          // a triggerbit_cut of 0 means that no bit is required
+          bitmask(triggerbit_cut == 0 ? 0 : 1 << triggerbit_cut),
+          deltaR2(matchDeltaR * matchDeltaR) {}
+
+    float pt_cut;
+    float eta_cut;
+    int id;
+    int bitmask;
+    float deltaR2;
+};
+
+/**
+ * @brief Function used to build the trigger object view of an event, which is
+ * used by the trigger flag producers for the trigger object matching.
+ *
+ * @param df The input dataframe
+ * @param outputname name of the view column
+ * @param triggerobject_bits name of the trigger object bits column
+ * @param triggerobject_id name of the trigger object id column
+ * @param triggerobject_pt name of the trigger object pt column
+ * @param triggerobject_eta name of the trigger object eta column
+ * @param triggerobject_phi name of the trigger object phi column
+ * @return a new dataframe containing the view column
+ */
+auto TriggerObjects(auto &df, const std::string &outputname,
+                    const std::string &triggerobject_bits,
+                    const std::string &triggerobject_id,
+                    const std::string &triggerobject_pt,
+                    const std::string &triggerobject_eta,
+                    const std::string &triggerobject_phi) {
+    auto buildView = [](const ROOT::RVec<int> &bits,
+                        const ROOT::RVec<int> &ids,
+                        const ROOT::RVec<float> &pts,
+                        const ROOT::RVec<float> &etas,
+                        const ROOT::RVec<float> &phis) {
+        return TriggerObjectView(ids, bits, pts, etas, phis);
+    };
+    return df.Define(outputname, buildView,
+                     {triggerobject_bits, triggerobject_id, triggerobject_pt,
+                      triggerobject_eta, triggerobject_phi});
+}
+
 /**
  * @brief Function used to try and match a object with a trigger object. An
 oject is successfully matched, if they overlap within the given deltaR cone
@@ -86,81 +218,57 @@ no match                                |  0    | -
 VBF cross-cleaned from loose iso PFTau |  1    | 1
  * @param particle the `ROOT::Math::PtEtaPhiMVector` vector of the object to
 match
- * @param triggerobject_pts `ROOT::RVec<float>` of trigger object pts
- * @param triggerobject_etas `ROOT::RVec<float>` of trigger object etas
- * @param triggerobject_phis `ROOT::RVec<float>` of trigger object phis
- * @param triggerobject_bits `ROOT::RVec<float>` of trigger object bits.
-Depending on the trigger object id, this bitmap has a different meaning as
-listed in th table above.
- * @param triggerobject_ids `ROOT::RVec<float>` of trigger object ids. The ID
-encoding is explained above.
- * @param matchDeltaR The maximum deltaR value used for the match
- * @param pt_cut pt cut value on the trigger object pt
- * @param eta_cut eta cut value on the trigger object eta
- * @param trigger_particle_id_cut the triggerobject id required
- * @param triggerbit_cut the triggerobject filter bit position required
+ * @param triggerobjects the trigger object view of the event, see
+trigger::TriggerObjectView. Depending on the trigger object id, the bitmap of
+the objects has a different meaning as listed in th table above.
+ * @param requirement the cuts on the trigger object, see
+trigger::TriggerObjectRequirement
+ * @param matched objects, which were already matched to another particle of the
+same trigger path. The matched object is added to this set, so that it cant be
+matched by the next particle as well.
  * @return true, if all criteria are met, false otherwise
  */
 
 bool matchParticle(const ROOT::Math::PtEtaPhiMVector &particle,
-                   ROOT::RVec<float> triggerobject_pts,
-                   ROOT::RVec<float> triggerobject_etas,
-                   ROOT::RVec<float> triggerobject_phis,
-                   ROOT::RVec<int> triggerobject_bits,
-                   ROOT::RVec<int> triggerobject_ids, const float matchDeltaR,
-                   const float &pt_cut, const float &eta_cut,
-                   const int &trigger_particle_id_cut,
-                   const int &triggerbit_cut) {
-    Logger::get("CheckTriggerMatch")->debug("Checking Triggerobjects");
-    Logger::get("CheckTriggerMatch")
-        ->debug("Total number of triggerobjects: {}", triggerobject_pts.size());
-    for (std::size_t idx = 0; idx < triggerobject_pts.size(); ++idx) {
-        Logger::get("CheckTriggerMatch")->debug("Triggerobject Nr. {}", idx);
-        Logger::get("CheckTriggerMatch")
-            ->debug("bit Value: {}", IntBits(triggerobject_bits[idx]));
-        Logger::get("CheckTriggerMatch")
-            ->debug("bit Value: {}", triggerobject_bits[idx]);
-        auto triggerobject = ROOT::Math::RhoEtaPhiVectorF(
-            0, triggerobject_etas[idx], triggerobject_phis[idx]);
+                   const TriggerObjectView &triggerobjects,
+                   const TriggerObjectRequirement &requirement,
+                   TriggerObjectView::MatchedObjects &matched) {
+    // this function is called for every event, so resolve the logger only once
+    static const auto log = Logger::get("CheckTriggerMatch");
+    SPDLOG_LOGGER_DEBUG(log, "Checking Triggerobjects");
+    SPDLOG_LOGGER_DEBUG(log, "Total number of triggerobjects: {}",
+                        triggerobjects.size());
+    const float particle_eta = particle.eta();
+    const float particle_phi = particle.phi();
+    // only the objects with the required id are checked
+    for (std::size_t idx = triggerobjects.begin(requirement.id);
+         idx < triggerobjects.end(requirement.id); ++idx) {
+        SPDLOG_LOGGER_DEBUG(log, "Triggerobject Nr. {}", idx);
+        SPDLOG_LOGGER_DEBUG(log, "bit Value: {}",
+                            IntBits(triggerobjects.bits(idx)));
         // We check the deltaR match as well as that the pt and eta of the
         // triggerobject are above the given thresholds
-        bool deltaR = ROOT::Math::VectorUtil::DeltaR(triggerobject, particle) <
-                      matchDeltaR;
-        // if we don't want to do any matching here, the triggerbut_cut value is
-        // 0
-        bool bit = (triggerbit_cut == 0) |
-                   (IntBits(triggerobject_bits[idx]).test(triggerbit_cut));
-        bool id = triggerobject_ids[idx] == trigger_particle_id_cut;
-        bool pt = triggerobject_pts[idx] > pt_cut;
-        bool eta = abs(triggerobject_etas[idx]) < eta_cut;
-        Logger::get("CheckTriggerMatch")
-            ->debug("-------------------------------------------------------");
-        Logger::get("CheckTriggerMatch")->debug("deltaR Check: {}", deltaR);
-        Logger::get("CheckTriggerMatch")
-            ->debug("deltaR Value: {}",
-                    ROOT::Math::VectorUtil::DeltaR(triggerobject, particle));
-        Logger::get("CheckTriggerMatch")->debug("id Check: {}", id);
-        Logger::get("CheckTriggerMatch")
-            ->debug("id Value: {}", triggerobject_ids[idx]);
-        Logger::get("CheckTriggerMatch")->debug("bit Check: {}", bit);
-        Logger::get("CheckTriggerMatch")
-            ->debug("bit Value: {}", IntBits(triggerobject_bits[idx]));
-        Logger::get("CheckTriggerMatch")->debug("pt Check: {}", pt);
-        Logger::get("CheckTriggerMatch")
-            ->debug("pt Value: {}", triggerobject_pts[idx]);
-        Logger::get("CheckTriggerMatch")->debug("eta Check: {}", eta);
-        Logger::get("CheckTriggerMatch")
-            ->debug("eta Value: {}", triggerobject_etas[idx]);
-        Logger::get("CheckTriggerMatch")
-            ->debug("-------------------------------------------------------");
-        if (deltaR && bit && id && pt && eta) {
-            // remove the matching object from the object vectors so it cant be
-            // matched by the next particle as well (if there is one)
-            triggerobject_ids.erase(triggerobject_ids.begin() + idx);
-            triggerobject_bits.erase(triggerobject_bits.begin() + idx);
-            triggerobject_pts.erase(triggerobject_pts.begin() + idx);
-            triggerobject_etas.erase(triggerobject_etas.begin() + idx);
-            triggerobject_phis.erase(triggerobject_phis.begin() + idx);
+        const float deta = triggerobjects.eta(idx) - particle_eta;
+        const float dphi = ROOT::VecOps::DeltaPhi(triggerobjects.phi(idx),
+                                                  particle_phi);
+        bool deltaR = deta * deta + dphi * dphi < requirement.deltaR2;
+        bool bit = (triggerobjects.bits(idx) & requirement.bitmask) ==
+                   requirement.bitmask;
+        bool pt = triggerobjects.pt(idx) > requirement.pt_cut;
+        bool eta = std::abs(triggerobjects.eta(idx)) < requirement.eta_cut;
+        SPDLOG_LOGGER_DEBUG(
+            log, "-------------------------------------------------------");
+        SPDLOG_LOGGER_DEBUG(log, "deltaR Check: {}", deltaR);
+        SPDLOG_LOGGER_DEBUG(log, "bit Check: {}", bit);
+        SPDLOG_LOGGER_DEBUG(log, "pt Check: {}", pt);
+        SPDLOG_LOGGER_DEBUG(log, "pt Value: {}", triggerobjects.pt(idx));
+        SPDLOG_LOGGER_DEBUG(log, "eta Check: {}", eta);
+        SPDLOG_LOGGER_DEBUG(log, "eta Value: {}", triggerobjects.eta(idx));
+        SPDLOG_LOGGER_DEBUG(log, "already matched: {}", matched.test(idx));
+        SPDLOG_LOGGER_DEBUG(
+            log, "-------------------------------------------------------");
+        if (deltaR && bit && pt && eta && !matched.test(idx)) {
+            matched.set(idx);
             return true;
         }
     }
@@ -174,14 +282,8 @@ bool matchParticle(const ROOT::Math::PtEtaPhiMVector &particle,
  * @param df The input dataframe
  * @param triggerflag_name name of the output flag
  * @param particle_p4 `ROOT::Math::PtEtaPhiMVector` of the object to be checked
- * @param triggerobject_bits name of the trigger object bits column in the
- * inputfile
- * @param triggerobject_id name of the trigger object id column in the inputfile
- * @param triggerobject_pt name of the trigger object pt column in the inputfile
- * @param triggerobject_eta name of the trigger object eta column in the
- * inputfile
- * @param triggerobject_phi name of the trigger object phi column in the
- * inputfile
+ * @param triggerobjects name of the trigger object view column, as created by
+ * trigger::TriggerObjects
  * @param hltpath name of the hlt path to be checked
  * @param pt_cut minimal pt value for the triggerobject
  * @param eta_cut maximal pt value for the triggerobject
@@ -196,47 +298,37 @@ bool matchParticle(const ROOT::Math::PtEtaPhiMVector &particle,
 
 auto GenerateSingleTriggerFlag(
     auto df, const std::string &triggerflag_name,
-    const std::string &particle_p4, const std::string &triggerobject_bits,
-    const std::string &triggerobject_id, const std::string &triggerobject_pt,
-    const std::string &triggerobject_eta, const std::string &triggerobject_phi,
+    const std::string &particle_p4, const std::string &triggerobjects,
     const std::string &hltpath, const float &pt_cut, const float &eta_cut,
     const int &trigger_particle_id_cut, const int &triggerbit_cut,
     const float &DeltaR_threshold) {
 
-    auto triggermatch =
-        [DeltaR_threshold, pt_cut, eta_cut, trigger_particle_id_cut,
-         triggerbit_cut](bool hltpath,
-                         const ROOT::Math::PtEtaPhiMVector &particle_p4,
-                         ROOT::RVec<int> triggerobject_bits,
-                         ROOT::RVec<int> triggerobject_ids,
-                         ROOT::RVec<float> triggerobject_pts,
-                         ROOT::RVec<float> triggerobject_etas,
-                         ROOT::RVec<float> triggerobject_phis) {
-            Logger::get("GenerateSingleTriggerFlag")->debug("Checking Trigger");
-            bool result = false;
-            bool match_result = false;
-            if (hltpath) {
-                Logger::get("CheckTriggerMatch")
-                    ->debug("Checking Triggerobject match with particles ....");
-                match_result = matchParticle(
-                    particle_p4, triggerobject_pts, triggerobject_etas,
-                    triggerobject_phis, triggerobject_bits, triggerobject_ids,
-                    DeltaR_threshold, pt_cut, eta_cut, trigger_particle_id_cut,
-                    triggerbit_cut);
-            }
-            result = hltpath & match_result;
-            Logger::get("GenerateSingleTriggerFlag")
-                ->debug("---> HLT Match: {}", hltpath);
-            Logger::get("GenerateSingleTriggerFlag")
-                ->debug("---> Total Match: {}", match_result);
-            Logger::get("GenerateSingleTriggerFlag")
-                ->debug("--->>>> result: {}", result);
-            return result;
-        };
-    auto df1 =
-        df.Define(triggerflag_name, triggermatch,
-                  {hltpath, particle_p4, triggerobject_bits, triggerobject_id,
-                   triggerobject_pt, triggerobject_eta, triggerobject_phi});
+    auto log = Logger::get("GenerateSingleTriggerFlag");
+    const TriggerObjectRequirement requirement(
+        pt_cut, eta_cut, trigger_particle_id_cut, triggerbit_cut,
+        DeltaR_threshold);
+    auto triggermatch = [log, requirement](
+                            bool hltpath,
+                            const ROOT::Math::PtEtaPhiMVector &particle_p4,
+                            const TriggerObjectView &triggerobjects) {
+        SPDLOG_LOGGER_DEBUG(log, "Checking Trigger");
+        bool result = false;
+        bool match_result = false;
+        if (hltpath) {
+            SPDLOG_LOGGER_DEBUG(
+                log, "Checking Triggerobject match with particles ....");
+            TriggerObjectView::MatchedObjects matched;
+            match_result = matchParticle(particle_p4, triggerobjects,
+                                         requirement, matched);
+        }
+        result = hltpath & match_result;
+        SPDLOG_LOGGER_DEBUG(log, "---> HLT Match: {}", hltpath);
+        SPDLOG_LOGGER_DEBUG(log, "---> Total Match: {}", match_result);
+        SPDLOG_LOGGER_DEBUG(log, "--->>>> result: {}", result);
+        return result;
+    };
+    auto df1 = df.Define(triggerflag_name, triggermatch,
+                         {hltpath, particle_p4, triggerobjects});
     return df1;
 }
 
@@ -253,14 +345,8 @@ auto GenerateSingleTriggerFlag(
  * checked
  * @param particle2_p4 `ROOT::Math::PtEtaPhiMVector` of the second object to be
  * checked
- * @param triggerobject_bits name of the trigger object bits column in the
- * inputfile
- * @param triggerobject_id name of the trigger object id column in the inputfile
- * @param triggerobject_pt name of the trigger object pt column in the inputfile
- * @param triggerobject_eta name of the trigger object eta column in the
- * inputfile
- * @param triggerobject_phi name of the trigger object phi column in the
- * inputfile
+ * @param triggerobjects name of the trigger object view column, as created by
+ * trigger::TriggerObjects
  * @param hltpath name of the hlt path to be checked
  * @param p1_pt_cut minimal pt value for the triggerobject matching the first
  * object
@@ -291,60 +377,293 @@ auto GenerateSingleTriggerFlag(
 auto GenerateDoubleTriggerFlag(
     auto df, const std::string &triggerflag_name,
     const std::string &particle1_p4, const std::string &particle2_p4,
-    const std::string &triggerobject_bits, const std::string &triggerobject_id,
-    const std::string &triggerobject_pt, const std::string &triggerobject_eta,
-    const std::string &triggerobject_phi, const std::string &hltpath,
+    const std::string &triggerobjects, const std::string &hltpath,
     const float &p1_pt_cut, const float &p2_pt_cut, const float &p1_eta_cut,
     const float &p2_eta_cut, const int &p1_trigger_particle_id_cut,
     const int &p2_trigger_particle_id_cut, const int &p1_triggerbit_cut,
     const int &p2_triggerbit_cut, const float &DeltaR_threshold) {
 
+    auto log = Logger::get("GenerateDoubleTriggerFlag");
+    const TriggerObjectRequirement p1_requirement(
+        p1_pt_cut, p1_eta_cut, p1_trigger_particle_id_cut, p1_triggerbit_cut,
+        DeltaR_threshold);
+    const TriggerObjectRequirement p2_requirement(
+        p2_pt_cut, p2_eta_cut, p2_trigger_particle_id_cut, p2_triggerbit_cut,
+        DeltaR_threshold);
     auto triggermatch =
-        [DeltaR_threshold, p1_pt_cut, p2_pt_cut, p1_eta_cut, p2_eta_cut,
-         p1_trigger_particle_id_cut, p2_trigger_particle_id_cut,
-         p1_triggerbit_cut, p2_triggerbit_cut](
-            bool hltpath, const ROOT::Math::PtEtaPhiMVector &particle1_p4,
-            const ROOT::Math::PtEtaPhiMVector &particle2_p4,
-            ROOT::RVec<int> triggerobject_bits,
-            ROOT::RVec<int> triggerobject_ids,
-            ROOT::RVec<float> triggerobject_pts,
-            ROOT::RVec<float> triggerobject_etas,
-            ROOT::RVec<float> triggerobject_phis) {
-            Logger::get("GenerateDoubleTriggerFlag")->debug("Checking Trigger");
+        [log, p1_requirement,
+         p2_requirement](bool hltpath,
+                         const ROOT::Math::PtEtaPhiMVector &particle1_p4,
+                         const ROOT::Math::PtEtaPhiMVector &particle2_p4,
+                         const TriggerObjectView &triggerobjects) {
+            SPDLOG_LOGGER_DEBUG(log, "Checking Trigger");
             bool result = false;
             bool match_result_p1 = false;
             bool match_result_p2 = false;
             if (hltpath) {
-                Logger::get("GenerateDoubleTriggerFlag")
-                    ->debug("Checking Triggerobject match with particles ....");
-                match_result_p1 = matchParticle(
-                    particle1_p4, triggerobject_pts, triggerobject_etas,
-                    triggerobject_phis, triggerobject_bits, triggerobject_ids,
-                    DeltaR_threshold, p1_pt_cut, p1_eta_cut,
-                    p1_trigger_particle_id_cut, p1_triggerbit_cut);
-                match_result_p2 = matchParticle(
-                    particle2_p4, triggerobject_pts, triggerobject_etas,
-                    triggerobject_phis, triggerobject_bits, triggerobject_ids,
-                    DeltaR_threshold, p2_pt_cut, p2_eta_cut,
-                    p2_trigger_particle_id_cut, p2_triggerbit_cut);
+                SPDLOG_LOGGER_DEBUG(
+                    log, "Checking Triggerobject match with particles ....");
+                // an object matched to the first particle can not be matched
+                // to the second one
+                TriggerObjectView::MatchedObjects matched;
+                match_result_p1 = matchParticle(particle1_p4, triggerobjects,
+                                                p1_requirement, matched);
+                match_result_p2 = matchParticle(particle2_p4, triggerobjects,
+                                                p2_requirement, matched);
             }
             result = hltpath & match_result_p1 & match_result_p2;
-            Logger::get("GenerateDoubleTriggerFlag")
-                ->debug("---> HLT Match: {}", hltpath);
-            Logger::get("GenerateDoubleTriggerFlag")
-                ->debug("---> Total Match P1: {}", match_result_p1);
-            Logger::get("GenerateDoubleTriggerFlag")
-                ->debug("---> Total Match P2: {}", match_result_p2);
-            Logger::get("GenerateDoubleTriggerFlag")
-                ->debug("--->>>> result: {}", result);
+            SPDLOG_LOGGER_DEBUG(log, "---> HLT Match: {}", hltpath);
+            SPDLOG_LOGGER_DEBUG(log, "---> Total Match P1: {}",
+                                match_result_p1);
+            SPDLOG_LOGGER_DEBUG(log, "---> Total Match P2: {}",
+                                match_result_p2);
+            SPDLOG_LOGGER_DEBUG(log, "--->>>> result: {}", result);
             return result;
         };
     auto df1 =
         df.Define(triggerflag_name, triggermatch,
-                  {hltpath, particle1_p4, particle2_p4, triggerobject_bits,
-                   triggerobject_id, triggerobject_pt, triggerobject_eta,
-                   triggerobject_phi});
+                  {hltpath, particle1_p4, particle2_p4, triggerobjects});
     return df1;
 }
 
+/// Helper to pass the particles, the trigger object view and the decisions of
+/// N hlt paths to a function. The hlt decisions are collected in a
+/// `std::array<bool, N>`, so that the number of paths can be chosen in the
+/// configuration. The types of the columns before the hlt decisions are given
+/// by Leading.
+template <typename I, typename F, typename... Leading> class PassHltPathsHelper;
+
+template <std::size_t... N, typename F, typename... Leading>
+class PassHltPathsHelper<std::index_sequence<N...>, F, Leading...> {
+    template <std::size_t Idx> using AlwaysBool = bool;
+    typename std::decay<F>::type fFunc;
+
+  public:
+    PassHltPathsHelper(F &&f) : fFunc(std::forward<F>(f)) {}
+    auto operator()(const Leading &...leading, AlwaysBool<N>... hltpaths) {
+        return fFunc(leading...,
+                     std::array<bool, sizeof...(N)>{hltpaths...});
+    }
+};
+
+template <std::size_t N, typename... Leading, typename F>
+auto PassHltPaths(F &&f)
+    -> PassHltPathsHelper<std::make_index_sequence<N>, F, Leading...> {
+    return PassHltPathsHelper<std::make_index_sequence<N>, F, Leading...>(
+        std::forward<F>(f));
+}
+
+/**
+ * @brief Function to generate the trigger flags of several hlt paths in a
+ * single step. For each path, the hlt decision and the trigger object
+ * matching of the first and, if required, the second particle are checked as
+ * in trigger::GenerateSingleTriggerFlag and trigger::GenerateDoubleTriggerFlag.
+ * The results are packed into a single `std::uint64_t` column, where bit `i`
+ * is set if path `i` fired and all required particles were matched. The flags
+ * of the individual paths can be obtained with trigger::UnpackTriggerFlag.
+ *
+ * @tparam NPaths number of hlt paths, at most 64
+ * @param df The input dataframe
+ * @param outputname name of the packed trigger flag column
+ * @param particle1_p4 `ROOT::Math::PtEtaPhiMVector` of the first object to be
+ * checked
+ * @param particle2_p4 `ROOT::Math::PtEtaPhiMVector` of the second object to be
+ * checked
+ * @param triggerobjects name of the trigger object view column, as created by
+ * trigger::TriggerObjects
+ * @param hltpaths names of the hlt paths to be checked
+ * @param p1_pt_cuts minimal pt values for the triggerobject matching the first
+ * object, one per path
+ * @param p2_pt_cuts minimal pt values for the triggerobject matching the
+ * second object, one per path
+ * @param p1_eta_cuts maximal eta values for the triggerobject matching the
+ * first object, one per path
+ * @param p2_eta_cuts maximal eta values for the triggerobject matching the
+ * second object, one per path
+ * @param p1_trigger_particle_id_cuts trigger id values the triggerobject
+ * matching the first object has to match, one per path
+ * @param p2_trigger_particle_id_cuts trigger id values the triggerobject
+ * matching the second object has to match, one per path. A negative value
+ * means, that the path only requires the first object to be matched.
+ * @param p1_triggerbit_cuts trigger bit values the triggerobject matching the
+ * first object has to match, one per path
+ * @param p2_triggerbit_cuts trigger bit values the triggerobject matching the
+ * second object has to match, one per path
+ * @param DeltaR_thresholds maximal values for the deltaR between the
+ * triggerobject and the input object to consider a match, one per path
+ * @return a new dataframe containing the packed trigger flag column
+ */
+template <std::size_t NPaths>
+auto GeneratePackedTriggerFlags(
+    auto df, const std::string &outputname, const std::string &particle1_p4,
+    const std::string &particle2_p4, const std::string &triggerobjects,
+    const std::vector<std::string> &hltpaths,
+    const std::vector<float> &p1_pt_cuts, const std::vector<float> &p2_pt_cuts,
+    const std::vector<float> &p1_eta_cuts,
+    const std::vector<float> &p2_eta_cuts,
+    const std::vector<int> &p1_trigger_particle_id_cuts,
+    const std::vector<int> &p2_trigger_particle_id_cuts,
+    const std::vector<int> &p1_triggerbit_cuts,
+    const std::vector<int> &p2_triggerbit_cuts,
+    const std::vector<float> &DeltaR_thresholds) {
+    static_assert(NPaths > 0 && NPaths <= 64,
+                  "The packed trigger flag can hold 1 to 64 paths");
+
+    auto log = Logger::get("GeneratePackedTriggerFlags");
+    for (const auto size :
+         {hltpaths.size(), p1_pt_cuts.size(), p2_pt_cuts.size(),
+          p1_eta_cuts.size(), p2_eta_cuts.size(),
+          p1_trigger_particle_id_cuts.size(),
+          p2_trigger_particle_id_cuts.size(), p1_triggerbit_cuts.size(),
+          p2_triggerbit_cuts.size(), DeltaR_thresholds.size()}) {
+        if (size != NPaths) {
+            log->critical("Packed trigger flag {} expects {} entries per "
+                          "requirement, but got {}",
+                          outputname, NPaths, size);
+            throw std::runtime_error("Inconsistent trigger path requirements");
+        }
+    }
+    std::vector<TriggerObjectRequirement> p1_requirements;
+    std::vector<TriggerObjectRequirement> p2_requirements;
+    for (std::size_t i = 0; i < NPaths; ++i) {
+        p1_requirements.emplace_back(p1_pt_cuts[i], p1_eta_cuts[i],
+                                     p1_trigger_particle_id_cuts[i],
+                                     p1_triggerbit_cuts[i],
+                                     DeltaR_thresholds[i]);
+        p2_requirements.emplace_back(p2_pt_cuts[i], p2_eta_cuts[i],
+                                     p2_trigger_particle_id_cuts[i],
+                                     p2_triggerbit_cuts[i],
+                                     DeltaR_thresholds[i]);
+    }
+    auto triggermatch = [log, p1_requirements, p2_requirements](
+                            const ROOT::Math::PtEtaPhiMVector &particle1_p4,
+                            const ROOT::Math::PtEtaPhiMVector &particle2_p4,
+                            const TriggerObjectView &triggerobjects,
+                            const std::array<bool, NPaths> &hltpaths) {
+        std::uint64_t flags = 0;
+        for (std::size_t i = 0; i < NPaths; ++i) {
+            if (!hltpaths[i])
+                continue;
+            TriggerObjectView::MatchedObjects matched;
+            bool match_result =
+                matchParticle(particle1_p4, triggerobjects,
+                              p1_requirements[i], matched) &&
+                (p2_requirements[i].id < 0 ||
+                 matchParticle(particle2_p4, triggerobjects,
+                               p2_requirements[i], matched));
+            SPDLOG_LOGGER_DEBUG(log, "---> Path {}: {}", i, match_result);
+            if (match_result)
+                flags |= std::uint64_t(1) << i;
+        }
+        return flags;
+    };
+    std::vector<std::string> columns = {particle1_p4, particle2_p4,
+                                        triggerobjects};
+    columns.insert(columns.end(), hltpaths.begin(), hltpaths.end());
+    return df.Define(outputname,
+                     PassHltPaths<NPaths, ROOT::Math::PtEtaPhiMVector,
+                                  ROOT::Math::PtEtaPhiMVector,
+                                  TriggerObjectView>(std::move(triggermatch)),
+                     columns);
+}
+
+/**
+ * @brief Function to generate the trigger flags of several hlt paths, which
+ * only require a single particle, see trigger::GeneratePackedTriggerFlags.
+ * The flags do not depend on a second particle, so they are not affected by
+ * its systematic shifts.
+ *
+ * @tparam NPaths number of hlt paths, at most 64
+ * @param df The input dataframe
+ * @param outputname name of the packed trigger flag column
+ * @param particle_p4 `ROOT::Math::PtEtaPhiMVector` of the object to be checked
+ * @param triggerobjects name of the trigger object view column, as created by
+ * trigger::TriggerObjects
+ * @param hltpaths names of the hlt paths to be checked
+ * @param pt_cuts minimal pt values for the triggerobject, one per path
+ * @param eta_cuts maximal eta values for the triggerobject, one per path
+ * @param trigger_particle_id_cuts trigger id values the triggerobject has to
+ * match, one per path
+ * @param triggerbit_cuts trigger bit values the triggerobject has to match,
+ * one per path
+ * @param DeltaR_thresholds maximal values for the deltaR between the
+ * triggerobject and the input object to consider a match, one per path
+ * @return a new dataframe containing the packed trigger flag column
+ */
+template <std::size_t NPaths>
+auto GeneratePackedSingleTriggerFlags(
+    auto df, const std::string &outputname, const std::string &particle_p4,
+    const std::string &triggerobjects,
+    const std::vector<std::string> &hltpaths,
+    const std::vector<float> &pt_cuts, const std::vector<float> &eta_cuts,
+    const std::vector<int> &trigger_particle_id_cuts,
+    const std::vector<int> &triggerbit_cuts,
+    const std::vector<float> &DeltaR_thresholds) {
+    static_assert(NPaths > 0 && NPaths <= 64,
+                  "The packed trigger flag can hold 1 to 64 paths");
+
+    auto log = Logger::get("GeneratePackedSingleTriggerFlags");
+    for (const auto size :
+         {hltpaths.size(), pt_cuts.size(), eta_cuts.size(),
+          trigger_particle_id_cuts.size(), triggerbit_cuts.size(),
+          DeltaR_thresholds.size()}) {
+        if (size != NPaths) {
+            log->critical("Packed trigger flag {} expects {} entries per "
+                          "requirement, but got {}",
+                          outputname, NPaths, size);
+            throw std::runtime_error("Inconsistent trigger path requirements");
+        }
+    }
+    std::vector<TriggerObjectRequirement> requirements;
+    for (std::size_t i = 0; i < NPaths; ++i) {
+        requirements.emplace_back(pt_cuts[i], eta_cuts[i],
+                                  trigger_particle_id_cuts[i],
+                                  triggerbit_cuts[i], DeltaR_thresholds[i]);
+    }
+    auto triggermatch = [log, requirements](
+                            const ROOT::Math::PtEtaPhiMVector &particle_p4,
+                            const TriggerObjectView &triggerobjects,
+                            const std::array<bool, NPaths> &hltpaths) {
+        std::uint64_t flags = 0;
+        for (std::size_t i = 0; i < NPaths; ++i) {
+            if (!hltpaths[i])
+                continue;
+            TriggerObjectView::MatchedObjects matched;
+            const bool match_result = matchParticle(
+                particle_p4, triggerobjects, requirements[i], matched);
+            SPDLOG_LOGGER_DEBUG(log, "---> Path {}: {}", i, match_result);
+            if (match_result)
+                flags |= std::uint64_t(1) << i;
+        }
+        return flags;
+    };
+    std::vector<std::string> columns = {particle_p4, triggerobjects};
+    columns.insert(columns.end(), hltpaths.begin(), hltpaths.end());
+    return df.Define(
+        outputname,
+        PassHltPaths<NPaths, ROOT::Math::PtEtaPhiMVector, TriggerObjectView>(
+            std::move(triggermatch)),
+        columns);
+}
+
+/**
+ * @brief Function to extract the flag of a single hlt path from a packed
+ * trigger flag, as created by trigger::GeneratePackedTriggerFlags.
+ *
+ * @param df The input dataframe
+ * @param triggerflag_name name of the output flag
+ * @param packed_flags name of the packed trigger flag column
+ * @param index position of the path in the packed trigger flag
+ * @return a new dataframe containing the trigger flag column
+ */
+auto UnpackTriggerFlag(auto df, const std::string &triggerflag_name,
+                       const std::string &packed_flags, const int &index) {
+    return df.Define(
+        triggerflag_name,
+        [index](const std::uint64_t packed) {
+            return bool((packed >> index) & 1);
+        },
+        {packed_flags});
+}
+
 } // end namespace trigger
\ No newline at end of file
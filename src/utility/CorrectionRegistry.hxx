@@ -0,0 +1,156 @@
+#ifndef GUARDCORRECTIONREGISTRY_H
+#define GUARDCORRECTIONREGISTRY_H
+
+#include "Logger.hxx"
+#include "TFile.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+
+/// Central registry for the correction payloads (workspace functions,
+/// histograms, graphs, correction engines) read from files during the setup
+/// of the dataframe. Each payload is identified by the file, the name of the
+/// object in the file and an additional argument string (e.g. the argument
+/// set of a workspace function). A payload is loaded only once and all
+/// producers requesting the same payload, e.g. the nominal producer and all
+/// its systematic shifts, share the same instance. The registry counts the
+/// opened files, the bytes read and the time spent for the loading, which
+/// can be logged at the end of the setup.
+class CorrectionRegistry {
+  public:
+    /// Return the payload for the given key. If it was not requested before,
+    /// the payload is created by calling `create`, which has to return a
+    /// `std::shared_ptr<T>`. This is used for payloads derived from other
+    /// payloads, e.g. functions taken from a cached workspace.
+    ///
+    /// \param[in] filename path to the file containing the payload
+    /// \param[in] object name of the object in the file
+    /// \param[in] argset additional arguments, which distinguish payloads
+    /// created from the same object
+    /// \param[in] create function creating the payload
+    ///
+    /// \returns a shared pointer to the payload
+    template <typename T, typename Creator>
+    static std::shared_ptr<T>
+    getOrCreate(const std::string &filename, const std::string &object,
+                const std::string &argset, Creator &&create) {
+        auto &instance = getInstance();
+        std::lock_guard<std::recursive_mutex> lock(instance._mutex);
+        const std::string key = filename + "|" + object + "|" + argset + "|" +
+                                typeid(T).name();
+        auto found = instance._payloads.find(key);
+        if (found != instance._payloads.end()) {
+            ++instance._statistics.cacheHits;
+            return std::static_pointer_cast<T>(
+                std::const_pointer_cast<void>(found->second));
+        }
+        Logger::get("CorrectionRegistry")
+            ->debug("Loading {} from {} ({})", object, filename, argset);
+        // only the outermost call is timed, the time of nested calls is
+        // already included
+        const bool outermost = instance._depth++ == 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<T> payload = create();
+        --instance._depth;
+        if (outermost) {
+            instance._statistics.seconds +=
+                std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+        }
+        ++instance._statistics.payloadsLoaded;
+        instance._payloads[key] = payload;
+        return payload;
+    }
+
+    /// Return the payload for the given key. If it was not requested before,
+    /// the file is opened and the payload is created by the loader, which
+    /// gets the opened file as argument and has to return a
+    /// `std::shared_ptr<T>`. The file is closed after the loading.
+    ///
+    /// \param[in] filename path to the file containing the payload
+    /// \param[in] object name of the object in the file
+    /// \param[in] argset additional arguments, which distinguish payloads
+    /// created from the same object
+    /// \param[in] loader function creating the payload from the file
+    ///
+    /// \returns a shared pointer to the payload
+    template <typename T, typename Loader>
+    static std::shared_ptr<T> get(const std::string &filename,
+                                  const std::string &object,
+                                  const std::string &argset, Loader &&loader) {
+        return getOrCreate<T>(filename, object, argset, [&]() {
+            auto &instance = getInstance();
+            std::unique_ptr<TFile> file(TFile::Open(filename.c_str(), "READ"));
+            if (!file || file->IsZombie()) {
+                Logger::get("CorrectionRegistry")
+                    ->critical("Could not open correction file {}", filename);
+                throw std::runtime_error("Could not open correction file");
+            }
+            std::shared_ptr<T> payload = loader(*file);
+            ++instance._statistics.filesOpened;
+            instance._statistics.bytesRead += file->GetBytesRead();
+            file->Close();
+            return payload;
+        });
+    }
+
+    static void releaseUnused();
+    static void logStatistics();
+
+  private:
+    struct Statistics {
+        std::size_t filesOpened = 0;
+        std::size_t payloadsLoaded = 0;
+        std::size_t cacheHits = 0;
+        long long bytesRead = 0;
+        double seconds = 0.;
+    };
+
+    CorrectionRegistry() = default;
+    static CorrectionRegistry &getInstance();
+    // recursive, as payloads can be created from other payloads
+    std::recursive_mutex _mutex;
+    Statistics _statistics;
+    int _depth = 0;
+    std::map<std::string, std::shared_ptr<const void>> _payloads;
+};
+
+CorrectionRegistry &CorrectionRegistry::getInstance() {
+    static CorrectionRegistry instance;
+    return instance;
+}
+
+/// Remove all payloads from the registry, which are not used by any producer.
+/// Payloads still in use are freed once the last user releases them.
+void CorrectionRegistry::releaseUnused() {
+    auto &instance = getInstance();
+    std::lock_guard<std::recursive_mutex> lock(instance._mutex);
+    for (auto it = instance._payloads.begin();
+         it != instance._payloads.end();) {
+        if (it->second.use_count() == 1)
+            it = instance._payloads.erase(it);
+        else
+            ++it;
+    }
+}
+
+/// Log the number of loaded payloads, opened files, bytes read and the time
+/// spent for loading the payloads
+void CorrectionRegistry::logStatistics() {
+    auto &instance = getInstance();
+    std::lock_guard<std::recursive_mutex> lock(instance._mutex);
+    const auto &statistics = instance._statistics;
+    Logger::get("CorrectionRegistry")
+        ->info("Loaded {} correction payloads ({} reused) from {} files: "
+               "{:.1f} MB read in {:.2f} s",
+               statistics.payloadsLoaded, statistics.cacheHits,
+               statistics.filesOpened, statistics.bytesRead / 1024. / 1024.,
+               statistics.seconds);
+}
+
+#endif /* GUARDCORRECTIONREGISTRY_H */
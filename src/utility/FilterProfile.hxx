@@ -0,0 +1,167 @@
+#ifndef GUARDFILTERPROFILE_H
+#define GUARDFILTERPROFILE_H
+
+#include "Logger.hxx"
+#include "ROOT/RCutFlowReport.hxx"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace utility {
+
+/// Profile of the filters of the dataframe. If enabled, the time spent in the
+/// evaluation of each named filter is measured during the event loop. Together
+/// with the cut flow reports of the scopes, this is written to a JSON file,
+/// which can be passed to the code generation with `--filter-profile` to
+/// order the filters by their rejection per unit cost. The profile has to be
+/// enabled before the filters are booked, as only the filters booked
+/// afterwards are measured.
+class FilterProfile {
+  public:
+    /// accumulated evaluation time and number of evaluations of a filter
+    struct Cost {
+        std::atomic<unsigned long long> nanoseconds{0};
+        std::atomic<unsigned long long> evaluations{0};
+    };
+
+    static void enable() { getInstance()._enabled = true; }
+    static bool enabled() { return getInstance()._enabled; }
+
+    /// Wrap the function of a filter, such that its evaluation time is added
+    /// to the cost of the filter. The returned function has the same
+    /// signature as the given one, so it can be passed to `df.Filter`. If the
+    /// profile is not enabled, the wrapper only forwards the call.
+    ///
+    /// \param[in] filtername the name of the filter, as used in the report
+    /// \param[in] function the function of the filter
+    ///
+    /// \returns the wrapped function
+    template <typename F>
+    static auto wrap(const std::string &filtername, F function) {
+        return wrapImpl(getCost(filtername), std::move(function),
+                        &F::operator());
+    }
+
+    /// Write the cut flow reports of the scopes, together with the measured
+    /// cost of each filter, to a JSON file of the form
+    ///
+    ///     {"filters": {"<scope>": [{"name": ..., "all": ..., "pass": ...,
+    ///         "evaluations": ..., "seconds": ...}, ...], ...}}
+    ///
+    /// \param[in] filename the name of the output file
+    /// \param[in] reports the cut flow report of each scope
+    static void
+    write(const std::string &filename,
+          const std::vector<std::pair<std::string, ROOT::RDF::RCutFlowReport>>
+              &reports);
+
+  private:
+    FilterProfile() = default;
+    static FilterProfile &getInstance();
+    static std::shared_ptr<Cost> getCost(const std::string &filtername);
+
+    template <typename Ret, typename F, typename... Args>
+    static Ret measure(const std::shared_ptr<Cost> &cost, F &function,
+                       Args &&... args) {
+        if (!cost)
+            return function(std::forward<Args>(args)...);
+        const auto start = std::chrono::steady_clock::now();
+        Ret result = function(std::forward<Args>(args)...);
+        const auto stop = std::chrono::steady_clock::now();
+        cost->nanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start)
+                .count(),
+            std::memory_order_relaxed);
+        cost->evaluations.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    static auto wrapImpl(std::shared_ptr<Cost> cost, F function,
+                         Ret (F::*)(Args...) const) {
+        return [cost, function](Args... args) -> Ret {
+            return measure<Ret>(cost, function, std::forward<Args>(args)...);
+        };
+    }
+
+    // for function objects with a non-const call operator, like the helpers
+    // returned by ROOT::RDF::PassAsVec
+    template <typename F, typename Ret, typename... Args>
+    static auto wrapImpl(std::shared_ptr<Cost> cost, F function,
+                         Ret (F::*)(Args...)) {
+        return [cost, function](Args... args) mutable -> Ret {
+            return measure<Ret>(cost, function, std::forward<Args>(args)...);
+        };
+    }
+
+    bool _enabled = false;
+    std::mutex _mutex;
+    std::map<std::string, std::shared_ptr<Cost>> _costs;
+};
+
+FilterProfile &FilterProfile::getInstance() {
+    static FilterProfile instance;
+    return instance;
+}
+
+std::shared_ptr<FilterProfile::Cost>
+FilterProfile::getCost(const std::string &filtername) {
+    auto &instance = getInstance();
+    if (!instance._enabled)
+        return nullptr;
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    auto &cost = instance._costs[filtername];
+    if (!cost)
+        cost = std::make_shared<Cost>();
+    return cost;
+}
+
+void FilterProfile::write(
+    const std::string &filename,
+    const std::vector<std::pair<std::string, ROOT::RDF::RCutFlowReport>>
+        &reports) {
+    auto &instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    std::ofstream file(filename);
+    if (!file) {
+        Logger::get("FilterProfile")
+            ->critical("Could not open filter profile {}", filename);
+        throw std::runtime_error("Could not open filter profile");
+    }
+    file << "{\n    \"filters\": {";
+    for (std::size_t i = 0; i < reports.size(); ++i) {
+        file << (i == 0 ? "" : ",") << "\n        \"" << reports[i].first
+             << "\": [";
+        bool first = true;
+        for (auto &&cut : reports[i].second) {
+            unsigned long long nanoseconds = 0;
+            unsigned long long evaluations = 0;
+            auto found = instance._costs.find(cut.GetName());
+            if (found != instance._costs.end()) {
+                nanoseconds = found->second->nanoseconds;
+                evaluations = found->second->evaluations;
+            }
+            file << (first ? "" : ",") << "\n            {\"name\": \""
+                 << cut.GetName() << "\", \"all\": " << cut.GetAll()
+                 << ", \"pass\": " << cut.GetPass()
+                 << ", \"evaluations\": " << evaluations
+                 << ", \"seconds\": " << nanoseconds * 1e-9 << "}";
+            first = false;
+        }
+        file << "\n        ]";
+    }
+    file << "\n    }\n}\n";
+    Logger::get("FilterProfile")
+        ->info("Filter profile written to {}", filename);
+}
+
+} // namespace utility
+
+#endif /* GUARDFILTERPROFILE_H */
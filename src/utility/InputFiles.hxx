@@ -0,0 +1,148 @@
+#ifndef GUARDINPUTFILES_H
+#define GUARDINPUTFILES_H
+
+#include "Logger.hxx"
+#include "ROOT/TTreeProcessorMT.hxx"
+#include "TFile.h"
+#include "TTree.h"
+#include <fstream>
+#include <glob.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Namespace used for common utility functions.
+namespace utility {
+
+/// Function to expand a glob pattern into the matching file names. Remote
+/// paths (containing `://`) and paths without wildcards are returned as they
+/// are.
+///
+/// \param[in] pattern the path or glob pattern
+/// \param[out] files the vector the matching files are appended to
+///
+/// \returns false if the pattern does not match any file
+bool expandGlob(const std::string &pattern, std::vector<std::string> &files) {
+    if (pattern.find("://") != std::string::npos ||
+        pattern.find_first_of("*?[") == std::string::npos) {
+        files.push_back(pattern);
+        return true;
+    }
+    glob_t matches;
+    const int status = glob(pattern.c_str(), 0, nullptr, &matches);
+    if (status == 0) {
+        for (std::size_t i = 0; i < matches.gl_pathc; ++i)
+            files.push_back(matches.gl_pathv[i]);
+    }
+    globfree(&matches);
+    return status == 0;
+}
+
+/// Function to expand the input arguments of an executable into a list of
+/// files. Each argument can be
+///    - a single ROOT file (local or remote),
+///    - a glob pattern, e.g. `/data/sample/*.root`,
+///    - a text file (ending with `.txt`) containing one path or glob pattern
+///    per line. Empty lines and lines starting with `#` are ignored.
+///
+/// \param[in] arguments the input arguments
+/// \param[out] files the expanded list of files
+///
+/// \returns false if an argument can not be resolved
+bool expandInputFiles(const std::vector<std::string> &arguments,
+                      std::vector<std::string> &files) {
+    auto log = Logger::get("main");
+    for (const auto &argument : arguments) {
+        std::vector<std::string> patterns;
+        const std::string listsuffix = ".txt";
+        if (argument.size() > listsuffix.size() &&
+            argument.compare(argument.size() - listsuffix.size(),
+                             listsuffix.size(), listsuffix) == 0) {
+            std::ifstream filelist(argument);
+            if (!filelist) {
+                log->critical("Could not open file list {}", argument);
+                return false;
+            }
+            std::string line;
+            while (std::getline(filelist, line)) {
+                line.erase(0, line.find_first_not_of(" \t"));
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+                if (!line.empty() && line[0] != '#')
+                    patterns.push_back(line);
+            }
+        } else {
+            patterns.push_back(argument);
+        }
+        for (const auto &pattern : patterns) {
+            if (!expandGlob(pattern, files)) {
+                log->critical("No input file matches {}", pattern);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Function to count the number of clusters of a tree in a set of files.
+/// Clusters are the units of work distributed to the threads of the event
+/// loop. Files, which can not be opened, are skipped here, the error is
+/// reported by the event loop itself.
+///
+/// \param[in] files the input files
+/// \param[in] treename the name of the tree
+///
+/// \returns the total number of clusters
+std::size_t countClusters(const std::vector<std::string> &files,
+                          const std::string &treename) {
+    std::size_t nclusters = 0;
+    for (const auto &filename : files) {
+        std::unique_ptr<TFile> file(TFile::Open(filename.c_str(), "READ"));
+        if (!file || file->IsZombie())
+            continue;
+        auto tree = file->Get<TTree>(treename.c_str());
+        if (!tree)
+            continue;
+        auto clusters = tree->GetClusterIterator(0);
+        while (clusters.Next() < tree->GetEntries())
+            ++nclusters;
+    }
+    return nclusters;
+}
+
+/// Function to configure the work partitioning of the multi-threaded event
+/// loop for a set of input files. By default, ROOT merges the clusters of the
+/// input files into a fixed number of tasks per thread. Here, only the global
+/// hint for the number of tasks per thread is set, such that the number of
+/// tasks is about the total number of clusters of all input files. How the
+/// entries are split into tasks is still decided by ROOT, the tasks are not
+/// aligned to the cluster boundaries by this function.
+///
+/// To count the clusters, every input file is opened once before the event
+/// loop starts, one after the other. For a large number of remote files, this
+/// adds to the startup time of the job.
+///
+/// \param[in] files the input files
+/// \param[in] treename the name of the tree
+/// \param[in] nthreads the number of threads of the event loop
+void configureClusterPartitioning(const std::vector<std::string> &files,
+                                  const std::string &treename,
+                                  const unsigned int nthreads) {
+    auto log = Logger::get("main");
+    if (nthreads < 2)
+        return;
+    const auto nclusters = countClusters(files, treename);
+    log->info("Input consists of {} files with {} clusters", files.size(),
+              nclusters);
+    if (nclusters < 10 * nthreads) {
+        log->warn("Only {} clusters for {} threads, the event loop will not "
+                  "scale well",
+                  nclusters, nthreads);
+    }
+    const auto tasks_per_worker =
+        std::max<std::size_t>(1, (nclusters + nthreads - 1) / nthreads);
+    ROOT::TTreeProcessorMT::SetTasksPerWorkerHint(tasks_per_worker);
+}
+
+} // namespace utility
+
+#endif /* GUARDINPUTFILES_H */
@@ -0,0 +1,389 @@
+#ifndef GUARDINSTRUMENTATION_H
+#define GUARDINSTRUMENTATION_H
+
+#include "Logger.hxx"
+#include "ROOT/RDataFrame.hxx"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef CROWN_INSTRUMENTATION
+#define CROWN_INSTRUMENTATION 0
+#endif
+
+namespace utility {
+
+/// Per-producer instrumentation of the generated executables. In the
+/// instrumentation mode, the code generation passes every producer a
+/// utility::InstrumentedNode instead of the dataframe. All functions booked
+/// via this node are wrapped, so that their calls, the time spent in them and
+/// the number of heap allocations are counted for the producer and shift.
+///
+/// The counters are kept per processing slot on separate cache lines, so the
+/// threads never write to the same counters. To keep the overhead low enough
+/// for production jobs, the time is only measured for one out of
+/// `samplingInterval` calls per slot and extrapolated to all calls. The
+/// allocations are counted by the replacement of the global `operator new`,
+/// which is only compiled with `CROWN_INSTRUMENTATION`.
+class Instrumentation {
+  public:
+    struct alignas(64) SlotCounters {
+        std::atomic<unsigned long long> calls{0};
+        std::atomic<unsigned long long> sampledCalls{0};
+        std::atomic<unsigned long long> sampledNanoseconds{0};
+        std::atomic<unsigned long long> allocations{0};
+    };
+
+    /// counters of one producer and shift
+    struct Counters {
+        Counters(const std::string &producer, const std::string &shift,
+                 unsigned int nSlots)
+            : producer(producer), shift(shift), nSlots(nSlots),
+              slots(new SlotCounters[nSlots]) {}
+        const std::string producer;
+        const std::string shift;
+        const unsigned int nSlots;
+        std::unique_ptr<SlotCounters[]> slots;
+    };
+
+    constexpr static unsigned long long samplingInterval = 16;
+
+    /// Return the counters for the given producer and shift, creating them
+    /// on the first request
+    static std::shared_ptr<Counters> get(const std::string &producer,
+                                         const std::string &shift,
+                                         unsigned int nSlots);
+
+    /// Call `function` with the given arguments and add the call to the
+    /// counters of the given slot
+    template <typename Ret, typename F, typename... Args>
+    static Ret measure(Counters &counters, unsigned int slot, F &function,
+                       Args &&... args) {
+        auto &slotCounters = counters.slots[slot % counters.nSlots];
+        const auto call =
+            slotCounters.calls.fetch_add(1, std::memory_order_relaxed);
+        const auto allocations = threadAllocations();
+        if (call % samplingInterval != 0) {
+            Ret result = function(std::forward<Args>(args)...);
+            slotCounters.allocations.fetch_add(
+                threadAllocations() - allocations, std::memory_order_relaxed);
+            return result;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        Ret result = function(std::forward<Args>(args)...);
+        const auto stop = std::chrono::steady_clock::now();
+        slotCounters.allocations.fetch_add(threadAllocations() - allocations,
+                                           std::memory_order_relaxed);
+        slotCounters.sampledCalls.fetch_add(1, std::memory_order_relaxed);
+        slotCounters.sampledNanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start)
+                .count(),
+            std::memory_order_relaxed);
+        return result;
+    }
+
+    /// number of heap allocations of the current thread
+    static unsigned long long &threadAllocations() {
+        thread_local unsigned long long allocations = 0;
+        return allocations;
+    }
+
+    /// index of the current thread, used as slot by the filters, which do not
+    /// get the slot from the dataframe
+    static unsigned int threadIndex() {
+        static std::atomic<unsigned int> nThreads{0};
+        thread_local unsigned int index = nThreads++;
+        return index;
+    }
+
+    /// Write the counters of all producers, sorted by the estimated time, to
+    /// the log and to a JSON file of the form
+    ///
+    ///     {"producers": [{"producer": ..., "shift": ..., "calls": ...,
+    ///         "seconds": ..., "allocations": ...}, ...]}
+    ///
+    /// \param[in] filename the name of the output file
+    static void report(const std::string &filename);
+
+  private:
+    Instrumentation() = default;
+    static Instrumentation &getInstance();
+
+    std::mutex _mutex;
+    std::map<std::pair<std::string, std::string>, std::shared_ptr<Counters>>
+        _counters;
+};
+
+Instrumentation &Instrumentation::getInstance() {
+    static Instrumentation instance;
+    return instance;
+}
+
+std::shared_ptr<Instrumentation::Counters>
+Instrumentation::get(const std::string &producer, const std::string &shift,
+                     unsigned int nSlots) {
+    auto &instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    auto &counters = instance._counters[{producer, shift}];
+    if (!counters)
+        counters = std::make_shared<Counters>(producer, shift,
+                                              std::max(nSlots, 1u));
+    return counters;
+}
+
+void Instrumentation::report(const std::string &filename) {
+    struct Entry {
+        const Counters *counters;
+        unsigned long long calls = 0;
+        unsigned long long allocations = 0;
+        double seconds = 0.;
+    };
+    auto &instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    std::vector<Entry> entries;
+    for (const auto &[key, counters] : instance._counters) {
+        Entry entry{counters.get()};
+        unsigned long long sampledCalls = 0;
+        unsigned long long sampledNanoseconds = 0;
+        for (unsigned int slot = 0; slot < counters->nSlots; ++slot) {
+            const auto &slotCounters = counters->slots[slot];
+            entry.calls += slotCounters.calls;
+            entry.allocations += slotCounters.allocations;
+            sampledCalls += slotCounters.sampledCalls;
+            sampledNanoseconds += slotCounters.sampledNanoseconds;
+        }
+        if (sampledCalls > 0)
+            entry.seconds = 1e-9 * sampledNanoseconds * entry.calls /
+                            static_cast<double>(sampledCalls);
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b) {
+                  return a.seconds > b.seconds;
+              });
+    auto log = Logger::get("Instrumentation");
+    log->info("{:<40} {:<40} {:>12} {:>12} {:>14}", "Producer", "Shift",
+              "Calls", "Time [s]", "Allocations");
+    for (const auto &entry : entries) {
+        log->info("{:<40} {:<40} {:>12} {:>12.4f} {:>14}",
+                  entry.counters->producer, entry.counters->shift,
+                  entry.calls, entry.seconds, entry.allocations);
+    }
+    std::ofstream file(filename);
+    if (!file) {
+        log->critical("Could not open instrumentation report {}", filename);
+        throw std::runtime_error("Could not open instrumentation report");
+    }
+    file << "{\n    \"producers\": [";
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const auto &entry = entries[i];
+        file << (i == 0 ? "" : ",") << "\n        {\"producer\": \""
+             << entry.counters->producer << "\", \"shift\": \""
+             << entry.counters->shift << "\", \"calls\": " << entry.calls
+             << ", \"seconds\": " << entry.seconds
+             << ", \"allocations\": " << entry.allocations << "}";
+    }
+    file << "\n    ]\n}\n";
+    log->info("Instrumentation report written to {}", filename);
+}
+
+/// Dataframe node used in the instrumentation mode. It provides the methods
+/// of the dataframe used by the producers and wraps all booked functions, so
+/// that they are counted for the producer and shift of the node. Each result
+/// is again an instrumented node of the same producer and shift. The
+/// underlying dataframe is held as `ROOT::RDF::RNode`, so all nodes have the
+/// same type.
+class InstrumentedNode {
+  public:
+    InstrumentedNode(ROOT::RDF::RNode node,
+                     std::shared_ptr<Instrumentation::Counters> counters)
+        : _node(std::move(node)), _counters(std::move(counters)) {}
+
+    template <typename F, typename = std::enable_if_t<
+                              !std::is_convertible_v<F, std::string>>>
+    InstrumentedNode Define(std::string_view name, F function,
+                            const ROOT::RDF::ColumnNames_t &columns = {}) {
+        return next(_node.DefineSlot(
+            name, wrapDefine(std::move(function), &F::operator()), columns));
+    }
+
+    InstrumentedNode Define(std::string_view name,
+                            const std::string &expression) {
+        return next(_node.Define(name, expression));
+    }
+
+    template <typename F>
+    InstrumentedNode DefineSlot(std::string_view name, F function,
+                                const ROOT::RDF::ColumnNames_t &columns = {}) {
+        return next(_node.DefineSlot(
+            name, wrapDefineSlot(std::move(function), &F::operator()),
+            columns));
+    }
+
+    template <typename F, typename = std::enable_if_t<
+                              !std::is_convertible_v<F, std::string>>>
+    InstrumentedNode Filter(F function,
+                            const ROOT::RDF::ColumnNames_t &columns = {},
+                            std::string_view name = "") {
+        return next(_node.Filter(
+            wrapFilter(std::move(function), &F::operator()), columns, name));
+    }
+
+    InstrumentedNode Filter(std::string_view expression,
+                            std::string_view name = "") {
+        return next(_node.Filter(expression, name));
+    }
+
+    unsigned int GetNSlots() const { return _node.GetNSlots(); }
+
+    bool HasColumn(std::string_view name) { return _node.HasColumn(name); }
+
+    /// the underlying dataframe
+    ROOT::RDF::RNode node() const { return _node; }
+
+  private:
+    template <typename Result> InstrumentedNode next(Result result) const {
+        return InstrumentedNode(ROOT::RDF::RNode(result), _counters);
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    auto wrapDefine(F function, Ret (F::*)(Args...) const) const {
+        return [counters = _counters, function](unsigned int slot,
+                                                Args... args) -> Ret {
+            return Instrumentation::measure<Ret>(
+                *counters, slot, function, std::forward<Args>(args)...);
+        };
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    auto wrapDefine(F function, Ret (F::*)(Args...)) const {
+        return [counters = _counters, function](unsigned int slot,
+                                                Args... args) mutable -> Ret {
+            return Instrumentation::measure<Ret>(
+                *counters, slot, function, std::forward<Args>(args)...);
+        };
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    auto wrapDefineSlot(F function, Ret (F::*)(unsigned int, Args...) const)
+        const {
+        return [counters = _counters, function](unsigned int slot,
+                                                Args... args) -> Ret {
+            return Instrumentation::measure<Ret>(
+                *counters, slot, function, slot, std::forward<Args>(args)...);
+        };
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    auto wrapDefineSlot(F function, Ret (F::*)(unsigned int, Args...)) const {
+        return [counters = _counters, function](unsigned int slot,
+                                                Args... args) mutable -> Ret {
+            return Instrumentation::measure<Ret>(
+                *counters, slot, function, slot, std::forward<Args>(args)...);
+        };
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    auto wrapFilter(F function, Ret (F::*)(Args...) const) const {
+        return [counters = _counters, function](Args... args) -> Ret {
+            return Instrumentation::measure<Ret>(
+                *counters, Instrumentation::threadIndex(), function,
+                std::forward<Args>(args)...);
+        };
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    auto wrapFilter(F function, Ret (F::*)(Args...)) const {
+        return [counters = _counters, function](Args... args) mutable -> Ret {
+            return Instrumentation::measure<Ret>(
+                *counters, Instrumentation::threadIndex(), function,
+                std::forward<Args>(args)...);
+        };
+    }
+
+    ROOT::RDF::RNode _node;
+    std::shared_ptr<Instrumentation::Counters> _counters;
+};
+
+/// Function used by the generated code to pass an instrumented node to a
+/// producer
+///
+/// \param[in] df the input dataframe of the producer
+/// \param[in] producer the name of the producer
+/// \param[in] shift the name of the shift, or "nominal"
+///
+/// \returns the instrumented node
+template <typename Node>
+InstrumentedNode instrument(Node &df, const std::string &producer,
+                            const std::string &shift) {
+    return InstrumentedNode(
+        ROOT::RDF::RNode(df),
+        Instrumentation::get(producer, shift, df.GetNSlots()));
+}
+
+/// Function used by the generated code to get the dataframe returned by a
+/// producer
+inline ROOT::RDF::RNode unwrap(const InstrumentedNode &df) { return df.node(); }
+
+} // namespace utility
+
+#if CROWN_INSTRUMENTATION
+// count the heap allocations of each thread. The nothrow variants of operator
+// new are implemented by the standard library using the replaced ones, the
+// variants with an alignment (e.g. for the alignas(64) counters) are separate
+// functions and are replaced as well.
+void *operator new(std::size_t size) {
+    ++utility::Instrumentation::threadAllocations();
+    if (void *pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) { return ::operator new(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    ++utility::Instrumentation::threadAllocations();
+    // aligned_alloc requires the size to be a multiple of the alignment
+    const auto align = static_cast<std::size_t>(alignment);
+    const std::size_t padded =
+        size == 0 ? align : (size + align - 1) / align * align;
+    if (void *pointer = std::aligned_alloc(align, padded))
+        return pointer;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+#endif
+
+#endif /* GUARDINSTRUMENTATION_H */
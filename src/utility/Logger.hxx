@@ -1,67 +1,139 @@
 #ifndef GUARDLOGGER_H
 #define GUARDLOGGER_H
 
+// Compile-time log level. Logging statements issued via the SPDLOG_LOGGER_*
+// macros below this level are removed by the preprocessor. The generated code
+// sets this to SPDLOG_LEVEL_DEBUG only if the generator is run with --debug
+#ifndef SPDLOG_ACTIVE_LEVEL
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+#endif
+
+#include "spdlog/async.h"
 #include "spdlog/fmt/ostr.h" // for formatting of RVecs
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/dist_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
+#include <map>
+#include <mutex>
+
+/// Logger handed out by Logger::get. Messages below the error level are
+/// passed on to an asynchronous logger, which puts them into a bounded queue
+/// drained by a background thread. Errors and critical messages are written
+/// and flushed synchronously by the calling thread instead, since they are
+/// usually followed by a `throw` or `exit`, and could otherwise be dropped
+/// from a full queue or never be written out. An error can therefore appear
+/// before messages, which were logged earlier but are still queued.
+class SplitLogger : public spdlog::logger {
+  public:
+    SplitLogger(const std::string &name, spdlog::sink_ptr sink,
+                std::shared_ptr<spdlog::async_logger> async)
+        : spdlog::logger(name, std::move(sink)), _async(std::move(async)) {
+        _async->set_level(spdlog::level::trace);
+    }
+
+  protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override {
+        if (msg.level >= spdlog::level::err) {
+            spdlog::logger::sink_it_(msg);
+            spdlog::logger::flush_();
+        } else {
+            _async->log(msg.time, msg.source, msg.level, msg.payload);
+        }
+    }
+    /// only requests the background thread to write out the queued messages
+    void flush_() override { _async->flush(); }
+
+  private:
+    std::shared_ptr<spdlog::async_logger> _async;
+};
 
+/// Central access point for all loggers of the framework. Messages below the
+/// error level are asynchronous: a log call only formats the message and puts
+/// it into a bounded queue, which is drained by a single background thread
+/// that writes to the console and (optionally) to the log file. Logging from
+/// within the event loop therefore never blocks on I/O and is safe for any
+/// number of threads. If the queue is full, the oldest of these messages are
+/// dropped instead of blocking the caller. Errors are always written out
+/// immediately, see SplitLogger.
 class Logger {
   public:
-    static std::shared_ptr<spdlog::logger> get(std::string name);
+    static std::shared_ptr<spdlog::logger> get(const std::string &name);
     enum class LogLevel { DEBUG, INFO, WARN, ERR, CRITICAL, OFF };
     static void setLevel(LogLevel level);
-    static void enableFileLogging(std::string filename);
+    static void enableFileLogging(const std::string &filename);
+    static void flush();
 
   private:
+    Logger();
     static Logger &getInstance();
-    LogLevel _level{LogLevel::INFO};
     static spdlog::level::level_enum convertLevelToSpdlog(LogLevel level);
-    std::unique_ptr<std::string> _fileName{};
+    /// number of messages the queue can hold before old ones are dropped
+    static constexpr std::size_t queueSize = 8192;
+    LogLevel _level{LogLevel::INFO};
+    std::mutex _mutex;
+    std::shared_ptr<spdlog::details::thread_pool> _threadPool;
+    // all loggers write into one distributing sink, so that the file sink can
+    // be added at runtime without touching the individual loggers
+    std::shared_ptr<spdlog::sinks::dist_sink_mt> _sinks;
+    bool _fileLogging{false};
     std::map<std::string, std::shared_ptr<spdlog::logger>> _loggers;
 };
 
+Logger::Logger()
+    : _threadPool(std::make_shared<spdlog::details::thread_pool>(queueSize, 1)),
+      _sinks(std::make_shared<spdlog::sinks::dist_sink_mt>()) {
+    _sinks->add_sink(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+}
+
 void Logger::setLevel(LogLevel level) {
-    getInstance()._level = level;
+    auto &instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    instance._level = level;
 
     // set level globally (probably superfluous..)
     spdlog::set_level(convertLevelToSpdlog(level));
 
     // set level for all active loggers
-    for (auto &[key, logger] : getInstance()._loggers)
+    for (auto &[key, logger] : instance._loggers)
         logger->set_level(convertLevelToSpdlog(level));
 }
 
-std::shared_ptr<spdlog::logger> Logger::get(std::string name) {
-    if (getInstance()._loggers.count(name) == 0) {
-        std::vector<spdlog::sink_ptr> sinkVector;
-        sinkVector.push_back(
-            std::make_shared<spdlog::sinks::stdout_color_sink_st>());
-
-        // check if file logging is enabled
-        if (getInstance()._fileName)
-            sinkVector.push_back(
-                std::make_shared<spdlog::sinks::basic_file_sink_st>(
-                    *getInstance()._fileName));
-
-        auto newLogger = std::make_shared<spdlog::logger>(
-            name, begin(sinkVector), end(sinkVector));
-        newLogger->set_level(convertLevelToSpdlog(getInstance()._level));
-        getInstance()._loggers[name] = newLogger;
-    }
+std::shared_ptr<spdlog::logger> Logger::get(const std::string &name) {
+    auto &instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    auto found = instance._loggers.find(name);
+    if (found != instance._loggers.end())
+        return found->second;
 
-    return getInstance()._loggers[name];
+    auto newLogger = std::make_shared<SplitLogger>(
+        name, instance._sinks,
+        std::make_shared<spdlog::async_logger>(
+            name, instance._sinks, instance._threadPool,
+            spdlog::async_overflow_policy::overrun_oldest));
+    newLogger->set_level(convertLevelToSpdlog(instance._level));
+    instance._loggers[name] = newLogger;
+    return newLogger;
 }
 
-void Logger::enableFileLogging(std::string filename) {
-    getInstance()._fileName = std::make_unique<std::string>(filename);
-    for (auto &[key, logger] : getInstance()._loggers) {
-        // if there is less than two sinks, add a file sink
-        if (logger->sinks().size() < 2)
-            logger->sinks().push_back(
-                std::make_shared<spdlog::sinks::basic_file_sink_st>(
-                    *getInstance()._fileName));
-    }
+void Logger::enableFileLogging(const std::string &filename) {
+    auto &instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    // the file sink is shared by all loggers, so it is only added once
+    if (instance._fileLogging)
+        return;
+    instance._sinks->add_sink(
+        std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename));
+    instance._fileLogging = true;
+}
+
+/// Request all loggers to write out their queued messages. The writing itself
+/// is done by the background thread, errors are never queued.
+void Logger::flush() {
+    auto &instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    for (auto &[key, logger] : instance._loggers)
+        logger->flush();
 }
 
 Logger &Logger::getInstance() {
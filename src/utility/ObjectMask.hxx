@@ -0,0 +1,137 @@
+#ifndef GUARDOBJECTMASK_H
+#define GUARDOBJECTMASK_H
+
+#include "Logger.hxx"
+#include "ROOT/RVec.hxx"
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+namespace utility {
+
+/// Bit-packed mask of the objects of a collection. Bit `i` of the word is set,
+/// if object `i` passes the selection. In contrast to a `ROOT::RVec<int>`
+/// mask, no memory is allocated, and combining two masks is a single `and` or
+/// `or` of two words instead of a loop over the objects.
+///
+/// At most maxObjects objects can be stored. Further objects of larger
+/// collections are treated as failing the selection, and a warning is printed
+/// once. The size of the collection is kept, so that the mask can be
+/// converted back into a `ROOT::RVec<int>` of the original length with
+/// ObjectMask::ToRVec for the functions expecting the unpacked masks.
+class ObjectMask {
+  public:
+    static constexpr std::size_t maxObjects = 64;
+
+    ObjectMask() = default;
+    ObjectMask(std::uint64_t bits, std::size_t size)
+        : _bits(size < maxObjects ? bits & ((std::uint64_t(1) << size) - 1)
+                                  : bits),
+          _size(size) {}
+
+    /// Build a mask by evaluating a predicate for each object
+    ///
+    /// \param[in] values the quantity of the objects, the predicate is
+    /// evaluated on
+    /// \param[in] predicate function returning true, if an object passes
+    ///
+    /// \returns the mask of the objects passing the predicate
+    template <typename T, typename Predicate>
+    static ObjectMask FromPredicate(const ROOT::RVec<T> &values,
+                                    Predicate predicate) {
+        const std::size_t n = usable(values.size());
+        std::uint64_t bits = 0;
+        // no branches in the loop, so that the compiler can vectorize it
+        for (std::size_t i = 0; i < n; ++i)
+            bits |= std::uint64_t(bool(predicate(values[i]))) << i;
+        return ObjectMask(bits, values.size());
+    }
+
+    /// Pack a `ROOT::RVec<int>` mask, all non-zero entries pass
+    static ObjectMask FromRVec(const ROOT::RVec<int> &mask) {
+        return FromPredicate(mask, [](int value) { return value != 0; });
+    }
+
+    /// \returns the unpacked mask, with one entry for each object of the
+    /// collection
+    ROOT::RVec<int> ToRVec() const {
+        ROOT::RVec<int> mask(_size);
+        const std::size_t n = std::min(_size, maxObjects);
+        for (std::size_t i = 0; i < n; ++i)
+            mask[i] = (_bits >> i) & 1;
+        return mask;
+    }
+
+    /// \returns the indices of the passing objects in increasing order, like
+    /// `ROOT::VecOps::Nonzero` of the unpacked mask
+    ROOT::RVec<int> Indices() const {
+        ROOT::RVec<int> indices;
+        indices.reserve(count());
+        for (auto bits = _bits; bits != 0; bits &= bits - 1)
+            indices.push_back(__builtin_ctzll(bits));
+        return indices;
+    }
+
+    /// \returns true, if object `i` passes
+    bool test(std::size_t i) const {
+        return i < maxObjects && ((_bits >> i) & 1);
+    }
+    /// \returns the number of passing objects
+    std::size_t count() const { return __builtin_popcountll(_bits); }
+    /// \returns true, if at least one object passes
+    bool any() const { return _bits != 0; }
+    /// \returns the index of the first passing object, or -1 if there is none
+    int first() const { return _bits == 0 ? -1 : __builtin_ctzll(_bits); }
+    /// \returns the number of objects in the collection
+    std::size_t size() const { return _size; }
+    std::uint64_t bits() const { return _bits; }
+
+    /// \returns a copy of the mask, where object `i` fails
+    ObjectMask without(std::size_t i) const {
+        if (i >= maxObjects)
+            return *this;
+        return ObjectMask(_bits & ~(std::uint64_t(1) << i), _size);
+    }
+
+    ObjectMask operator&(const ObjectMask &other) const {
+        return ObjectMask(_bits & other._bits, std::max(_size, other._size));
+    }
+    ObjectMask operator|(const ObjectMask &other) const {
+        return ObjectMask(_bits | other._bits, std::max(_size, other._size));
+    }
+    ObjectMask &operator&=(const ObjectMask &other) {
+        return *this = *this & other;
+    }
+    ObjectMask &operator|=(const ObjectMask &other) {
+        return *this = *this | other;
+    }
+    bool operator==(const ObjectMask &other) const {
+        return _bits == other._bits && _size == other._size;
+    }
+    bool operator!=(const ObjectMask &other) const {
+        return !(*this == other);
+    }
+
+  private:
+    /// number of objects, which fit into the mask
+    static std::size_t usable(std::size_t size) {
+        if (size > maxObjects) {
+            static std::once_flag warned;
+            std::call_once(warned, [size]() {
+                Logger::get("ObjectMask")
+                    ->warn("Collection with {} objects, only the first {} "
+                           "can pass a packed object mask",
+                           size, maxObjects);
+            });
+            return maxObjects;
+        }
+        return size;
+    }
+
+    std::uint64_t _bits = 0;
+    std::size_t _size = 0;
+};
+
+} // namespace utility
+
+#endif /* GUARDOBJECTMASK_H */
@@ -1,9 +1,12 @@
 #ifndef GUARDROOFUNCTORTHREADSAFE_H
 #define GUARDROOFUNCTORTHREADSAFE_H
 
+#include "CorrectionRegistry.hxx"
 #include "RooFunctor.h"
 #include "RooWorkspace.h"
 #include "TFile.h"
+#include "TabulatedFunction.hxx"
+#include <array>
 #include <chrono>
 #include <memory>
 #include <mutex>
@@ -99,6 +102,94 @@ class RooFunctorThreadsafe {
     constexpr static int maxNExecutors = 100;
 };
 
+class RooFunctorPerSlot {
+
+    // Lock-free alternative to RooFunctorThreadsafe for the evaluation inside
+    // of the RDataFrame event loop.
+    // One clone of the full tree of the RooFit function, together with its
+    // functor, is created per processing slot when the object is constructed.
+    // Since a slot is only ever used by a single thread at a time, the
+    // evaluation does not need any locking. The executors are allocated
+    // separately and aligned to a cache line, so that the slots do not
+    // contend on shared cache lines.
+    // If a tolerance is given, the function is first compiled into a lookup
+    // table (see TabulatedFunction), which is shared by all slots. The
+    // clones are only created if the function can not be tabulated.
+
+  public:
+    RooFunctorPerSlot(RooAbsReal const &function, RooArgSet const &args,
+                      unsigned int nSlots, double tabulationTolerance = -1.)
+        : nSlots_(nSlots) {
+        if (tabulationTolerance >= 0.) {
+            table_ = TabulatedFunction::build(function, args,
+                                              tabulationTolerance);
+            if (table_)
+                return;
+        }
+        executors_.reserve(nSlots);
+        for (unsigned int slot = 0; slot < nSlots; ++slot)
+            executors_.push_back(std::make_unique<Executor>(function, args));
+    }
+
+    double operator()(unsigned int slot, const double *input) const {
+        return eval(slot, input);
+    }
+
+    double eval(unsigned int slot, const double *input) const {
+        if (table_)
+            return table_->eval(input);
+        return executors_[slot]->eval(input);
+    }
+
+    template <std::size_t N>
+    double eval(unsigned int slot, const std::array<double, N> &input) const {
+        return eval(slot, input.data());
+    }
+
+    unsigned int nSlots() const { return nSlots_; }
+    bool isTabulated() const { return table_ != nullptr; }
+
+  private:
+    struct alignas(64) Executor {
+        Executor(RooAbsReal const &function, RooArgSet const &args) {
+            function_.reset(static_cast<RooAbsReal *>(function.cloneTree()));
+            RooArgSet funcServers;
+            function_->treeNodeServerList(&funcServers);
+            args_.reset(
+                static_cast<RooArgSet *>(funcServers.selectCommon(args)));
+            functor_.reset(function_->functor(*args_));
+        }
+
+        double eval(const double *input) { return functor_->eval(input); }
+
+        std::unique_ptr<RooAbsReal> function_ = nullptr;
+        std::unique_ptr<RooArgSet> args_ = nullptr;
+        std::unique_ptr<RooFunctor> functor_ = nullptr;
+    };
+
+    unsigned int nSlots_;
+    std::unique_ptr<const TabulatedFunction> table_ = nullptr;
+    std::vector<std::unique_ptr<Executor>> executors_;
+};
+
+/**
+ * @brief Function used to load the
+ * [`RooWorkspace`](https://root.cern.ch/doc/master/classRooWorkspace.html)
+ * `w` from a file. The workspace is read only once and shared via the
+ * `CorrectionRegistry`, so that all functions taken from the same workspace
+ * use a single copy.
+ *
+ * @param workspace_name The path to the workspace file
+ * @returns A `std::shared_ptr<RooWorkspace>` to the workspace
+ */
+std::shared_ptr<RooWorkspace> loadWorkspace(const std::string &workspace_name) {
+    return CorrectionRegistry::get<RooWorkspace>(
+        workspace_name, "w", "", [](TFile &file) {
+            return std::shared_ptr<RooWorkspace>(
+                (RooWorkspace *)file.Get("w"));
+        });
+}
+
 /**
  * @brief Function used to load a
  * [`RooFunctor`](https://root.cern.ch/doc/master/classRooFunctor.html) from a
@@ -107,7 +198,8 @@ class RooFunctorThreadsafe {
  * how these workspaces are created can be found in [this
  * repository](https://github.com/KIT-CMS/LegacyCorrectionsWorkspace). This
  * version uses the threadsafe variant of loading `RooFunctors`, defined in the
- * `RooFunctorThreadsafe` class.
+ * `RooFunctorThreadsafe` class. Repeated calls with the same arguments return
+ * the same functor, see `CorrectionRegistry`.
  *
  * @param workspace_name The path to the workspace file, from which the functor
  * should be loaded
@@ -120,18 +212,54 @@ class RooFunctorThreadsafe {
 auto loadFunctor(const std::string &workspace_name,
                  const std::string &functor_name,
                  const std::string &arguments) {
-    // first load the workspace
-    auto workspacefile = TFile::Open(workspace_name.c_str(), "read");
-    auto workspace = (RooWorkspace *)workspacefile->Get("w");
-    workspacefile->Close();
-    auto func = workspace->function(functor_name.c_str());
-    auto args = workspace->argSet(arguments.c_str());
-
-    auto functor = std::make_shared<RooFunctorThreadsafe>(*func, args);
-
-    // we can delete the workspace since we copied the functions out of it
-    delete workspace;
-    return functor;
+    return CorrectionRegistry::getOrCreate<RooFunctorThreadsafe>(
+        workspace_name, functor_name, arguments, [&]() {
+            auto workspace = loadWorkspace(workspace_name);
+            auto func = workspace->function(functor_name.c_str());
+            auto args = workspace->argSet(arguments.c_str());
+            return std::make_shared<RooFunctorThreadsafe>(*func, args);
+        });
+}
+
+/**
+ * @brief Function used to load a
+ * [`RooFunctor`](https://root.cern.ch/doc/master/classRooFunctor.html) from a
+ * [`RooWorkspace`](https://root.cern.ch/doc/master/classRooWorkspace.html)
+ * for the evaluation in an RDataFrame `DefineSlot` call. One clone of the
+ * function is created for each processing slot, as defined in the
+ * `RooFunctorPerSlot` class. Optionally, the function is replaced by a
+ * lookup table, if it can be tabulated within the given tolerance. As for the
+ * version above, identical requests share one functor.
+ *
+ * @param workspace_name The path to the workspace file, from which the functor
+ * should be loaded
+ * @param functor_name The name of the function from the workspace to be loaded
+ * @param arguments The arguments, that form the `ArgSet` of of the functor.
+ * @param nSlots The number of processing slots of the dataframe, as given by
+ * `df.GetNSlots()`
+ * @param tabulation_tolerance The maximal deviation of the lookup table from
+ * the function. A negative value disables the tabulation.
+ * @returns A `std::shared_ptr<RooFunctorPerSlot>`, which contains the
+ * functors used for evaluation
+ */
+
+auto loadFunctor(const std::string &workspace_name,
+                 const std::string &functor_name,
+                 const std::string &arguments, const unsigned int nSlots,
+                 const double tabulation_tolerance = -1.) {
+    // functors with a different number of slots or tolerance are separate
+    // payloads
+    const std::string argset = arguments + ";slots=" + std::to_string(nSlots) +
+                               ";tolerance=" +
+                               std::to_string(tabulation_tolerance);
+    return CorrectionRegistry::getOrCreate<RooFunctorPerSlot>(
+        workspace_name, functor_name, argset, [&]() {
+            auto workspace = loadWorkspace(workspace_name);
+            auto func = workspace->function(functor_name.c_str());
+            auto args = workspace->argSet(arguments.c_str());
+            return std::make_shared<RooFunctorPerSlot>(*func, args, nSlots,
+                                                       tabulation_tolerance);
+        });
 }
 
 #endif /* GUARDROOFUNCTORTHREADSAFE_H */
\ No newline at end of file
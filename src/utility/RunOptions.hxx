@@ -0,0 +1,127 @@
+#ifndef GUARDRUNOPTIONS_H
+#define GUARDRUNOPTIONS_H
+
+#include "InputFiles.hxx"
+#include "Logger.hxx"
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Namespace used for common utility functions.
+namespace utility {
+
+/// Options of a generated executable, as given on the command line
+struct RunOptions {
+    /// paths to the input files, after expanding globs and file lists
+    std::vector<std::string> input_paths;
+    /// prefix of the output files
+    std::string output_path;
+    /// number of threads used for the event loop, 0 means all available
+    /// cores. If unset, a single thread is used, see RunOptions::threads
+    std::optional<unsigned int> nthreads;
+    /// if set, the event loop is run with increasing numbers of threads
+    /// instead of a single time, see utility::runScalingBenchmark
+    bool scaling_benchmark = false;
+    /// if not empty, the number of events and the runtime of the event loop
+    /// are written to this file
+    std::string benchmark_report;
+    /// if not empty, the cut flow and the evaluation time of the filters are
+    /// written to this file, see utility::FilterProfile
+    std::string filter_profile;
+
+    /// \returns the number of threads passed to ROOT::EnableImplicitMT
+    unsigned int threads() const { return nthreads.value_or(1); }
+};
+
+/// Function to convert a string into a number of threads
+///
+/// \param[in] value the string to be converted
+/// \param[out] nthreads the number of threads
+///
+/// \returns true if the string is a valid non-negative integer
+bool parseThreadCount(const std::string &value,
+                      std::optional<unsigned int> &nthreads) {
+    char *end = nullptr;
+    const long result = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || result < 0)
+        return false;
+    nthreads = static_cast<unsigned int>(result);
+    return true;
+}
+
+/// Function to parse the command line of a generated executable. The usage is
+///
+///     ./executable [options] <input> [<input> ...] <output path>
+///
+/// where each input can be a ROOT file, a glob pattern or a text file with a
+/// list of files (see utility::expandInputFiles). All inputs are processed in
+/// a single event loop. The options are
+///    - `--threads N` (or `-j N`): number of threads, 0 uses all cores. If not
+///    given, the environment variable `CROWN_NTHREADS` is used, if set.
+///    Defaults to a single thread.
+///    - `--scaling-benchmark`: run the core-scaling benchmark
+///    - `--benchmark-report FILE`: write the event loop statistics to `FILE`
+///    (used internally by the scaling benchmark)
+///    - `--filter-profile FILE`: measure the filters and write their profile
+///    to `FILE`, which can be used by the code generation to order the filters
+///
+/// \param[in] argc the number of command line arguments
+/// \param[in] argv the command line arguments
+/// \param[out] options the parsed options
+///
+/// \returns true if the command line is valid, false otherwise
+bool parseRunOptions(int argc, char *argv[], RunOptions &options) {
+    auto log = Logger::get("main");
+    if (const char *env = std::getenv("CROWN_NTHREADS")) {
+        if (!parseThreadCount(env, options.nthreads)) {
+            log->critical("Invalid number of threads in CROWN_NTHREADS: {}",
+                          env);
+            return false;
+        }
+    }
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--threads" || arg == "-j") {
+            if (i + 1 == argc ||
+                !parseThreadCount(argv[i + 1], options.nthreads)) {
+                log->critical("Option {} requires a non-negative integer", arg);
+                return false;
+            }
+            ++i;
+        } else if (arg == "--scaling-benchmark") {
+            options.scaling_benchmark = true;
+        } else if (arg == "--benchmark-report") {
+            if (i + 1 == argc) {
+                log->critical("Option {} requires a file name", arg);
+                return false;
+            }
+            options.benchmark_report = argv[++i];
+        } else if (arg == "--filter-profile") {
+            if (i + 1 == argc) {
+                log->critical("Option {} requires a file name", arg);
+                return false;
+            }
+            options.filter_profile = argv[++i];
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            log->critical("Unknown option {}", arg);
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() < 2) {
+        log->critical("Require at least two additional input arguments (the "
+                      "input and output paths to the ROOT files) but got {}",
+                      positional.size());
+        return false;
+    }
+    options.output_path = positional.back();
+    positional.pop_back();
+    return expandInputFiles(positional, options.input_paths);
+}
+
+} // namespace utility
+
+#endif /* GUARDRUNOPTIONS_H */
@@ -0,0 +1,147 @@
+#ifndef GUARDSCALINGBENCHMARK_H
+#define GUARDSCALINGBENCHMARK_H
+
+#include "Logger.hxx"
+#include "RunOptions.hxx"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <spawn.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+/// Namespace used for common utility functions.
+namespace utility {
+
+/// Function to write the statistics of an event loop to a file, which is read
+/// back by utility::runScalingBenchmark
+///
+/// \param[in] filename the name of the report file
+/// \param[in] nevents the number of processed events
+/// \param[in] realtime the wall-clock time of the event loop in seconds
+void writeBenchmarkReport(const std::string &filename,
+                          const unsigned long long nevents,
+                          const double realtime) {
+    std::ofstream report(filename);
+    report << nevents << " " << realtime << std::endl;
+}
+
+/// Function to get the thread counts used by the scaling benchmark, which are
+/// the powers of two up to the maximal number of threads, and the maximum
+/// itself.
+///
+/// \param[in] max_threads the maximal number of threads
+///
+/// \returns a vector with the numbers of threads to be tested
+std::vector<unsigned int> scalingThreadCounts(const unsigned int max_threads) {
+    std::vector<unsigned int> nthreads;
+    for (unsigned int n = 1; n < max_threads; n *= 2)
+        nthreads.push_back(n);
+    nthreads.push_back(max_threads);
+    return nthreads;
+}
+
+/// Function to run the core-scaling benchmark. The executable is started once
+/// per thread count (1, 2, 4, ... N) with the same input. Using a new process
+/// for every setting gives independent measurements of the peak memory usage.
+/// The maximal number of threads N is given by the `--threads` option, or the
+/// number of available cores if it is not set or 0. The runs are started with
+/// `posix_spawn` instead of `fork`, since the benchmark process already runs
+/// the logging thread, and a forked child must not touch locks held by it.
+/// For every thread count, the event throughput of the event loop, the
+/// parallel efficiency with respect to the single thread run and the peak
+/// resident memory are reported. The output of the individual runs is written
+/// to `scaling_benchmark_<N>threads.log`.
+///
+/// \param[in] argv0 the name of the executable
+/// \param[in] options the options of the benchmark run
+///
+/// \returns the exit code of the program
+int runScalingBenchmark(const std::string &argv0, const RunOptions &options) {
+    auto log = Logger::get("ScalingBenchmark");
+    const unsigned int max_threads =
+        options.nthreads.value_or(0) > 0
+            ? *options.nthreads
+            : std::max(1u, std::thread::hardware_concurrency());
+    log->info("Running scaling benchmark with up to {} threads", max_threads);
+    const std::string report = "scaling_benchmark_report.txt";
+
+    double single_thread_rate = 0.;
+    std::vector<std::string> results;
+    for (const auto nthreads : scalingThreadCounts(max_threads)) {
+        const std::string logfile =
+            "scaling_benchmark_" + std::to_string(nthreads) + "threads.log";
+        std::vector<std::string> args = {argv0};
+        args.insert(args.end(), options.input_paths.begin(),
+                    options.input_paths.end());
+        args.insert(args.end(),
+                    {options.output_path, "--threads", std::to_string(nthreads),
+                     "--benchmark-report", report});
+        log->info("Starting run with {} threads", nthreads);
+        std::vector<char *> child_argv;
+        for (auto &arg : args)
+            child_argv.push_back(arg.data());
+        child_argv.push_back(nullptr);
+        // the output of the run is redirected into the log file
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO,
+                                         logfile.c_str(),
+                                         O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO,
+                                         STDERR_FILENO);
+        pid_t pid = 0;
+        const int error = posix_spawn(&pid, "/proc/self/exe", &actions,
+                                      nullptr, child_argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (error != 0) {
+            log->critical("Could not start the benchmark run: {}",
+                          std::strerror(error));
+            return 1;
+        }
+        int status = 0;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            log->critical("Run with {} threads failed, see {}", nthreads,
+                          logfile);
+            return 1;
+        }
+        unsigned long long nevents = 0;
+        double realtime = 0.;
+        std::ifstream input(report);
+        if (!(input >> nevents >> realtime) || realtime <= 0.) {
+            log->critical("Could not read the report of the run with {} "
+                          "threads",
+                          nthreads);
+            return 1;
+        }
+        const double rate = nevents / realtime;
+        if (nthreads == 1)
+            single_thread_rate = rate;
+        const double efficiency = rate / (nthreads * single_thread_rate);
+        // ru_maxrss is given in kilobytes on Linux
+        results.push_back(
+            fmt::format("{:>8} | {:>12.1f} | {:>10.2f} | {:>13.1f}", nthreads,
+                        rate, efficiency, usage.ru_maxrss / 1024.));
+    }
+    std::remove(report.c_str());
+
+    log->info("Scaling benchmark results for {} input files",
+              options.input_paths.size());
+    log->info(" threads | events / s   | efficiency | peak RSS (MB)");
+    for (const auto &result : results)
+        log->info(result);
+    return 0;
+}
+
+} // namespace utility
+
+#endif /* GUARDSCALINGBENCHMARK_H */
@@ -0,0 +1,338 @@
+#ifndef GUARDTABULATEDFUNCTION_H
+#define GUARDTABULATEDFUNCTION_H
+
+#include "Logger.hxx"
+#include "RooAbsReal.h"
+#include "RooArgSet.h"
+#include "RooFunctor.h"
+#include "RooRealVar.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+class TabulatedFunction {
+
+    // Lookup table replacement for a RooFit function of a few variables.
+    // The function is sampled once onto a flat grid. Two kinds of tables are
+    // tried:
+    //   - Constant: one value per bin, sampled at the bin centers. This is
+    //     only tried for binned functions (e.g. RooHistFunc), using the bin
+    //     boundaries reported by the function itself, and reproduces them
+    //     exactly.
+    //   - Linear: values at the bin boundaries with multilinear
+    //     interpolation, for smooth functions. Starting from the binning of
+    //     the function, or a coarse uniform grid, the binning is refined
+    //     until the table is precise enough or too large.
+    // Each table is validated against the original function at one point
+    // inside of every cell of the grid, and at additional random points
+    // within the range of the arguments. It is only used if all deviations
+    // are below the given tolerance. This is a check on a finite set of
+    // points, so functions with structure finer than the grid can still pass.
+    // As RooRealVar does, inputs outside of the range are clamped to the
+    // range. The table is immutable after construction, so it can be
+    // evaluated from any number of threads.
+
+  public:
+    enum class Mode { Constant, Linear };
+
+    /// maximal number of arguments of a tabulated function
+    constexpr static std::size_t maxDimensions = 4;
+    /// maximal number of entries of a table
+    constexpr static std::size_t maxTableSize = 1 << 20;
+    /// number of random points used for the validation, in addition to one
+    /// point per cell of the grid
+    constexpr static std::size_t nValidationPoints = 10000;
+    /// number of bins per argument of the initial grid of functions, which
+    /// do not report a binning
+    constexpr static std::size_t nInitialBins = 8;
+
+    static std::unique_ptr<const TabulatedFunction>
+    build(RooAbsReal const &function, RooArgSet const &args,
+          const double tolerance);
+
+    double operator()(const double *input) const { return eval(input); }
+
+    double eval(const double *input) const {
+        std::array<std::size_t, maxDimensions> index;
+        std::array<double, maxDimensions> fraction;
+        std::size_t offset = 0;
+        for (std::size_t dim = 0; dim < axes_.size(); ++dim) {
+            axes_[dim].locate(input[dim], index[dim], fraction[dim]);
+            offset += index[dim] * strides_[dim];
+        }
+        if (mode_ == Mode::Constant)
+            return values_[offset];
+        // sum over the 2^n corners of the grid cell, the weight of a corner
+        // is the product of the fractions (or their complements)
+        double result = 0.;
+        const std::size_t ncorners = std::size_t(1) << axes_.size();
+        for (std::size_t corner = 0; corner < ncorners; ++corner) {
+            double weight = 1.;
+            std::size_t position = offset;
+            for (std::size_t dim = 0; dim < axes_.size(); ++dim) {
+                const std::size_t upper = (corner >> dim) & 1;
+                weight *= upper ? fraction[dim] : 1. - fraction[dim];
+                position += upper * strides_[dim];
+            }
+            result += weight * values_[position];
+        }
+        return result;
+    }
+
+    std::size_t nDimensions() const { return axes_.size(); }
+    Mode mode() const { return mode_; }
+    std::size_t size() const { return values_.size(); }
+
+  private:
+    struct Axis {
+        Axis(const std::vector<double> &bounds)
+            : boundaries(bounds), low(bounds.front()), high(bounds.back()),
+              nbins(bounds.size() - 1) {
+            const double width = (high - low) / nbins;
+            uniform = true;
+            for (std::size_t i = 0; i <= nbins; ++i) {
+                if (std::abs(boundaries[i] - (low + i * width)) >
+                    1e-9 * (high - low))
+                    uniform = false;
+            }
+            invWidth = 1. / width;
+        }
+
+        // find the bin containing x and the relative position of x within
+        // the bin, values outside of the range are clamped
+        void locate(double x, std::size_t &bin, double &fraction) const {
+            x = std::clamp(x, low, high);
+            if (uniform) {
+                const double position = (x - low) * invWidth;
+                bin = std::min<std::size_t>(position, nbins - 1);
+                fraction = position - bin;
+            } else {
+                const auto upper = std::upper_bound(
+                    boundaries.begin() + 1, boundaries.end() - 1, x);
+                bin = upper - boundaries.begin() - 1;
+                fraction = (x - boundaries[bin]) /
+                           (boundaries[bin + 1] - boundaries[bin]);
+            }
+            fraction = std::clamp(fraction, 0., 1.);
+        }
+
+        std::vector<double> boundaries;
+        double low;
+        double high;
+        double invWidth;
+        std::size_t nbins;
+        bool uniform;
+    };
+
+    TabulatedFunction(Mode mode, std::vector<Axis> axes) : mode_(mode) {
+        axes_ = std::move(axes);
+        // the last argument runs fastest
+        strides_.assign(axes_.size(), 1);
+        std::size_t size = 1;
+        for (std::size_t dim = axes_.size(); dim-- > 0;) {
+            strides_[dim] = size;
+            size *= axes_[dim].nbins + (mode_ == Mode::Linear ? 1 : 0);
+        }
+        values_.resize(size);
+    }
+
+    std::size_t nPoints(std::size_t dim) const {
+        return axes_[dim].nbins + (mode_ == Mode::Linear ? 1 : 0);
+    }
+
+    // position of the grid point with the given index along an axis
+    double gridPoint(std::size_t dim, std::size_t i) const {
+        const auto &bounds = axes_[dim].boundaries;
+        if (mode_ == Mode::Linear)
+            return bounds[i];
+        return 0.5 * (bounds[i] + bounds[i + 1]);
+    }
+
+    void fill(RooFunctor &functor) {
+        std::vector<double> point(axes_.size());
+        for (std::size_t entry = 0; entry < values_.size(); ++entry) {
+            for (std::size_t dim = 0; dim < axes_.size(); ++dim) {
+                const auto i = (entry / strides_[dim]) % nPoints(dim);
+                point[dim] = gridPoint(dim, i);
+            }
+            values_[entry] = functor.eval(point.data());
+        }
+    }
+
+    // returns the largest deviation from the original function, relative to
+    // the function value if its magnitude is above one. The function is
+    // compared at one point inside of every cell of the grid, away from the
+    // sampled points (the center for interpolated tables, where the
+    // interpolation error is largest), and at random points.
+    double validate(RooFunctor &functor) const {
+        std::vector<double> point(axes_.size());
+        double maxDeviation = 0.;
+        auto compare = [&]() {
+            const double expected = functor.eval(point.data());
+            const double deviation = std::abs(eval(point.data()) - expected) /
+                                     std::max(1., std::abs(expected));
+            maxDeviation = std::max(maxDeviation, deviation);
+        };
+        const double position = mode_ == Mode::Linear ? 0.5 : 0.25;
+        std::size_t ncells = 1;
+        for (const auto &axis : axes_)
+            ncells *= axis.nbins;
+        for (std::size_t cell = 0; cell < ncells; ++cell) {
+            std::size_t rest = cell;
+            for (std::size_t dim = axes_.size(); dim-- > 0;) {
+                const auto &bounds = axes_[dim].boundaries;
+                const std::size_t i = rest % axes_[dim].nbins;
+                rest /= axes_[dim].nbins;
+                point[dim] = bounds[i] + position * (bounds[i + 1] - bounds[i]);
+            }
+            compare();
+        }
+        std::mt19937 generator(42);
+        for (std::size_t i = 0; i < nValidationPoints; ++i) {
+            for (std::size_t dim = 0; dim < axes_.size(); ++dim) {
+                std::uniform_real_distribution<double> uniform(axes_[dim].low,
+                                                               axes_[dim].high);
+                point[dim] = uniform(generator);
+            }
+            compare();
+        }
+        return maxDeviation;
+    }
+
+    Mode mode_;
+    std::vector<Axis> axes_;
+    std::vector<std::size_t> strides_;
+    std::vector<double> values_;
+};
+
+/**
+ * @brief Function used to build a lookup table for a RooFit function. The
+ * table is only returned, if it reproduces the function within the given
+ * tolerance, otherwise the function has to be evaluated with RooFit.
+ *
+ * @param function The RooFit function to be tabulated
+ * @param args The arguments of the function, in the order expected by the
+ * evaluation
+ * @param tolerance The maximal allowed deviation of the table from the
+ * function, relative to the function value if its magnitude is above one
+ * @returns A pointer to the table, or a `nullptr` if the function can not be
+ * tabulated
+ */
+std::unique_ptr<const TabulatedFunction>
+TabulatedFunction::build(RooAbsReal const &function, RooArgSet const &args,
+                         const double tolerance) {
+    auto log = Logger::get("TabulatedFunction");
+    // the functor is built on a clone, so that the original function is not
+    // modified when the arguments are set
+    std::unique_ptr<RooAbsReal> clone(
+        static_cast<RooAbsReal *>(function.cloneTree()));
+    RooArgSet funcServers;
+    clone->treeNodeServerList(&funcServers);
+    std::unique_ptr<RooArgSet> cloneArgs(
+        static_cast<RooArgSet *>(funcServers.selectCommon(args)));
+    std::unique_ptr<RooFunctor> functor(clone->functor(*cloneArgs));
+
+    // the grid follows the binning of the function itself (e.g. of the
+    // histogram of a RooHistFunc), not the default binning of the arguments
+    std::vector<std::vector<double>> binnings;
+    bool binned = true;
+    for (auto *arg : *cloneArgs) {
+        auto *var = dynamic_cast<RooRealVar *>(arg);
+        if (!var) {
+            log->warn("Can not tabulate {}: argument {} is not a RooRealVar",
+                      function.GetName(), arg->GetName());
+            return nullptr;
+        }
+        const double low = var->getMin();
+        const double high = var->getMax();
+        if (!std::isfinite(low) || !std::isfinite(high) || low >= high) {
+            log->warn("Can not tabulate {}: argument {} has no finite range",
+                      function.GetName(), var->GetName());
+            return nullptr;
+        }
+        std::unique_ptr<std::list<double>> boundaries(
+            clone->binBoundaries(*var, low, high));
+        std::vector<double> bounds;
+        if (boundaries) {
+            bounds.assign(boundaries->begin(), boundaries->end());
+            bounds.push_back(low);
+            bounds.push_back(high);
+            std::sort(bounds.begin(), bounds.end());
+            bounds.erase(std::remove_if(bounds.begin(), bounds.end(),
+                                        [low, high](double x) {
+                                            return x < low || x > high;
+                                        }),
+                         bounds.end());
+            bounds.erase(std::unique(bounds.begin(), bounds.end()),
+                         bounds.end());
+        } else {
+            binned = false;
+            for (std::size_t i = 0; i <= nInitialBins; ++i)
+                bounds.push_back(low + i * (high - low) / nInitialBins);
+        }
+        binnings.push_back(std::move(bounds));
+    }
+    if (binnings.empty() || binnings.size() > maxDimensions) {
+        log->warn("Can not tabulate {} with {} arguments", function.GetName(),
+                  binnings.size());
+        return nullptr;
+    }
+
+    auto tableSize = [&binnings](std::size_t extra) {
+        std::size_t size = 1;
+        for (const auto &bounds : binnings)
+            size *= bounds.size() - 1 + extra;
+        return size;
+    };
+    auto makeTable = [&binnings](Mode mode) {
+        std::vector<Axis> axes(binnings.begin(), binnings.end());
+        return std::unique_ptr<TabulatedFunction>(
+            new TabulatedFunction(mode, std::move(axes)));
+    };
+
+    double deviation = 0.;
+    if (binned && tableSize(0) <= maxTableSize) {
+        auto table = makeTable(Mode::Constant);
+        table->fill(*functor);
+        deviation = table->validate(*functor);
+        if (deviation <= tolerance) {
+            log->info("Tabulated {} as binned function with {} entries, "
+                      "maximal deviation {}",
+                      function.GetName(), table->size(), deviation);
+            return table;
+        }
+    }
+    // refine the binning by splitting every bin in two, until the
+    // interpolation is precise enough or the table becomes too large
+    while (tableSize(1) <= maxTableSize) {
+        auto table = makeTable(Mode::Linear);
+        table->fill(*functor);
+        deviation = table->validate(*functor);
+        if (deviation <= tolerance) {
+            log->info("Tabulated {} as interpolated function with {} entries, "
+                      "maximal deviation {}",
+                      function.GetName(), table->size(), deviation);
+            return table;
+        }
+        for (auto &bounds : binnings) {
+            std::vector<double> refined;
+            for (std::size_t i = 0; i + 1 < bounds.size(); ++i) {
+                refined.push_back(bounds[i]);
+                refined.push_back(0.5 * (bounds[i] + bounds[i + 1]));
+            }
+            refined.push_back(bounds.back());
+            bounds = std::move(refined);
+        }
+    }
+    log->warn("Can not tabulate {} within a tolerance of {} (last deviation "
+              "{}), using the RooFit evaluation",
+              function.GetName(), tolerance, deviation);
+    return nullptr;
+}
+
+#endif /* GUARDTABULATEDFUNCTION_H */
@@ -0,0 +1,486 @@
+#ifndef GUARDVARIATIONS_H
+#define GUARDVARIATIONS_H
+
+#include "Instrumentation.hxx"
+#include "Logger.hxx"
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RVec.hxx"
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+namespace utility {
+
+/// Suffix of the columns holding the variations of a quantity
+inline const std::string variationsSuffix = "_variations";
+
+/// Values of a quantity for the nominal configuration and its systematic
+/// shifts, stored in a single column named after the quantity with the suffix
+/// `_variations`. Variations with identical inputs are only computed once, so
+/// the column holds the distinct values and the index of the value of each
+/// variation. Without an index, the column holds one value per variation or a
+/// single value used by all variations.
+///
+/// The index is owned by the function defining the column, which is kept by
+/// the dataframe as long as the column can be read. A column without
+/// variations is read by a utility::VariationNode through a shared value,
+/// which points to the value of the column in the current event instead of
+/// copying it.
+template <typename T> struct Variations {
+    ROOT::RVec<T> values;
+    const std::vector<std::size_t> *index = nullptr;
+    T *shared = nullptr;
+
+    // bools are returned by value, since the container may store them as
+    // bits
+    using reference = std::conditional_t<std::is_same_v<T, bool>, bool, T &>;
+    using const_reference =
+        std::conditional_t<std::is_same_v<T, bool>, bool, const T &>;
+
+    const_reference operator[](std::size_t variation) const {
+        if (shared != nullptr)
+            return *shared;
+        return values[position(variation)];
+    }
+
+    reference operator[](std::size_t variation) {
+        if (shared != nullptr)
+            return *shared;
+        return values[position(variation)];
+    }
+
+  private:
+    std::size_t position(std::size_t variation) const {
+        if (index != nullptr)
+            return (*index)[variation];
+        return values.size() == 1 ? 0 : variation;
+    }
+};
+
+/// Registry of the types of the variation columns. The code generation does
+/// not know the types of the quantities, so the columns of the single
+/// variations are defined by the functions registered here for the name of
+/// the quantity.
+class VariationRegistry {
+  public:
+    /// Register the variation column of the given quantity, holding values
+    /// of type `T`
+    ///
+    /// \param[in] name the name of the quantity
+    template <typename T> static void add(const std::string &name) {
+        auto &instance = getInstance();
+        std::lock_guard<std::mutex> lock(instance._mutex);
+        auto found = instance._entries.find(name);
+        if (found != instance._entries.end()) {
+            if (found->second.type != std::type_index(typeid(T))) {
+                Logger::get("VariationRegistry")
+                    ->critical("Variations of {} registered with different "
+                               "types",
+                               name);
+                throw std::runtime_error(
+                    "Variations registered with different types");
+            }
+            return;
+        }
+        instance._entries.emplace(
+            name, Entry{std::type_index(typeid(T)),
+                        &unrollColumn<T, ROOT::RDF::RNode>,
+                        &unrollColumn<T, InstrumentedNode>});
+    }
+
+    /// Define the columns of the given variations of a quantity, each column
+    /// holds a copy of the value of its variation
+    ///
+    /// \param[in] df the input dataframe
+    /// \param[in] name the name of the quantity
+    /// \param[in] leaves the names of the new columns
+    /// \param[in] variations the variation of each new column
+    ///
+    /// \returns a dataframe with the new columns
+    template <typename Node>
+    static Node unroll(Node df, const std::string &name,
+                       const std::vector<std::string> &leaves,
+                       const std::vector<std::size_t> &variations) {
+        if (leaves.size() != variations.size()) {
+            Logger::get("VariationRegistry")
+                ->critical("Got {} columns but {} variations of {}",
+                           leaves.size(), variations.size(), name);
+            throw std::runtime_error("Inconsistent number of variations");
+        }
+        const auto &entry = get(name);
+        if constexpr (std::is_same_v<Node, InstrumentedNode>) {
+            return entry.instrumented(df, name, leaves, variations);
+        } else {
+            return entry.plain(ROOT::RDF::RNode(df), name, leaves, variations);
+        }
+    }
+
+  private:
+    template <typename Node>
+    using Unroller = Node (*)(Node, const std::string &,
+                              const std::vector<std::string> &,
+                              const std::vector<std::size_t> &);
+
+    struct Entry {
+        std::type_index type;
+        Unroller<ROOT::RDF::RNode> plain;
+        Unroller<InstrumentedNode> instrumented;
+    };
+
+    template <typename T, typename Node>
+    static Node unrollColumn(Node df, const std::string &name,
+                             const std::vector<std::string> &leaves,
+                             const std::vector<std::size_t> &variations) {
+        for (std::size_t i = 0; i < leaves.size(); ++i) {
+            df = df.Define(
+                leaves[i],
+                [variation = variations[i]](const Variations<T> &values) {
+                    return values[variation];
+                },
+                {name + variationsSuffix});
+        }
+        return df;
+    }
+
+    static const Entry &get(const std::string &name) {
+        auto &instance = getInstance();
+        std::lock_guard<std::mutex> lock(instance._mutex);
+        auto found = instance._entries.find(name);
+        if (found == instance._entries.end()) {
+            Logger::get("VariationRegistry")
+                ->critical("No variations of {} registered", name);
+            throw std::runtime_error("No variations registered");
+        }
+        return found->second;
+    }
+
+    static VariationRegistry &getInstance() {
+        static VariationRegistry instance;
+        return instance;
+    }
+
+    VariationRegistry() = default;
+    std::mutex _mutex;
+    std::map<std::string, Entry> _entries;
+};
+
+/// Function to define the variations of a quantity computed in a single step,
+/// e.g. by a FusedProducer
+///
+/// \param[in] df the input dataframe
+/// \param[in] name the name of the quantity
+/// \param[in] function function returning the `utility::Variations<T>` of
+/// the quantity
+/// \param[in] columns the input columns of the function
+///
+/// \returns a dataframe with the variation column of the quantity
+template <typename T, typename Node, typename F>
+auto DefineVariations(Node &df, const std::string &name, F function,
+                      const ROOT::RDF::ColumnNames_t &columns) {
+    VariationRegistry::add<T>(name);
+    return df.Define(name + variationsSuffix, std::move(function), columns);
+}
+
+/// Dataframe node used by producers, which only depend on the systematic
+/// shifts via their inputs. It provides the methods of the dataframe used by
+/// the producers, but each defined column holds the values of all variations,
+/// see utility::Variations. The function of the producer is called once for
+/// each distinct combination of the variations of its inputs. Columns not
+/// known to the node are used with their single value in all variations.
+/// Producers, which filter events or define columns from expressions, can
+/// not be run on the node and fail to compile.
+///
+/// The node knows, which variation of each input column belongs to each of
+/// its variations. The nodes returned by the methods share this information
+/// and add the defined columns to it.
+template <typename Node> class VariationNode {
+  public:
+    /// \param[in] node the underlying dataframe
+    /// \param[in] n the number of variations of the node
+    /// \param[in] inputs the input quantities with variation columns, with
+    /// the variation of the quantity used in each variation of the node
+    VariationNode(Node node, std::size_t n,
+                  const std::map<std::string, std::vector<std::size_t>> &inputs)
+        : _node(std::move(node)), _state(std::make_shared<State>()) {
+        _state->n = n;
+        for (const auto &[name, variations] : inputs) {
+            if (variations.size() != n) {
+                Logger::get("VariationNode")
+                    ->critical("Got {} variations of input {}, expected {}",
+                               variations.size(), name, n);
+                throw std::runtime_error("Inconsistent number of variations");
+            }
+            // the variations of inputs are only known by their index, so
+            // they are assumed to be distinct
+            _state->columns[name] = Column{variations, variations};
+        }
+    }
+
+    template <typename F>
+    VariationNode Define(std::string_view name, F function,
+                         const ROOT::RDF::ColumnNames_t &columns = {}) {
+        if constexpr (std::is_convertible_v<F, std::string>) {
+            static_assert(sizeof(F) == 0,
+                          "Columns defined from expressions can not be "
+                          "computed for all variations, run the producer "
+                          "once per shift");
+            return *this;
+        } else {
+            return lift(name, function, columns, signature(function));
+        }
+    }
+
+    template <typename F>
+    VariationNode DefineSlot(std::string_view name, F function,
+                             const ROOT::RDF::ColumnNames_t &columns = {}) {
+        return liftSlot(name, function, columns, signature(function));
+    }
+
+    template <typename F>
+    VariationNode Filter(F, const ROOT::RDF::ColumnNames_t & = {},
+                         std::string_view = "") {
+        static_assert(sizeof(F) == 0,
+                      "Filters can not be applied to single variations, run "
+                      "the producer once per shift");
+        return *this;
+    }
+
+    unsigned int GetNSlots() const { return _node.GetNSlots(); }
+
+    /// the underlying dataframe
+    Node node() const { return _node; }
+
+  private:
+    struct Column {
+        // the variation of the column read in each variation of the node
+        std::vector<std::size_t> variations;
+        // variations of the node with the same key read the same value
+        std::vector<std::size_t> keys;
+    };
+
+    struct State {
+        std::size_t n = 0;
+        std::map<std::string, Column> columns;
+    };
+
+    VariationNode(Node node, std::shared_ptr<State> state)
+        : _node(std::move(node)), _state(std::move(state)) {}
+
+    /// \returns the call operator of a function object, or the function
+    /// pointer itself, from which the types of the arguments are deduced
+    template <typename F> static auto signature(const F &) {
+        return &F::operator();
+    }
+    template <typename Ret, typename... Args>
+    static auto signature(Ret (*function)(Args...)) {
+        return function;
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    VariationNode lift(std::string_view name, F function,
+                       const ROOT::RDF::ColumnNames_t &columns,
+                       Ret (F::*)(Args...) const) {
+        return define<std::decay_t<Ret>, std::decay_t<Args>...>(
+            name,
+            [function](unsigned int, auto &&...args) {
+                return function(args...);
+            },
+            columns, std::index_sequence_for<Args...>{});
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    VariationNode lift(std::string_view name, F function,
+                       const ROOT::RDF::ColumnNames_t &columns,
+                       Ret (F::*)(Args...)) {
+        return define<std::decay_t<Ret>, std::decay_t<Args>...>(
+            name,
+            [function](unsigned int, auto &&...args) mutable {
+                return function(args...);
+            },
+            columns, std::index_sequence_for<Args...>{});
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    VariationNode lift(std::string_view name, F function,
+                       const ROOT::RDF::ColumnNames_t &columns,
+                       Ret (*)(Args...)) {
+        return define<std::decay_t<Ret>, std::decay_t<Args>...>(
+            name,
+            [function](unsigned int, auto &&...args) {
+                return function(args...);
+            },
+            columns, std::index_sequence_for<Args...>{});
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    VariationNode liftSlot(std::string_view name, F function,
+                           const ROOT::RDF::ColumnNames_t &columns,
+                           Ret (F::*)(unsigned int, Args...) const) {
+        return define<std::decay_t<Ret>, std::decay_t<Args>...>(
+            name,
+            [function](unsigned int slot, auto &&...args) {
+                return function(slot, args...);
+            },
+            columns, std::index_sequence_for<Args...>{});
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    VariationNode liftSlot(std::string_view name, F function,
+                           const ROOT::RDF::ColumnNames_t &columns,
+                           Ret (F::*)(unsigned int, Args...)) {
+        return define<std::decay_t<Ret>, std::decay_t<Args>...>(
+            name,
+            [function](unsigned int slot, auto &&...args) mutable {
+                return function(slot, args...);
+            },
+            columns, std::index_sequence_for<Args...>{});
+    }
+
+    template <typename F, typename Ret, typename... Args>
+    VariationNode liftSlot(std::string_view name, F function,
+                           const ROOT::RDF::ColumnNames_t &columns,
+                           Ret (*)(unsigned int, Args...)) {
+        return define<std::decay_t<Ret>, std::decay_t<Args>...>(
+            name,
+            [function](unsigned int slot, auto &&...args) {
+                return function(slot, args...);
+            },
+            columns, std::index_sequence_for<Args...>{});
+    }
+
+    /// Return the variations of a column, a column not known to the node is
+    /// read through a variation column sharing its value with all variations
+    template <typename T> const Column &input(const std::string &name) {
+        auto found = _state->columns.find(name);
+        if (found != _state->columns.end())
+            return found->second;
+        if (!_node.HasColumn(name + variationsSuffix)) {
+            _node = _node.Define(
+                name + variationsSuffix,
+                [](T &value) {
+                    Variations<T> result;
+                    result.shared = &value;
+                    return result;
+                },
+                {name});
+        }
+        const std::vector<std::size_t> nominal(_state->n, 0);
+        return _state->columns[name] = Column{nominal, nominal};
+    }
+
+    template <typename Ret, typename... Args, typename Call, std::size_t... I>
+    VariationNode define(std::string_view name, Call call,
+                         const ROOT::RDF::ColumnNames_t &columns,
+                         std::index_sequence<I...>) {
+        constexpr std::size_t nArgs = sizeof...(Args);
+        if (columns.size() != nArgs) {
+            Logger::get("VariationNode")
+                ->critical("{} expects {} columns, got {}", name, nArgs,
+                           columns.size());
+            throw std::runtime_error("Wrong number of columns");
+        }
+        const std::array<const Column *, nArgs> inputs = {
+            &input<Args>(columns[I])...};
+        // the variations of the node reading the same inputs are computed
+        // once, the index maps each variation to its computed value
+        std::map<std::array<std::size_t, nArgs>, std::size_t> keys;
+        auto combinations =
+            std::make_shared<std::vector<std::array<std::size_t, nArgs>>>();
+        auto index = std::make_shared<std::vector<std::size_t>>();
+        for (std::size_t variation = 0; variation < _state->n; ++variation) {
+            const std::array<std::size_t, nArgs> key = {
+                inputs[I]->keys[variation]...};
+            auto found = keys.emplace(key, combinations->size());
+            if (found.second)
+                combinations->push_back({inputs[I]->variations[variation]...});
+            index->push_back(found.first->second);
+        }
+        const bool identity = combinations->size() == _state->n;
+        const std::vector<std::size_t> *valueIndex =
+            identity || combinations->size() == 1 ? nullptr : index.get();
+        const std::string column(name);
+        VariationRegistry::add<Ret>(column);
+        auto lifted = [call, combinations, index, valueIndex](
+                          unsigned int slot,
+                          Variations<Args> &...args) mutable {
+            Variations<Ret> result;
+            result.values.reserve(combinations->size());
+            result.index = valueIndex;
+            for (const auto &combination : *combinations)
+                result.values.push_back(call(slot, args[combination[I]]...));
+            return result;
+        };
+        std::vector<std::size_t> variations(_state->n);
+        for (std::size_t variation = 0; variation < _state->n; ++variation)
+            variations[variation] = variation;
+        ROOT::RDF::ColumnNames_t variationColumns = {
+            (columns[I] + variationsSuffix)...};
+        auto next = _node.DefineSlot(column + variationsSuffix,
+                                     std::move(lifted), variationColumns);
+        _state->columns[column] = Column{variations, *index};
+        return VariationNode(Node(next), _state);
+    }
+
+    Node _node;
+    std::shared_ptr<State> _state;
+};
+
+/// Function used by the generated code to run a producer, which only depends
+/// on the systematic shifts via its inputs, once for all variations, see
+/// utility::VariationNode
+///
+/// \param[in] df the input dataframe of the producer
+/// \param[in] n the number of variations
+/// \param[in] inputs the input quantities with variation columns, with the
+/// variation of the quantity used in each of the `n` variations
+/// \param[in] producer function calling the producer with the node
+///
+/// \returns the dataframe returned by the producer
+template <typename Node, typename F>
+auto vary(Node &df, std::size_t n,
+          const std::map<std::string, std::vector<std::size_t>> &inputs,
+          F producer) {
+    if constexpr (std::is_same_v<Node, InstrumentedNode>) {
+        VariationNode<InstrumentedNode> node(df, n, inputs);
+        return producer(node).node();
+    } else {
+        VariationNode<ROOT::RDF::RNode> node(ROOT::RDF::RNode(df), n, inputs);
+        return producer(node).node();
+    }
+}
+
+/// Function used by the generated code to define the columns of single
+/// variations of a quantity, which are read by producers without variations
+/// or written to the output
+///
+/// \param[in] df the input dataframe
+/// \param[in] name the name of the quantity
+/// \param[in] leaves the names of the new columns
+/// \param[in] variations the variation of each new column
+///
+/// \returns a dataframe with the new columns
+template <typename Node>
+auto unroll(Node &df, const std::string &name,
+            const std::vector<std::string> &leaves,
+            const std::vector<std::size_t> &variations) {
+    if constexpr (std::is_same_v<Node, InstrumentedNode>) {
+        return VariationRegistry::unroll<InstrumentedNode>(df, name, leaves,
+                                                           variations);
+    } else {
+        return VariationRegistry::unroll<ROOT::RDF::RNode>(
+            ROOT::RDF::RNode(df), name, leaves, variations);
+    }
+}
+
+} // namespace utility
+
+#endif /* GUARDVARIATIONS_H */
@@ -1,6 +1,8 @@
 #ifndef GUARDUTILITY_H
 #define GUARDUTILITY_H
 
+#include <array>
+
 /// Namespace used for common utility functions.
 namespace utility {
 bool ApproxEqual(auto value1, auto value2, double maxDelta = 1e-5) {
@@ -46,5 +48,57 @@ auto PassAsVec(F &&f) -> PassAsVecHelper<std::make_index_sequence<N>, T, F> {
     return utility::PassAsVecHelper<std::make_index_sequence<N>, T, F>(
         std::forward<F>(f));
 }
+
+/// Helper to pass N columns of type T to a function as a single
+/// `std::array<double, N>`. In contrast to PassAsVec, the values are kept on
+/// the stack, so no memory is allocated per call.
+template <typename I, typename T, typename F> class PassAsArrayHelper;
+
+template <std::size_t... N, typename T, typename F>
+class PassAsArrayHelper<std::index_sequence<N...>, T, F> {
+    template <std::size_t Idx> using AlwaysT = T;
+    typename std::decay<F>::type fFunc;
+
+  public:
+    PassAsArrayHelper(F &&f) : fFunc(std::forward<F>(f)) {}
+    auto operator()(AlwaysT<N>... args) -> decltype(fFunc(
+        std::array<double, sizeof...(N)>{static_cast<double>(args)...})) {
+        return fFunc(
+            std::array<double, sizeof...(N)>{static_cast<double>(args)...});
+    }
+};
+
+template <std::size_t N, typename T, typename F>
+auto PassAsArray(F &&f)
+    -> PassAsArrayHelper<std::make_index_sequence<N>, T, F> {
+    return utility::PassAsArrayHelper<std::make_index_sequence<N>, T, F>(
+        std::forward<F>(f));
+}
+
+/// Variant of PassAsArray for `DefineSlot`: the processing slot is passed as
+/// first argument to the function, followed by the array of inputs
+template <typename I, typename T, typename F> class PassAsArrayWithSlotHelper;
+
+template <std::size_t... N, typename T, typename F>
+class PassAsArrayWithSlotHelper<std::index_sequence<N...>, T, F> {
+    template <std::size_t Idx> using AlwaysT = T;
+    typename std::decay<F>::type fFunc;
+
+  public:
+    PassAsArrayWithSlotHelper(F &&f) : fFunc(std::forward<F>(f)) {}
+    auto operator()(unsigned int slot, AlwaysT<N>... args)
+        -> decltype(fFunc(slot, std::array<double, sizeof...(N)>{
+                                    static_cast<double>(args)...})) {
+        return fFunc(slot, std::array<double, sizeof...(N)>{
+                               static_cast<double>(args)...});
+    }
+};
+
+template <std::size_t N, typename T, typename F>
+auto PassAsArrayWithSlot(F &&f)
+    -> PassAsArrayWithSlotHelper<std::make_index_sequence<N>, T, F> {
+    return utility::PassAsArrayWithSlotHelper<std::make_index_sequence<N>, T,
+                                              F>(std::forward<F>(f));
+}
 } // end namespace utility
 #endif /* GUARDUTILITY_H */
\ No newline at end of file
@@ -0,0 +1,154 @@
+// Check of the payload parser and the corrections of the JetEnergyCorrector,
+// using the small JetMET payloads in tests/data/jetmet. The expected values
+// are computed by hand from the payloads.
+//
+// Usage: jet_energy_corrector_check PAYLOAD_DIRECTORY
+#include "src/JetCorrections/JetEnergyCorrector.cxx"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string &description) {
+    if (!condition) {
+        std::cerr << "FAILED: " << description << std::endl;
+        ++failures;
+    }
+}
+
+void checkClose(float value, float expected, const std::string &description) {
+    check(std::abs(value - expected) <= 1e-4f * std::abs(expected),
+          description + ": got " + std::to_string(value) + ", expected " +
+              std::to_string(expected));
+}
+
+void checkThrows(const std::function<void()> &function,
+                 const std::string &description) {
+    try {
+        function();
+    } catch (const std::runtime_error &) {
+        return;
+    }
+    check(false, description + " did not throw");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " PAYLOAD_DIRECTORY" << std::endl;
+        return 1;
+    }
+    const std::string directory = argv[1];
+    const std::string uncertainties = directory + "/UncertaintySources.txt";
+    const std::string resolution = directory + "/PtResolution.txt";
+    const std::string scaleFactors = directory + "/ScaleFactors.txt";
+    const ROOT::RVec<float> noGenJets;
+
+    // jet energy scale uncertainties, interpolated linearly in pt and clamped
+    // to the first and last point and eta bin
+    const JetEnergyCorrector scale(uncertainties, "", "");
+    check(scale.HasUncertainties() && !scale.HasSmearing(),
+          "uncertainty payload is loaded without smearing");
+    const ROOT::RVec<float> pt = {60.f, 5.f, 60.f};
+    const ROOT::RVec<float> eta = {-1.f, -1.f, 7.f};
+    const ROOT::RVec<float> phi = {0.f, 1.f, 2.f};
+    const auto shifted =
+        scale.Correct(pt, eta, phi, noGenJets, noGenJets, noGenJets, 0.f,
+                      {scale.MakeVariation({"SourceA"}, 0, 0),
+                       scale.MakeVariation({"SourceA"}, 1, 0),
+                       scale.MakeVariation({"SourceA"}, -1, 0),
+                       scale.MakeVariation({"SourceA", "SourceB"}, 1, 0)});
+    for (std::size_t i = 0; i < pt.size(); ++i)
+        checkClose(shifted[0][i], pt[i], "nominal jet without smearing");
+    checkClose(shifted[1][0], 60.f * 1.015f, "SourceA up, interpolated");
+    checkClose(shifted[1][1], 5.f * 1.02f, "SourceA up, below the first pt");
+    checkClose(shifted[1][2], 60.f * 1.03f, "SourceA up, outside the eta bins");
+    checkClose(shifted[2][0], 60.f * 0.975f, "SourceA down, interpolated");
+    checkClose(shifted[3][0],
+               60.f * (1.f + std::sqrt(0.015f * 0.015f + 0.03f * 0.03f)),
+               "SourceA and SourceB up, added in quadrature");
+
+    // jet energy resolution smearing, the first jet has a matching gen jet
+    // and the others are smeared stochastically
+    const JetEnergyCorrector smearing("", resolution, scaleFactors);
+    check(!smearing.HasUncertainties() && smearing.HasSmearing(),
+          "resolution payloads are loaded without uncertainties");
+    const ROOT::RVec<float> jetPt = {100.f, 60.f, 100.f};
+    const ROOT::RVec<float> jetEta = {-1.f, 1.f, -2.f};
+    const ROOT::RVec<float> jetPhi = {0.f, 2.f, -2.f};
+    const ROOT::RVec<float> genPt = {90.f};
+    const ROOT::RVec<float> genEta = {-1.05f};
+    const ROOT::RVec<float> genPhi = {0.05f};
+    const std::vector<JetEnergyCorrector::Variation> variations = {
+        smearing.MakeVariation({}, 0, 0), smearing.MakeVariation({}, 0, 1),
+        smearing.MakeVariation({}, 0, -1)};
+    const auto smeared = smearing.Correct(jetPt, jetEta, jetPhi, genPt, genEta,
+                                          genPhi, 10.f, variations);
+    checkClose(smeared[0][0], 100.f * (1.f + 0.10f * 10.f / 100.f),
+               "hybrid smearing, nominal");
+    checkClose(smeared[1][0], 100.f * (1.f + 0.15f * 10.f / 100.f),
+               "hybrid smearing, up");
+    checkClose(smeared[2][0], 100.f * (1.f + 0.05f * 10.f / 100.f),
+               "hybrid smearing, down");
+    // the stochastic smearing uses the same random number in all variations
+    const auto gaus = [](float corrected, float pt, float sf) {
+        return (corrected / pt - 1.f) / std::sqrt(sf * sf - 1.f);
+    };
+    check(smeared[0][1] != jetPt[1], "stochastic smearing changes the jet");
+    const float nominalGaus = gaus(smeared[0][1], 60.f, 1.1f);
+    checkClose(gaus(smeared[1][1], 60.f, 1.15f), nominalGaus,
+               "stochastic smearing, up");
+    checkClose(gaus(smeared[2][1], 60.f, 1.05f), nominalGaus,
+               "stochastic smearing, down");
+    const auto repeated = smearing.Correct(jetPt, jetEta, jetPhi, genPt, genEta,
+                                           genPhi, 10.f, variations[0]);
+    for (std::size_t i = 0; i < jetPt.size(); ++i)
+        check(repeated[i] == smeared[0][i], "smearing is reproducible");
+    // the resolution is binned in rho, the third jet falls into the second
+    // rho bin for rho = 50
+    const auto highRho = smearing.Correct(jetPt, jetEta, jetPhi, genPt, genEta,
+                                          genPhi, 50.f, variations[0]);
+    checkClose((highRho[2] / jetPt[2] - 1.f) / (smeared[0][2] / jetPt[2] - 1.f),
+               std::sqrt(0.0129f / 0.0126f), "resolution binned in rho");
+
+    // without payloads, the nominal jets are not modified and shifts are
+    // rejected
+    const JetEnergyCorrector none("", "", "");
+    const auto unchanged =
+        none.Correct(jetPt, jetEta, jetPhi, genPt, genEta, genPhi, 10.f,
+                     none.MakeVariation({""}, 0, 0));
+    for (std::size_t i = 0; i < jetPt.size(); ++i)
+        check(unchanged[i] == jetPt[i], "no correction without payloads");
+    checkThrows([&]() { none.MakeVariation({}, 0, 1); },
+                "resolution shift without payloads");
+    checkThrows([&]() { none.MakeVariation({}, 1, 0); },
+                "scale shift without sources");
+    checkThrows([&]() { scale.MakeVariation({"SourceC"}, 1, 0); },
+                "unknown uncertainty source");
+    checkThrows([&]() { JetEnergyCorrector("", resolution, ""); },
+                "resolution without scale factors");
+    checkThrows(
+        [&]() { JetEnergyCorrector(directory + "/missing.txt", "", ""); },
+        "missing payload");
+    checkThrows([&]() { JetEnergyCorrector("", scaleFactors, resolution); },
+                "unsupported resolution formula");
+    checkThrows(
+        [&]() {
+            JetEnergyCorrector("", directory + "/PtResolutionNoRange.txt",
+                               scaleFactors);
+        },
+        "resolution without a range of the jet pt");
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
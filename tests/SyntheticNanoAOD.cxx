@@ -0,0 +1,423 @@
+// Generator of synthetic NanoAOD files for offline tests and benchmarks. The
+// Events tree contains the branches defined in
+// code_generation/quantities/nanoAOD.py and the ones used directly in the
+// configurations (IDs, flags and triggers), with the types used in NanoAOD.
+// The multiplicities and kinematics roughly follow Z->tautau events in the
+// mutau channel, so that a fraction of the events passes the selections.
+//
+// Usage: synthetic_nanoaod [--events N] [--cluster-size N]
+//                          [--compression N] [--seed N] [--output FILE]
+#include "Rtypes.h"
+#include "TFile.h"
+#include "TMath.h"
+#include "TRandom3.h"
+#include "TTree.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string output = "nanoAOD.root";
+    long long events = 10000;
+    // entries per cluster, 0 keeps the default of ROOT
+    long long clusterSize = 0;
+    // ROOT compression setting, 100 * algorithm + level; NanoAOD uses LZMA 9
+    int compression = 209;
+    unsigned int seed = 1;
+};
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--events N] [--cluster-size N] [--compression N]"
+                         " [--seed N] [--output FILE]"
+                      << std::endl;
+            return false;
+        }
+        if (arg == "--events")
+            options.events = std::atoll(argv[++i]);
+        else if (arg == "--cluster-size")
+            options.clusterSize = std::atoll(argv[++i]);
+        else if (arg == "--compression")
+            options.compression = std::atoi(argv[++i]);
+        else if (arg == "--seed")
+            options.seed = std::atoi(argv[++i]);
+        else if (arg == "--output")
+            options.output = argv[++i];
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// leaf type codes of TTree::Branch
+template <typename T> constexpr char leafType();
+template <> constexpr char leafType<Float_t>() { return 'F'; }
+template <> constexpr char leafType<Int_t>() { return 'I'; }
+template <> constexpr char leafType<UInt_t>() { return 'i'; }
+template <> constexpr char leafType<UChar_t>() { return 'b'; }
+template <> constexpr char leafType<Bool_t>() { return 'O'; }
+template <> constexpr char leafType<ULong64_t>() { return 'l'; }
+
+// Scalar branches are stored in this class, so that their addresses stay
+// valid while the tree is filled.
+template <typename T> struct Scalar {
+    Scalar(TTree &tree, const std::string &name) {
+        tree.Branch(name.c_str(), &value,
+                    (name + "/" + leafType<T>()).c_str());
+    }
+    T value{};
+};
+
+// A collection of objects, like the taus of an event. The number of objects
+// is stored in the branch "n<name>", each column in the branch
+// "<name>_<column>".
+class Collection {
+  public:
+    Collection(TTree &tree, const std::string &name, UInt_t maxSize)
+        : _tree(tree), _name(name), _maxSize(maxSize) {
+        _tree.Branch(("n" + name).c_str(), &size,
+                     ("n" + name + "/i").c_str());
+    }
+
+    template <typename T> T *column(const std::string &column) {
+        auto buffer = std::make_shared<std::vector<T>>(_maxSize);
+        _buffers.push_back(buffer);
+        const std::string branch = _name + "_" + column;
+        _tree.Branch(branch.c_str(), buffer->data(),
+                     (branch + "[n" + _name + "]/" + leafType<T>()).c_str());
+        return buffer->data();
+    }
+
+    void resize(UInt_t n) { size = std::min(n, _maxSize); }
+
+    UInt_t size = 0;
+
+  private:
+    TTree &_tree;
+    std::string _name;
+    UInt_t _maxSize;
+    std::vector<std::shared_ptr<void>> _buffers;
+};
+
+struct Particles {
+    explicit Particles(TTree &tree, const std::string &name, UInt_t maxSize)
+        : objects(tree, name, maxSize), pt(objects.column<Float_t>("pt")),
+          eta(objects.column<Float_t>("eta")),
+          phi(objects.column<Float_t>("phi")),
+          mass(objects.column<Float_t>("mass")) {}
+
+    Collection objects;
+    Float_t *pt;
+    Float_t *eta;
+    Float_t *phi;
+    Float_t *mass;
+};
+
+// random working point bitmask, the working points are cumulative
+UChar_t workingPoints(TRandom3 &random, int nWorkingPoints, double score) {
+    const int passed = std::min(
+        nWorkingPoints, int(score * (nWorkingPoints + 1) + random.Gaus(0, 1)));
+    return passed <= 0 ? 0 : UChar_t((1 << passed) - 1);
+}
+
+float randomPhi(TRandom3 &random) {
+    return random.Uniform(-TMath::Pi(), TMath::Pi());
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+    TFile file(options.output.c_str(), "RECREATE", "", options.compression);
+    if (file.IsZombie()) {
+        std::cerr << "Could not create " << options.output << std::endl;
+        return 1;
+    }
+    TTree tree("Events", "Events");
+    if (options.clusterSize > 0)
+        tree.SetAutoFlush(options.clusterSize);
+    TRandom3 random(options.seed);
+
+    Scalar<UInt_t> run(tree, "run");
+    Scalar<UInt_t> luminosityBlock(tree, "luminosityBlock");
+    Scalar<ULong64_t> event(tree, "event");
+
+    Particles tau(tree, "Tau", 16);
+    auto tauDz = tau.objects.column<Float_t>("dz");
+    auto tauDxy = tau.objects.column<Float_t>("dxy");
+    auto tauCharge = tau.objects.column<Int_t>("charge");
+    auto tauDecayMode = tau.objects.column<Int_t>("decayMode");
+    auto tauGenPartFlav = tau.objects.column<UChar_t>("genPartFlav");
+    auto tauRawVSjet = tau.objects.column<Float_t>("rawDeepTau2017v2p1VSjet");
+    auto tauVSjet = tau.objects.column<UChar_t>("idDeepTau2017v2p1VSjet");
+    auto tauVSe = tau.objects.column<UChar_t>("idDeepTau2017v2p1VSe");
+    auto tauVSmu = tau.objects.column<UChar_t>("idDeepTau2017v2p1VSmu");
+    auto tauGenPartIdx = tau.objects.column<Int_t>("genPartIdx");
+    auto tauJetIdx = tau.objects.column<Int_t>("jetIdx");
+
+    Particles muon(tree, "Muon", 16);
+    auto muonIso = muon.objects.column<Float_t>("pfRelIso04_all");
+    auto muonDz = muon.objects.column<Float_t>("dz");
+    auto muonDxy = muon.objects.column<Float_t>("dxy");
+    auto muonCharge = muon.objects.column<Int_t>("charge");
+    auto muonGenPartFlav = muon.objects.column<UChar_t>("genPartFlav");
+    auto muonGenPartIdx = muon.objects.column<Int_t>("genPartIdx");
+    auto muonLooseId = muon.objects.column<Bool_t>("looseId");
+    auto muonMediumId = muon.objects.column<Bool_t>("mediumId");
+
+    Particles electron(tree, "Electron", 16);
+    auto electronDxy = electron.objects.column<Float_t>("dxy");
+    auto electronDz = electron.objects.column<Float_t>("dz");
+    auto electronIso = electron.objects.column<Float_t>("pfRelIso03_all");
+    auto electronCharge = electron.objects.column<Int_t>("charge");
+    auto electronCutBased = electron.objects.column<Int_t>("cutBased");
+    auto electronMvaWP90 =
+        electron.objects.column<Bool_t>("mvaFall17V2noIso_WP90");
+
+    Particles jet(tree, "Jet", 64);
+    auto jetId = jet.objects.column<Int_t>("jetId");
+    auto jetGenJetIdx = jet.objects.column<Int_t>("genJetIdx");
+    auto jetBtag = jet.objects.column<Float_t>("btagDeepFlavB");
+
+    Particles genJet(tree, "GenJet", 64);
+
+    Particles genPart(tree, "GenPart", 256);
+    auto genPdgId = genPart.objects.column<Int_t>("pdgId");
+    auto genStatus = genPart.objects.column<Int_t>("status");
+    auto genStatusFlags = genPart.objects.column<Int_t>("statusFlags");
+
+    Collection trigObj(tree, "TrigObj", 128);
+    auto trigPt = trigObj.column<Float_t>("pt");
+    auto trigEta = trigObj.column<Float_t>("eta");
+    auto trigPhi = trigObj.column<Float_t>("phi");
+    auto trigId = trigObj.column<Int_t>("id");
+    auto trigBits = trigObj.column<Int_t>("filterBits");
+
+    Scalar<Float_t> pileupNTrueInt(tree, "Pileup_nTrueInt");
+    Scalar<Float_t> pileupDensity(tree, "Pileup_pudensity");
+
+    Scalar<Float_t> htxsHiggsPt(tree, "HTXS_Higgs_pt");
+    Scalar<UChar_t> htxsNJets30(tree, "HTXS_njets30");
+    Scalar<Int_t> htxsStage0(tree, "HTXS_stage_0");
+    Scalar<Int_t> htxsStage1(tree, "HTXS_stage_1_pTjet30");
+    Scalar<Int_t> htxsStage11Fine(tree, "HTXS_stage1_1_fine_cat_pTjet30GeV");
+    Scalar<Int_t> htxsStage12(tree, "HTXS_stage1_2_cat_pTjet30GeV");
+    Scalar<Int_t> htxsStage12Fine(tree, "HTXS_stage1_2_fine_cat_pTjet30GeV");
+
+    Scalar<Float_t> metCovXX(tree, "MET_covXX");
+    Scalar<Float_t> metCovXY(tree, "MET_covXY");
+    Scalar<Float_t> metCovYY(tree, "MET_covYY");
+    Scalar<Float_t> metSignificance(tree, "MET_significance");
+    Scalar<Float_t> puppiMetPt(tree, "PuppiMET_pt");
+    Scalar<Float_t> puppiMetPhi(tree, "PuppiMET_phi");
+    Scalar<Float_t> puppiMetSumEt(tree, "PuppiMET_sumEt");
+    Scalar<Float_t> puppiMetPtUp(tree, "PuppiMET_ptUnclusteredUp");
+    Scalar<Float_t> puppiMetPtDown(tree, "PuppiMET_ptUnclusteredDown");
+    Scalar<Float_t> puppiMetPhiUp(tree, "PuppiMET_phiUnclusteredUp");
+    Scalar<Float_t> puppiMetPhiDown(tree, "PuppiMET_phiUnclusteredDown");
+
+    Scalar<Bool_t> flagGoodVertices(tree, "Flag_goodVertices");
+    Scalar<Bool_t> flagMETFilters(tree, "Flag_METFilters");
+    Scalar<Bool_t> hltIsoMu24(tree, "HLT_IsoMu24");
+    Scalar<Bool_t> hltIsoMu27(tree, "HLT_IsoMu27");
+    Scalar<Bool_t> hltMuTau(
+        tree, "HLT_IsoMu20_eta2p1_LooseChargedIsoPFTauHPS27_eta2p1_CrossL1");
+
+    const std::array<int, 4> decayModes = {0, 1, 10, 11};
+    const std::array<int, 7> otherTriggerIds = {1, 2, 3, 6, 11, 14, 22};
+
+    for (long long entry = 0; entry < options.events; ++entry) {
+        run.value = 1;
+        luminosityBlock.value = entry / 1000 + 1;
+        event.value = entry + 1;
+
+        // generator particles: the two taus of the boson decay and their
+        // visible decay products come first, followed by the rest of the
+        // event
+        genPart.objects.resize(6 + random.Poisson(60));
+        const float bosonPt = random.Exp(20.);
+        const float bosonPhi = randomPhi(random);
+        for (UInt_t i = 0; i < genPart.objects.size; ++i) {
+            genPart.pt[i] = random.Exp(i < 6 ? 35. : 5.);
+            genPart.eta[i] = random.Gaus(0., i < 6 ? 1.2 : 3.);
+            genPart.phi[i] = randomPhi(random);
+            genPart.mass[i] = i < 6 ? 1.777 : random.Uniform(0., 1.);
+            genPdgId[i] = i < 2 ? (i == 0 ? 15 : -15)
+                                : (i == 2 ? 13 : (i == 3 ? -16 : 211));
+            genStatus[i] = i < 2 ? 2 : 1;
+            genStatusFlags[i] = i < 6 ? (1 << 0) | (1 << 13) : 0;
+        }
+
+        // muons, mostly one prompt muon from the tau decay
+        muon.objects.resize(random.Rndm() < 0.9 ? 1 + random.Poisson(0.2)
+                                                : random.Poisson(0.5));
+        for (UInt_t i = 0; i < muon.objects.size; ++i) {
+            const bool prompt = i == 0;
+            muon.pt[i] = (prompt ? 18. : 3.) + random.Exp(prompt ? 15. : 8.);
+            muon.eta[i] = prompt ? genPart.eta[2] + random.Gaus(0., 0.01)
+                                 : random.Uniform(-2.4, 2.4);
+            muon.phi[i] = prompt ? genPart.phi[2] + random.Gaus(0., 0.01)
+                                 : randomPhi(random);
+            muon.mass[i] = 0.10566;
+            muonIso[i] = random.Exp(prompt ? 0.05 : 0.4);
+            muonDz[i] = random.Gaus(0., 0.05);
+            muonDxy[i] = random.Gaus(0., 0.01);
+            muonCharge[i] = random.Rndm() < 0.5 ? -1 : 1;
+            muonGenPartFlav[i] = prompt ? 15 : (random.Rndm() < 0.5 ? 0 : 5);
+            muonGenPartIdx[i] = prompt ? 2 : -1;
+            muonLooseId[i] = random.Rndm() < 0.97;
+            muonMediumId[i] = muonLooseId[i] && random.Rndm() < 0.95;
+        }
+
+        // hadronic taus, the first one from the tau decay, the others from
+        // misidentified jets
+        tau.objects.resize(random.Rndm() < 0.8 ? 1 + random.Poisson(0.6)
+                                               : random.Poisson(1.));
+        for (UInt_t i = 0; i < tau.objects.size; ++i) {
+            const bool genuine = i == 0;
+            tau.pt[i] = 20. + random.Exp(genuine ? 20. : 12.);
+            tau.eta[i] = random.Uniform(-2.4, 2.4);
+            tau.phi[i] = randomPhi(random);
+            tau.mass[i] = random.Uniform(0.14, 1.6);
+            tauDz[i] = random.Gaus(0., 0.08);
+            tauDxy[i] = random.Gaus(0., 0.02);
+            tauCharge[i] = random.Rndm() < 0.5 ? -1 : 1;
+            tauDecayMode[i] = random.Rndm() < 0.05
+                                  ? 5
+                                  : decayModes[random.Integer(4)];
+            tauGenPartFlav[i] = genuine ? 5 : random.Integer(2) * 4;
+            tauGenPartIdx[i] = genuine ? 1 : -1;
+            const double score =
+                genuine ? 1. - random.Exp(0.1) : random.Exp(0.3);
+            tauRawVSjet[i] = std::clamp(score, 0., 1.);
+            tauVSjet[i] = workingPoints(random, 8, tauRawVSjet[i]);
+            tauVSe[i] = workingPoints(random, 8, genuine ? 0.9 : 0.6);
+            tauVSmu[i] = workingPoints(random, 4, genuine ? 0.9 : 0.7);
+        }
+
+        // jets and the matching generator jets
+        jet.objects.resize(2 + random.Poisson(4.));
+        genJet.objects.resize(jet.objects.size + random.Poisson(1.));
+        for (UInt_t i = 0; i < genJet.objects.size; ++i) {
+            genJet.pt[i] = 10. + random.Exp(30.);
+            genJet.eta[i] = random.Uniform(-4.7, 4.7);
+            genJet.phi[i] = randomPhi(random);
+            genJet.mass[i] = random.Exp(6.);
+        }
+        for (UInt_t i = 0; i < jet.objects.size; ++i) {
+            const bool matched = random.Rndm() < 0.85;
+            jet.pt[i] = matched ? genJet.pt[i] * random.Gaus(1., 0.12)
+                                : 15. + random.Exp(10.);
+            jet.eta[i] = matched ? genJet.eta[i] + random.Gaus(0., 0.02)
+                                 : random.Uniform(-4.7, 4.7);
+            jet.phi[i] = matched ? genJet.phi[i] + random.Gaus(0., 0.02)
+                                 : randomPhi(random);
+            jet.mass[i] = random.Exp(7.);
+            jetId[i] = random.Rndm() < 0.95 ? 6 : 2;
+            jetGenJetIdx[i] = matched ? int(i) : -1;
+            jetBtag[i] = random.Rndm() < 0.1 ? 1. - random.Exp(0.05)
+                                             : random.Exp(0.05);
+        }
+        for (UInt_t i = 0; i < tau.objects.size; ++i)
+            tauJetIdx[i] = i < jet.objects.size ? int(i) : -1;
+
+        electron.objects.resize(random.Poisson(0.3));
+        for (UInt_t i = 0; i < electron.objects.size; ++i) {
+            electron.pt[i] = 7. + random.Exp(15.);
+            electron.eta[i] = random.Uniform(-2.5, 2.5);
+            electron.phi[i] = randomPhi(random);
+            electron.mass[i] = 0.000511;
+            electronDxy[i] = random.Gaus(0., 0.02);
+            electronDz[i] = random.Gaus(0., 0.06);
+            electronIso[i] = random.Exp(0.2);
+            electronCharge[i] = random.Rndm() < 0.5 ? -1 : 1;
+            electronCutBased[i] = random.Integer(5);
+            electronMvaWP90[i] = random.Rndm() < 0.7;
+        }
+
+        // trigger objects: the muons and taus fire the triggers in most
+        // events, further objects with other ids are added
+        const UInt_t nOther = random.Poisson(8.);
+        UInt_t nTrig = 0;
+        for (UInt_t i = 0; i < muon.objects.size && nTrig < 128; ++i) {
+            if (random.Rndm() > 0.9)
+                continue;
+            trigPt[nTrig] = muon.pt[i] * random.Gaus(1., 0.02);
+            trigEta[nTrig] = muon.eta[i] + random.Gaus(0., 0.005);
+            trigPhi[nTrig] = muon.phi[i] + random.Gaus(0., 0.005);
+            trigId[nTrig] = 13;
+            trigBits[nTrig] = (1 << 1) | (1 << 3) | (random.Rndm() < 0.9) << 4;
+            ++nTrig;
+        }
+        for (UInt_t i = 0; i < tau.objects.size && nTrig < 128; ++i) {
+            if (random.Rndm() > 0.7)
+                continue;
+            trigPt[nTrig] = tau.pt[i] * random.Gaus(1., 0.05);
+            trigEta[nTrig] = tau.eta[i] + random.Gaus(0., 0.01);
+            trigPhi[nTrig] = tau.phi[i] + random.Gaus(0., 0.01);
+            trigId[nTrig] = 15;
+            trigBits[nTrig] = random.Integer(1 << 10);
+            ++nTrig;
+        }
+        for (UInt_t i = 0; i < nOther && nTrig < 128; ++i) {
+            trigPt[nTrig] = random.Exp(20.);
+            trigEta[nTrig] = random.Uniform(-2.5, 2.5);
+            trigPhi[nTrig] = randomPhi(random);
+            trigId[nTrig] = otherTriggerIds[random.Integer(7)];
+            trigBits[nTrig] = random.Integer(1 << 10);
+            ++nTrig;
+        }
+        trigObj.resize(nTrig);
+
+        pileupNTrueInt.value = random.Gaus(32., 10.);
+        pileupDensity.value = std::max(0., random.Gaus(20., 6.));
+
+        htxsHiggsPt.value = random.Exp(40.);
+        htxsNJets30.value = std::min<UInt_t>(jet.objects.size, 4);
+        htxsStage0.value = 11;
+        htxsStage1.value = 101 + random.Integer(8);
+        htxsStage11Fine.value = 101 + random.Integer(20);
+        htxsStage12.value = 101 + random.Integer(10);
+        htxsStage12Fine.value = 101 + random.Integer(30);
+
+        const float metPt = std::abs(random.Gaus(bosonPt, 15.));
+        metCovXX.value = random.Gaus(400., 80.);
+        metCovYY.value = random.Gaus(400., 80.);
+        metCovXY.value = random.Gaus(0., 40.);
+        metSignificance.value = random.Exp(3.);
+        puppiMetPt.value = metPt;
+        puppiMetPhi.value = bosonPhi + random.Gaus(0., 0.3);
+        puppiMetSumEt.value = 300. + random.Exp(300.);
+        puppiMetPtUp.value = metPt * random.Gaus(1.02, 0.01);
+        puppiMetPtDown.value = metPt * random.Gaus(0.98, 0.01);
+        puppiMetPhiUp.value = puppiMetPhi.value + random.Gaus(0., 0.01);
+        puppiMetPhiDown.value = puppiMetPhi.value + random.Gaus(0., 0.01);
+
+        flagGoodVertices.value = random.Rndm() < 0.995;
+        flagMETFilters.value = random.Rndm() < 0.98;
+        const float leadingMuonPt = muon.objects.size > 0 ? muon.pt[0] : 0.;
+        hltIsoMu24.value = leadingMuonPt > 24. && random.Rndm() < 0.9;
+        hltIsoMu27.value = leadingMuonPt > 27. && random.Rndm() < 0.9;
+        hltMuTau.value = leadingMuonPt > 20. && tau.objects.size > 0 &&
+                         random.Rndm() < 0.8;
+
+        tree.Fill();
+    }
+    file.Write();
+    std::cout << "Wrote " << options.events << " events to " << options.output
+              << std::endl;
+    return 0;
+}
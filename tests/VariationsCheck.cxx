@@ -0,0 +1,165 @@
+// Check of the variation columns of utility::Variations. A chain of producers
+// is run once per shift, like in the default code generation, and once for
+// all shifts on a utility::VariationNode, starting from the fused tau energy
+// correction. The unrolled columns of the fused chain have to agree with the
+// columns of the shifts.
+//
+// Usage: variations_check
+#include "Math/Vector4D.h"
+#include "Math/VectorUtil.h"
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RVec.hxx"
+#include "src/physicsobjects.hxx"
+#include "src/utility/Variations.hxx"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string &description) {
+    if (!condition) {
+        std::cerr << "FAILED: " << description << std::endl;
+        ++failures;
+    }
+}
+
+// the shifts of the tau energy scale of decay mode 0 and 1
+const std::vector<std::string> shifts = {"", "__tauES_DM0Up",
+                                         "__tauES_DM0Down", "__tauES_DM1Up"};
+const std::vector<float> sf_dm0 = {1.0f, 1.05f, 0.95f, 1.0f};
+const std::vector<float> sf_dm1 = {1.0f, 1.0f, 1.0f, 1.05f};
+
+int countObjects(const ROOT::RVec<int> &mask) {
+    return ROOT::VecOps::Sum(mask);
+}
+
+// producers of the chain, with a function pointer and a slot function, as
+// they are used by the producers in src/
+auto NumberOfTaus(auto &df, const std::string &outputname,
+                  const std::string &mask) {
+    return df.Define(outputname, &countObjects, {mask});
+}
+
+auto LeadingTauPt(auto &df, const std::string &outputname,
+                  const std::string &pt, const std::string &mask) {
+    return df.DefineSlot(
+        outputname,
+        [](unsigned int, const ROOT::RVec<float> &pts,
+           const ROOT::RVec<int> &selected) {
+            const auto good = pts[selected == 1];
+            return good.empty() ? -1.f : ROOT::VecOps::Max(good);
+        },
+        {pt, mask});
+}
+
+auto Chain(auto &df, const std::string &shift) {
+    auto df1 = physicsobject::ObjectMassCorrectionWithPt(
+        df, "Tau_mass_corrected" + shift, "Tau_mass", "Tau_pt",
+        "Tau_pt_corrected" + shift);
+    auto df2 = physicsobject::SelectObjectMask(
+        df1, "good_taus_mask" + shift,
+        physicsobject::selection::Min("Tau_pt_corrected" + shift, 30.),
+        physicsobject::selection::AbsMax("Tau_eta", 2.3));
+    auto df3 = NumberOfTaus(df2, "ntaus" + shift, "good_taus_mask" + shift);
+    return LeadingTauPt(df3, "leading_pt" + shift, "Tau_pt_corrected" + shift,
+                        "good_taus_mask" + shift);
+}
+
+template <typename T> bool equal(const T &a, const T &b) { return a == b; }
+template <typename T>
+bool equal(const ROOT::RVec<T> &a, const ROOT::RVec<T> &b) {
+    return a.size() == b.size() && ROOT::VecOps::All(a == b);
+}
+
+template <typename T>
+void compare(ROOT::RDF::RNode perShift, ROOT::RDF::RNode fused,
+             const std::string &name) {
+    for (const auto &shift : shifts) {
+        const auto expected = perShift.Take<T>(name + shift);
+        const auto result = fused.Take<T>(name + shift);
+        bool same = expected->size() == result->size();
+        for (std::size_t i = 0; same && i < expected->size(); ++i)
+            same = equal((*expected)[i], (*result)[i]);
+        check(same, name + shift + " of the fused chain");
+    }
+}
+
+} // namespace
+
+int main() {
+    // taus with decay modes 0, 1 and 10 and pts around the cut of the chain
+    auto df = ROOT::RDataFrame(200)
+                  .Define("Tau_pt",
+                          [](ULong64_t entry) {
+                              ROOT::RVec<float> pt(entry % 4);
+                              for (std::size_t i = 0; i < pt.size(); ++i)
+                                  pt[i] = 26.f + (entry * 7 + i * 3) % 9;
+                              return pt;
+                          },
+                          {"rdfentry_"})
+                  .Define("Tau_eta",
+                          [](const ROOT::RVec<float> &pt) {
+                              ROOT::RVec<float> eta(pt.size());
+                              for (std::size_t i = 0; i < eta.size(); ++i)
+                                  eta[i] = 0.8f * i - 0.5f;
+                              return eta;
+                          },
+                          {"Tau_pt"})
+                  .Define("Tau_mass",
+                          [](const ROOT::RVec<float> &pt) {
+                              return ROOT::RVec<float>(pt.size(), 1.2f);
+                          },
+                          {"Tau_pt"})
+                  .Define("Tau_decayMode",
+                          [](ULong64_t entry, const ROOT::RVec<float> &pt) {
+                              ROOT::RVec<int> dm(pt.size());
+                              const int modes[] = {0, 1, 10};
+                              for (std::size_t i = 0; i < dm.size(); ++i)
+                                  dm[i] = modes[(entry + i) % 3];
+                              return dm;
+                          },
+                          {"rdfentry_", "Tau_pt"});
+    ROOT::RDF::RNode base(df);
+
+    // one chain per shift
+    ROOT::RDF::RNode perShift(base);
+    for (std::size_t i = 0; i < shifts.size(); ++i) {
+        perShift = physicsobject::tau::PtCorrection(
+            perShift, "Tau_pt_corrected" + shifts[i], "Tau_pt",
+            "Tau_decayMode", sf_dm0[i], sf_dm1[i], 1.f, 1.f);
+        perShift = Chain(perShift, shifts[i]);
+    }
+
+    // a single chain computing all shifts, unrolled like for the output
+    const std::vector<std::size_t> variations = {0, 1, 2, 3};
+    const std::vector<float> unshifted(shifts.size(), 1.f);
+    ROOT::RDF::RNode fused = physicsobject::tau::PtCorrectionVariations(
+        base, "Tau_pt_corrected", "Tau_pt", "Tau_decayMode", sf_dm0, sf_dm1,
+        unshifted, unshifted);
+    fused = utility::vary(fused, shifts.size(),
+                          {{"Tau_pt_corrected", variations}},
+                          [](auto &node) { return Chain(node, ""); });
+    for (const std::string name : {"Tau_pt_corrected", "Tau_mass_corrected",
+                                   "good_taus_mask", "ntaus", "leading_pt"}) {
+        std::vector<std::string> leaves;
+        for (const auto &shift : shifts)
+            leaves.push_back(name + shift);
+        fused = utility::unroll(fused, name, leaves, variations);
+    }
+
+    compare<ROOT::RVec<float>>(perShift, fused, "Tau_pt_corrected");
+    compare<ROOT::RVec<float>>(perShift, fused, "Tau_mass_corrected");
+    compare<ROOT::RVec<int>>(perShift, fused, "good_taus_mask");
+    compare<int>(perShift, fused, "ntaus");
+    compare<float>(perShift, fused, "leading_pt");
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}